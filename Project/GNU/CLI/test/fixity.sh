@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+
+script_path="${PWD}/test"
+. ${script_path}/helpers.sh
+
+test="fixity"
+testfile="test.wav"
+
+mkdir "${test}"
+
+# 3 segments of 4 MiB, 48 kHz mono 16-bit, the data chunk is the last one
+ffmpeg -nostdin -f lavfi -i anoisesrc=duration=100 ${test}/${testfile} >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+cp "${test}/${testfile}" "${test}/original.wav"
+offset=$(( $(wc -c < "${test}/${testfile}") - 9600000 ))
+
+run_bwfmetaedit -v --fixity-index --fixity-segment=4 --out-tech "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "fixity index, 3 segments" "${cmd_stderr}" || [ ! -f "${test}/${testfile}.fixity" ] ; then
+    error "${test}/index" "fixity index not written"
+fi
+tech="${cmd_stdout}"
+
+run_bwfmetaedit -v --fixity-verify --jobs=2 "${test}/${testfile}" "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "fixity index, verified (3 segments)" "${cmd_stderr}" ; then
+    error "${test}/verify" "fixity index not verified"
+fi
+
+# interrupted after the first segment, the MD5 is the same as without interruption
+head -n 8 "${test}/${testfile}.fixity" > "${test}/partial"
+mv "${test}/partial" "${test}/${testfile}.fixity"
+run_bwfmetaedit -v --fixity-index --fixity-segment=4 --out-tech "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "fixity index, resumed at byte $(( offset + 4194304 ))" "${cmd_stderr}" ; then
+    error "${test}/resume" "fixity index not resumed"
+fi
+if [ "${cmd_stdout}" != "${tech}" ] ; then
+    error "${test}/resume" "output differs from the one without interruption"
+fi
+
+# damaged byte in the second segment
+printf 'x' | dd of="${test}/${testfile}" bs=1 seek=5000000 conv=notrunc >/dev/null 2>&1
+run_bwfmetaedit --fixity-verify "${test}/${testfile}"
+if ! contains "damaged audio data (bytes $(( offset + 4194304 ))-$(( offset + 8388607 )))" "${cmd_stderr}" ; then
+    error "${test}/damaged" "damaged byte range not reported"
+fi
+cp "${test}/original.wav" "${test}/${testfile}"
+
+# interrupted, but the file was modified since (same size), the hashing is not resumed
+head -n 8 "${test}/${testfile}.fixity" > "${test}/partial"
+mv "${test}/partial" "${test}/${testfile}.fixity"
+run_bwfmetaedit -v --fixity-index --fixity-segment=4 --out-tech "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || contains "resumed" "${cmd_stderr}" || [ "${cmd_stdout}" != "${tech}" ] ; then
+    error "${test}/modified" "fixity index resumed on a modified file"
+fi
+
+rm -f "${test}/${testfile}.fixity"
+run_bwfmetaedit --fixity-verify "${test}/${testfile}"
+if ! contains "no complete fixity index" "${cmd_stderr}" ; then
+    error "${test}/missing" "missing fixity index not reported"
+fi
+
+run_bwfmetaedit --fixity-segment=6 "${test}/${testfile}"
+if ! contains "not a valid segment size" "${cmd_stdout}" ; then
+    error "${test}/invalid" "invalid segment size accepted"
+fi
+
+rm -fr "${test}"
+
+exit ${status}
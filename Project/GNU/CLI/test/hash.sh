@@ -0,0 +1,55 @@
+#!/usr/bin/env bash
+
+script_path="${PWD}/test"
+. ${script_path}/helpers.sh
+
+test="hash"
+testfile="test.wav"
+
+mkdir "${test}"
+
+# more than one read buffer (4 MiB) of audio data, 48 kHz mono 16-bit, the data chunk is the last one
+ffmpeg -nostdin -f lavfi -i anoisesrc=duration=50 ${test}/${testfile} >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+sha256="$(tail -c 4800000 ${test}/${testfile} | sha256sum | cut -d ' ' -f 1)"
+
+run_bwfmetaedit --hash=xxh3,sha256,blake3 --out-tech "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] ; then
+    error "${test}/generate" "command failed"
+fi
+tech="${cmd_stdout}"
+
+if ! contains "${sha256}" "${tech}" ; then
+    error "${test}/sha256" "SHA256Generated differs from sha256sum"
+fi
+
+if ! contains ",[0-9a-f]\{16\},${sha256},[0-9a-f]\{64\}$" "${tech}" ; then
+    error "${test}/columns" "XXH3Generated or BLAKE3Generated missing"
+fi
+
+run_bwfmetaedit --hash=xxh3,sha256,blake3 --jobs=2 --out-tech "${test}/${testfile}" "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || [ "$(echo "${cmd_stdout}" | tail -n 1)" != "$(echo "${tech}" | tail -n 1)" ] ; then
+    error "${test}/parallel" "output differs from serial output"
+fi
+
+# metadata larger than the existing padding, the audio data is copied in a new file
+run_bwfmetaedit -v --hash=sha256 --ICMT="$(head -c 70000 /dev/zero | tr '\0' a)" "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "audio data verified while copied (SHA256)" "${cmd_stderr}" ; then
+    error "${test}/copy" "audio data not verified while copied"
+fi
+
+run_bwfmetaedit --hash=sha256 --out-tech "${test}/${testfile}"
+if ! contains "${sha256}" "${cmd_stdout}" ; then
+    error "${test}/copy" "SHA256Generated differs after the copy"
+fi
+
+run_bwfmetaedit --hash=crc32 "${test}/${testfile}"
+if ! contains "unknown hash" "${cmd_stdout}" ; then
+    error "${test}/invalid" "invalid hash accepted"
+fi
+
+rm -fr "${test}"
+
+exit ${status}
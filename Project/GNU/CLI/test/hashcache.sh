@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+
+script_path="${PWD}/test"
+. ${script_path}/helpers.sh
+
+test="hashcache"
+testfile="test.wav"
+cache="${test}/cache.txt"
+
+mkdir "${test}"
+
+ffmpeg -nostdin -f lavfi -i anoisesrc=duration=5 ${test}/${testfile} >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+
+run_bwfmetaedit -v --md5-generate --hash=sha256 --hash-cache-file="${cache}" --out-tech "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "MB/s" "${cmd_stderr}" || [ ! -f "${cache}" ] ; then
+    error "${test}/create" "digest cache not created"
+fi
+tech="${cmd_stdout}"
+
+# unchanged file, the audio data is not read
+run_bwfmetaedit -v --md5-generate --hash=sha256 --hash-cache-file="${cache}" --out-tech "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "from the digest cache" "${cmd_stderr}" ; then
+    error "${test}/hit" "digests not read from the digest cache"
+fi
+if [ "${cmd_stdout}" != "${tech}" ] ; then
+    error "${test}/hit" "output differs from the hashed one"
+fi
+
+# digest not in the cache yet, the audio data is read
+run_bwfmetaedit -v --hash=blake3 --hash-cache-file="${cache}" "${test}/${testfile}"
+if ! contains "MB/s" "${cmd_stderr}" ; then
+    error "${test}/missing" "missing digest not generated"
+fi
+
+# audio data modified behind the back of the file system, only detected when the file is hashed again
+touch -r "${test}/${testfile}" "${test}/reference"
+printf 'x' | dd of="${test}/${testfile}" bs=1 seek=1000 conv=notrunc >/dev/null 2>&1
+touch -r "${test}/reference" "${test}/${testfile}"
+
+run_bwfmetaedit -v --md5-generate --hash-cache-file="${cache}" "${test}/${testfile}"
+if ! contains "from the digest cache" "${cmd_stderr}" ; then
+    error "${test}/unchanged" "digests not read from the digest cache"
+fi
+
+run_bwfmetaedit -v --md5-generate --hash-cache=verify --hash-cache-rehash=100 --hash-cache-file="${cache}" "${test}/${testfile}"
+if ! contains "digest cache, audio data modified" "${cmd_stderr}" ; then
+    error "${test}/verify" "modified audio data not detected"
+fi
+
+# file modification time changed, the audio data is read
+touch "${test}/${testfile}"
+run_bwfmetaedit -v --md5-generate --hash-cache-file="${cache}" "${test}/${testfile}"
+if contains "from the digest cache" "${cmd_stderr}" ; then
+    error "${test}/modified" "digests of a modified file read from the digest cache"
+fi
+
+run_bwfmetaedit --hash-cache=always "${test}/${testfile}"
+if ! contains "unknown digest cache mode" "${cmd_stdout}" ; then
+    error "${test}/invalid" "invalid digest cache mode accepted"
+fi
+
+rm -fr "${test}"
+
+exit ${status}
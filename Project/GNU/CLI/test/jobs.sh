@@ -0,0 +1,84 @@
+#!/usr/bin/env bash
+
+script_path="${PWD}/test"
+. ${script_path}/helpers.sh
+
+test="jobs"
+
+mkdir "${test}"
+
+# different durations, so the largest files are not the first ones
+for file in 1 2 3 4 5 6 ; do
+    ffmpeg -nostdin -f lavfi -i anoisesrc=duration=${file} ${test}/${file}.wav >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+done
+
+run_bwfmetaedit --md5-generate --out-tech "${test}"
+check_success
+if [ "${?}" -ne 0 ] ; then
+    error "${test}/serial" "command failed"
+fi
+serial="${cmd_stdout}"
+
+run_bwfmetaedit --jobs=4 --md5-generate --out-tech "${test}"
+check_success
+if [ "${?}" -ne 0 ] ; then
+    error "${test}/parallel" "command failed"
+fi
+
+if [ "${cmd_stdout}" != "${serial}" ] ; then
+    error "${test}/parallel" "output differs from serial output"
+fi
+
+for mode in serial parallel ; do
+    jobs=1
+    if [ "${mode}" = "parallel" ] ; then
+        jobs=4
+    fi
+    run_bwfmetaedit --jobs=${jobs} --out-tech="${test}_${mode}.tech.csv" --out-core="${test}_${mode}.core.csv" --out-xml="${test}_${mode}.xml" "${test}"
+    check_success
+    if [ "${?}" -ne 0 ] ; then
+        error "${test}/ordered" "command failed"
+    fi
+done
+
+for file in tech.csv core.csv xml ; do
+    if ! cmp -s "${test}_serial.${file}" "${test}_parallel.${file}" ; then
+        error "${test}/ordered" "${file} output file differs from serial output"
+    fi
+    rm -f "${test}_serial.${file}" "${test}_parallel.${file}"
+done
+
+run_bwfmetaedit --jobs=4 --Description="description_string" "${test}"
+check_success
+if [ "${?}" -ne 0 ] ; then
+    error "${test}/write" "command failed"
+fi
+
+for file in 1 2 3 4 5 6 ; do
+    run_bwfmetaedit --out-core "${test}/${file}.wav"
+    if ! contains "description_string" "${cmd_stdout}" ; then
+        error "${test}/write" "description not written in ${file}.wav"
+    fi
+done
+
+run_bwfmetaedit --jobs=4 --jobs-per-device=1 --IART="iart_string" "${test}"
+check_success
+if [ "${?}" -ne 0 ] ; then
+    error "${test}/device" "command failed"
+fi
+
+for file in 1 2 3 4 5 6 ; do
+    run_bwfmetaedit --out-core "${test}/${file}.wav"
+    if ! contains "iart_string" "${cmd_stdout}" || ! contains "description_string" "${cmd_stdout}" ; then
+        error "${test}/device" "metadata not written in ${file}.wav"
+    fi
+done
+
+run_bwfmetaedit --jobs=0 "${test}"
+if ! contains "not a valid count of jobs" "${cmd_stdout}" ; then
+    error "${test}/invalid" "invalid count of jobs accepted"
+fi
+
+rm -fr "${test}"
+
+exit ${status}
@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+
+script_path="${PWD}/test"
+. ${script_path}/helpers.sh
+
+test="levels"
+testfile="test.wav"
+
+# MD5Generated, then XXH3Generated, SHA256Generated and BLAKE3Generated at the end of the row (Information may span several lines)
+digests() {
+    echo "$(echo "${1}" | sed -n 2p | cut -d, -f18),$(echo "${1}" | tail -n 1 | grep -o "[^,]*,[^,]*,[^,]*$")"
+}
+
+mkdir "${test}"
+
+ffmpeg -nostdin -f lavfi -i anoisesrc=duration=10 ${test}/${testfile} >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+offset=$(( $(wc -c < "${test}/${testfile}") - 960000 ))
+
+# all the analyzers in one read, the digests are the same as alone
+run_bwfmetaedit --hash=md5,xxh3,sha256,blake3 --out-tech "${test}/${testfile}"
+check_success
+tech="$(digests "${cmd_stdout}")"
+run_bwfmetaedit -v --levels --hash=md5,xxh3,sha256,blake3 --out-tech "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "MD5, XXH3, SHA256, BLAKE3, levels" "${cmd_stderr}" ; then
+    error "${test}/pass" "levels not measured in the same pass as the digests"
+fi
+if [ "$(digests "${cmd_stdout}")" != "${tech}" ] ; then
+    error "${test}/digests" "digests differ when measured with the levels"
+fi
+if ! contains "levels, channel 1, peak " "${cmd_stdout}" || ! contains "levels, silence " "${cmd_stdout}" ; then
+    error "${test}/information" "levels not in the information"
+fi
+
+# digital silence
+head -c ${offset} "${test}/${testfile}" > "${test}/silence.wav"
+head -c 960000 /dev/zero >> "${test}/silence.wav"
+run_bwfmetaedit --levels --out-tech "${test}/silence.wav"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "peak -inf dBFS, RMS -inf dBFS, DC offset 0.0000%, 0 clipped samples" "${cmd_stdout}" || ! contains "silence 100.0%" "${cmd_stdout}" ; then
+    error "${test}/silence" "digital silence not measured"
+fi
+
+rm -fr "${test}"
+
+exit ${status}
@@ -0,0 +1,75 @@
+#!/usr/bin/env bash
+
+script_path="${PWD}/test"
+. ${script_path}/helpers.sh
+
+test="loudness"
+testfile="test.wav"
+
+mkdir "${test}"
+
+ffmpeg -nostdin -f lavfi -i anoisesrc=duration=20 ${test}/${testfile} >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+cp "${test}/${testfile}" "${test}/original.wav"
+
+run_bwfmetaedit -v --loudness-compute --md5-generate "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "MD5, loudness" "${cmd_stderr}" ; then
+    error "${test}/compute" "loudness not computed in the same pass as MD5"
+fi
+
+run_bwfmetaedit --out-xml "${test}/${testfile}"
+check_success
+for field in LoudnessValue LoudnessRange MaxTruePeakLevel MaxMomentaryLoudness MaxShortTermLoudness ; do
+    pattern="<${field}>-?[0-9]{1,2}\.[0-9]{2}</${field}>"
+    if ! [[ "${cmd_stdout}" =~ ${pattern} ]] ; then
+        error "${test}/${field}" "${field} not filled"
+    fi
+done
+if ! contains "<BextVersion>2</BextVersion>" "${cmd_stdout}" ; then
+    error "${test}/version" "bext version not 2"
+fi
+
+# the true peak is not below the sample peak, the loudness is below the true peak
+value() {
+    echo "${cmd_stdout}" | sed -n "s/.*<${1}>\(.*\)<\/${1}>.*/\1/p"
+}
+if ! awk -v lv="$(value LoudnessValue)" -v tp="$(value MaxTruePeakLevel)" -v st="$(value MaxShortTermLoudness)" 'BEGIN { exit !(lv < tp && lv <= st + 0.01) }' ; then
+    error "${test}/values" "incoherent loudness values"
+fi
+
+# same true peak with the SIMD kernels as with the scalar reference
+reference="$(value MaxTruePeakLevel)"
+for kernel in sse2 avx2 ; do
+    cp "${test}/original.wav" "${test}/${testfile}"
+    run_bwfmetaedit --peak-kernel=${kernel} --loudness-compute "${test}/${testfile}"
+    if contains "not supported by this CPU" "${cmd_stdout}" ; then
+        continue
+    fi
+    run_bwfmetaedit --out-xml "${test}/${testfile}"
+    if [ "$(value MaxTruePeakLevel)" != "${reference}" ] ; then
+        error "${test}/${kernel}" "true peak differs from the reference"
+    fi
+done
+cp "${test}/original.wav" "${test}/${testfile}"
+run_bwfmetaedit --peak-kernel=scalar --loudness-compute "${test}/${testfile}"
+run_bwfmetaedit --out-xml "${test}/${testfile}"
+if [ "$(value MaxTruePeakLevel)" != "${reference}" ] ; then
+    error "${test}/scalar" "true peak differs with the scalar kernel"
+fi
+
+run_bwfmetaedit --peak-kernel=unknown "${test}/${testfile}"
+if ! contains "unknown kernel" "${cmd_stdout}" ; then
+    error "${test}/kernel" "unknown kernel not reported"
+fi
+
+# not PCM
+cp "${test}/original.wav" "${test}/${testfile}"
+printf '\x02' | dd of="${test}/${testfile}" bs=1 seek=20 conv=notrunc >/dev/null 2>&1
+run_bwfmetaedit --loudness-compute "${test}/${testfile}"
+if ! contains "loudness, audio format not supported" "${cmd_stderr}" ; then
+    error "${test}/unsupported" "unsupported format not reported"
+fi
+
+rm -fr "${test}"
+
+exit ${status}
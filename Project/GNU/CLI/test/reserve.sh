@@ -0,0 +1,106 @@
+#!/usr/bin/env bash
+
+script_path="${PWD}/test"
+. ${script_path}/helpers.sh
+
+test="reserve"
+testfile="test.wav"
+
+mkdir "${test}"
+
+ffmpeg -nostdin -f lavfi -i anoisesrc=duration=2 ${test}/${testfile} >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+
+data_offset() {
+    grep -obUa "data" "${1}" | head -n 1 | cut -d: -f1
+}
+
+run_bwfmetaedit --md5-embed "${test}/${testfile}"
+check_success
+cp "${test}/${testfile}" "${test}/original.wav"
+
+# no padding before the audio data, it is moved with the reserve even without other modification
+run_bwfmetaedit -v --reserve-only --reserve=65536 "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "smaller than the reserve" "${cmd_stderr}" ; then
+    error "${test}/only" "file not padded: ${cmd_stderr}"
+fi
+offset="$(data_offset ${test}/${testfile})"
+if [ "${offset}" -lt 65536 ] || [ "$(( ( ${offset} - $(data_offset ${test}/original.wav) ) % 4096 ))" -ne 0 ] ; then
+    error "${test}/only" "wrong audio data offset ${offset}"
+fi
+
+# the reserve is there, nothing to do
+run_bwfmetaedit -v --reserve-only --reserve=65536 "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || contains "smaller than the reserve" "${cmd_stderr}" || [ "$(data_offset ${test}/${testfile})" -ne "${offset}" ] ; then
+    error "${test}/only" "file padded again: ${cmd_stderr}"
+fi
+
+# next modifications within the reserve are in place
+run_bwfmetaedit -v --Description="description" --ICMT="$(head -c 40000 /dev/zero | tr '\0' 'c')" "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "in place: yes" "${cmd_stderr}" || contains "bytes inserted" "${cmd_stderr}" ; then
+    error "${test}/inplace" "file not modified in place: ${cmd_stderr}"
+fi
+if [ "$(data_offset ${test}/${testfile})" -ne "${offset}" ] ; then
+    error "${test}/inplace" "audio data moved"
+fi
+
+# reserve for the growth of iXML and XMP before the audio data
+le32() {
+    printf "$(printf '\\x%02x\\x%02x\\x%02x\\x%02x' $(( ${1} & 255 )) $(( ${1} >> 8 & 255 )) $(( ${1} >> 16 & 255 )) $(( ${1} >> 24 & 255 )))"
+}
+ffmpeg -nostdin -fflags +bitexact -f lavfi -i anoisesrc=duration=2 ${test}/plain.wav >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+ixml="<BWFXML><NOTE>test</NOTE></BWFXML>"
+{
+    printf "RIFF" ; le32 $(( $(wc -c < ${test}/plain.wav) + ${#ixml} )) ; printf "WAVE"
+    head -c 36 ${test}/plain.wav | tail -c 24
+    printf "iXML" ; le32 ${#ixml} ; printf "%s" "${ixml}"
+    tail -c +37 ${test}/plain.wav
+} > "${test}/ixml.wav"
+
+run_bwfmetaedit -v --reserve-only --reserve=xml:32 "${test}/ixml.wav"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "smaller than the reserve" "${cmd_stderr}" ; then
+    error "${test}/xml" "file not padded: ${cmd_stderr}"
+fi
+offset="$(data_offset ${test}/ixml.wav)"
+
+printf "%s" "<BWFXML><NOTE>$(head -c 29994 /dev/zero | tr '\0' 'x')</NOTE></BWFXML>" > "${test}/ixml.xml"
+run_bwfmetaedit -v --in-ixml="${test}/ixml.xml" "${test}/ixml.wav"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "in place: yes" "${cmd_stderr}" || [ "$(data_offset ${test}/ixml.wav)" -ne "${offset}" ] ; then
+    error "${test}/xml" "iXML not modified in place: ${cmd_stderr}"
+fi
+
+run_bwfmetaedit -v --reserve-only --reserve=xml:32 "${test}/ixml.wav"
+check_success
+if [ "${?}" -ne 0 ] || contains "smaller than the reserve" "${cmd_stderr}" ; then
+    error "${test}/xml" "reserve not counted from the iXML size: ${cmd_stderr}"
+fi
+
+# percentage of the header
+cp "${test}/original.wav" "${test}/${testfile}"
+run_bwfmetaedit --reserve=200% --Description="$(head -c 200 /dev/zero | tr '\0' 'd')" "${test}/${testfile}"
+check_success
+offset="$(data_offset ${test}/${testfile})"
+if [ "${?}" -ne 0 ] || [ "${offset}" -lt 1800 ] || [ "${offset}" -ge 16384 ] ; then
+    error "${test}/percent" "wrong audio data offset ${offset}"
+fi
+
+# invalid policy
+run_bwfmetaedit --reserve=abc "${test}/${testfile}"
+if ! contains "not a valid reserve" "${cmd_stdout}" ; then
+    error "${test}/invalid" "invalid reserve accepted"
+fi
+
+# audio data is intact
+run_bwfmetaedit -v --md5-verify "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "MD5, verified" "${cmd_stderr}" ; then
+    error "${test}/verify" "audio data modified"
+fi
+
+rm -fr "${test}"
+
+exit ${status}
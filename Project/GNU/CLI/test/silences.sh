@@ -0,0 +1,91 @@
+#!/usr/bin/env bash
+
+script_path="${PWD}/test"
+. ${script_path}/helpers.sh
+
+test="silences"
+testfile="test.wav"
+
+mkdir "${test}"
+
+ffmpeg -nostdin -f lavfi -i anoisesrc=duration=20 ${test}/${testfile} >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+
+# 48 kHz mono 16-bit, data chunk at the end: silence from 0 to 3 s, 8 to 10.5 s, 14.5 to 15 s and 17 to 20 s
+data_offset=$(( $(wc -c < "${test}/${testfile}") - 20 * 48000 * 2 ))
+silence() {
+    dd if=/dev/zero of="${test}/${testfile}" bs=2 seek=$(( data_offset / 2 + ${1} )) count=${2} conv=notrunc >/dev/null 2>&1
+}
+silence 0 144000
+silence 384000 120000
+silence 696000 24000
+silence 816000 144000
+
+# cue point already in the file, kept
+cat > "${test}/cue.xml" <<CUE
+<Cues samplerate="48000">
+    <Cue>
+        <ID>7</ID>
+        <Position>240000</Position>
+        <Label>Side A</Label>
+    </Cue>
+</Cues>
+CUE
+cp "${test}/cue.xml" "${test}/${testfile}.cue.xml"
+run_bwfmetaedit --in-cue-xml "${test}/${testfile}"
+check_success
+
+run_bwfmetaedit -v --silence-detect --md5-generate "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "MD5, silences" "${cmd_stderr}" ; then
+    error "${test}/detect" "silences not detected in the same pass as MD5"
+fi
+for silence in "leading) at 0.000 s, 3.000 s" "gap) at 8.000 s, 2.500 s" "trailing) at 17.000 s, 3.000 s" ; do
+    if ! contains "silences, Silence (${silence} long" "${cmd_stderr}" ; then
+        error "${test}/information" "silence (${silence}) not reported"
+    fi
+done
+if contains "at 14.500 s" "${cmd_stderr}" ; then
+    error "${test}/duration" "silence shorter than the minimum duration reported"
+fi
+
+run_bwfmetaedit --out-cue-xml "${test}/${testfile}"
+check_success
+cues="${cmd_stdout}"
+if [ "$(echo "${cues}" | grep -c "<Cue>")" -ne 4 ] || ! contains "<Label>Side A</Label>" "${cues}" ; then
+    error "${test}/cues" "unexpected cue points"
+fi
+for position in 0 384000 816000 ; do
+    if ! contains "<Position>${position}</Position>" "${cues}" ; then
+        error "${test}/position" "no cue point at ${position}"
+    fi
+done
+if ! contains "<ID>8</ID>" "${cues}" || ! contains "<SampleLength>120000</SampleLength>" "${cues}" ; then
+    error "${test}/ids" "unexpected cue point IDs or lengths"
+fi
+
+# detected again: nothing to do, then replaced with a shorter minimum duration
+run_bwfmetaedit -v --silence-detect "${test}/${testfile}"
+check_success
+if ! contains "Nothing to do" "${cmd_stderr}" ; then
+    error "${test}/again" "file modified by the same detection"
+fi
+run_bwfmetaedit --silence-detect --silence-duration=0.4 "${test}/${testfile}"
+check_success
+run_bwfmetaedit --out-cue-xml "${test}/${testfile}"
+if [ "$(echo "${cmd_stdout}" | grep -c "<Cue>")" -ne 5 ] || ! contains "<Position>696000</Position>" "${cmd_stdout}" ; then
+    error "${test}/replace" "previous detection not replaced"
+fi
+
+# the threshold also applies to the levels
+run_bwfmetaedit -v --levels --silence-threshold=-120 "${test}/${testfile}"
+if ! contains "(below -120 dBFS)" "${cmd_stderr}" ; then
+    error "${test}/threshold" "threshold not used for the levels"
+fi
+run_bwfmetaedit --silence-threshold=3 "${test}/${testfile}"
+if ! contains "not a valid threshold" "${cmd_stdout}" ; then
+    error "${test}/invalid" "invalid threshold not reported"
+fi
+
+rm -fr "${test}"
+
+exit ${status}
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+
+script_path="${PWD}/test"
+. ${script_path}/helpers.sh
+
+test="writeplan"
+testfile="test.wav"
+
+mkdir "${test}"
+
+ffmpeg -nostdin -f lavfi -i anoisesrc=duration=2 ${test}/${testfile} >/dev/null 2>&1 || fatal "internal" "ffmpeg command failed"
+
+# MD5 chunk after the audio data, the file is extended in place
+run_bwfmetaedit -v --md5-embed "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "in place: yes" "${cmd_stderr}" ; then
+    error "${test}/md5" "MD5 chunk not added in place"
+fi
+cp "${test}/${testfile}" "${test}/original.wav"
+
+# no room before the audio data, the whole file is written in a copy
+run_bwfmetaedit -v --simulate --Description="first" "${test}/${testfile}"
+check_success
+plan="$(echo "${cmd_stderr}" | grep -o "write plan, [0-9]* bytes")"
+if [ "${?}" -ne 0 ] || ! contains "in place: no" "${cmd_stderr}" ; then
+    error "${test}/simulate" "wrong write plan for a copy: ${cmd_stderr}"
+fi
+if ! cmp -s "${test}/${testfile}" "${test}/original.wav" ; then
+    error "${test}/simulate" "file modified by a simulation"
+fi
+
+run_bwfmetaedit -v --Description="first" "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "${plan} rewritten, in place: no" "${cmd_stderr}" ; then
+    error "${test}/copy" "file not copied as simulated: ${cmd_stderr}"
+fi
+if [ "${plan}" != "write plan, $(wc -c < ${test}/${testfile}) bytes" ] ; then
+    error "${test}/copy" "simulated size (${plan}) is not the file size"
+fi
+
+# the audio data keeps its place in a file system block, it can be shared with the original file
+data_offset() {
+    grep -obUa "data" "${1}" | head -n 1 | cut -d: -f1
+}
+if [ "$(( ( $(data_offset ${test}/${testfile}) - $(data_offset ${test}/original.wav) ) % 4096 ))" -ne 0 ] ; then
+    error "${test}/copy" "audio data not aligned as in the original file"
+fi
+
+# same result with space inserted before the audio data, if the file system supports it
+cp "${test}/${testfile}" "${test}/copy.wav"
+cp "${test}/original.wav" "${test}/${testfile}"
+run_bwfmetaedit -v --simulate --insert-range --Description="first" "${test}/${testfile}"
+check_success
+plan="$(echo "${cmd_stderr}" | grep -o "write plan, [0-9]* bytes")"
+if [ "${?}" -ne 0 ] || ! contains "in place: yes, [0-9]* bytes inserted before the audio data" "${cmd_stderr}" ; then
+    error "${test}/simulate" "wrong write plan with insertion: ${cmd_stderr}"
+fi
+
+run_bwfmetaedit -v --insert-range --Description="first" "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] ; then
+    error "${test}/insert" "command failed"
+elif contains "bytes inserted" "${cmd_stderr}" && ! contains "${plan} rewritten, in place: yes" "${cmd_stderr}" ; then
+    error "${test}/insert" "space not inserted as simulated: ${cmd_stderr}"
+fi
+if ! cmp -s "${test}/${testfile}" "${test}/copy.wav" ; then
+    error "${test}/insert" "file differs from the copy"
+fi
+
+# padding is available, the file is modified in place with the cost given by the simulation
+run_bwfmetaedit -v --simulate --Description="second" --ICMT="comment" "${test}/${testfile}"
+check_success
+plan="$(echo "${cmd_stderr}" | grep -o "write plan, [0-9]* bytes")"
+if [ "${?}" -ne 0 ] || ! contains "in place: yes" "${cmd_stderr}" ; then
+    error "${test}/simulate" "wrong write plan in place: ${cmd_stderr}"
+fi
+
+size="$(wc -c < ${test}/${testfile})"
+run_bwfmetaedit -v --Description="second" --ICMT="comment" "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "${plan} rewritten, in place: yes" "${cmd_stderr}" ; then
+    error "${test}/inplace" "file not modified in place as simulated: ${cmd_stderr}"
+fi
+if [ "$(wc -c < ${test}/${testfile})" -ne "${size}" ] ; then
+    error "${test}/inplace" "file size changed"
+fi
+
+# audio data and metadata are intact
+run_bwfmetaedit -v --md5-verify --out-core "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "MD5, verified" "${cmd_stderr}" ; then
+    error "${test}/verify" "audio data modified"
+fi
+if ! contains ",second," "${cmd_stdout}" || ! contains ",comment," "${cmd_stdout}" ; then
+    error "${test}/metadata" "metadata not written"
+fi
+
+# only the rewritten bytes are read back after the write
+run_bwfmetaedit -v --verify-plan --Description="third" "${test}/${testfile}"
+check_success
+plan="$(echo "${cmd_stderr}" | grep -o "write plan, [0-9]* bytes rewritten" | grep -o "[0-9]*")"
+if [ "${?}" -ne 0 ] || ! contains "write plan, ${plan} bytes verified" "${cmd_stderr}" ; then
+    error "${test}/verify-plan" "rewritten bytes not verified: ${cmd_stderr}"
+fi
+run_bwfmetaedit -v --md5-verify --out-core "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "MD5, verified" "${cmd_stderr}" || ! contains ",third," "${cmd_stdout}" ; then
+    error "${test}/verify-plan" "file not valid after a write verified from the plan"
+fi
+
+# new chunks at the end, the LIST chunk is moved after the audio data in place
+cp "${test}/original.wav" "${test}/${testfile}"
+run_bwfmetaedit -v --append --Description="appended" "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "in place: yes" "${cmd_stderr}" ; then
+    error "${test}/append" "file not modified in place"
+fi
+run_bwfmetaedit -v --md5-verify --out-core "${test}/${testfile}"
+check_success
+if [ "${?}" -ne 0 ] || ! contains "MD5, verified" "${cmd_stderr}" || ! contains ",appended," "${cmd_stdout}" ; then
+    error "${test}/append" "file not valid after moving chunks in place"
+fi
+
+rm -fr "${test}"
+
+exit ${status}
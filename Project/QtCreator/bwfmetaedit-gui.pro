@@ -63,10 +63,22 @@ HEADERS = \
     ../../Source/GUI/Qt/GUI_Main_xxxx_CodePageDialog.h \
     ../../Source/GUI/Qt/GUI_Main_xxxx__Common.h \
     ../../Source/GUI/Qt/GUI_Preferences.h \
+    ../../Source/Hash/blake3.h \
+    ../../Source/Hash/sha256.h \
+    ../../Source/Hash/xxh3.h \
     ../../Source/MD5/md5.h \
+    ../../Source/MD5/md5_multi.h \
+    ../../Source/Riff/Riff_Analyzer.h \
     ../../Source/Riff/Riff_Base.h \
     ../../Source/Riff/Riff_Chunks.h \
+    ../../Source/Riff/Riff_Fixity_Index.h \
     ../../Source/Riff/Riff_Handler.h \
+    ../../Source/Riff/Riff_Hash_Cache.h \
+    ../../Source/Riff/Riff_Levels.h \
+    ../../Source/Riff/Riff_Loudness.h \
+    ../../Source/Riff/Riff_Peak.h \
+    ../../Source/Riff/Riff_Silence.h \
+    ../../Source/Riff/Riff_Write_Plan.h \
     ../../Source/TinyXml2/tinyxml2.h \
     ../../Source/ZenLib/BitStream.h \
     ../../Source/ZenLib/BitStream_Fast.h \
@@ -122,7 +134,12 @@ SOURCES = \
     ../../Source/GUI/Qt/GUI_Main_xxxx_CodePageDialog.cpp \
     ../../Source/GUI/Qt/GUI_Main_xxxx__Common.cpp \
     ../../Source/GUI/Qt/GUI_Preferences.cpp \
+    ../../Source/Hash/blake3.c \
+    ../../Source/Hash/sha256.c \
+    ../../Source/Hash/xxh3.c \
     ../../Source/MD5/md5.c \
+    ../../Source/MD5/md5_multi.c \
+    ../../Source/Riff/Riff_Analyzer.cpp \
     ../../Source/Riff/Riff_Base.cpp \
     ../../Source/Riff/Riff_Base_Streams.cpp \
     ../../Source/Riff/Riff_Chunks_.cpp \
@@ -144,7 +161,14 @@ SOURCES = \
     ../../Source/Riff/Riff_Chunks_WAVE_adtl_note.cpp \
     ../../Source/Riff/Riff_Chunks_WAVE_adtl_ltxt.cpp \
     ../../Source/Riff/Riff_Chunks_WAVE_CSET.cpp \
+    ../../Source/Riff/Riff_Fixity_Index.cpp \
     ../../Source/Riff/Riff_Handler.cpp \
+    ../../Source/Riff/Riff_Hash_Cache.cpp \
+    ../../Source/Riff/Riff_Levels.cpp \
+    ../../Source/Riff/Riff_Loudness.cpp \
+    ../../Source/Riff/Riff_Peak.cpp \
+    ../../Source/Riff/Riff_Silence.cpp \
+    ../../Source/Riff/Riff_Write_Plan.cpp \
     ../../Source/TinyXml2/tinyxml2.cpp \
     ../../Source/ZenLib/Conf.cpp \
     ../../Source/ZenLib/CriticalSection.cpp \
@@ -47,10 +47,27 @@ std::string Help()
     ToDisplay<<""<<std::endl;
     ToDisplay<<"                        File modification options:"<<std::endl;
     ToDisplay<<"--append, -a            Place new or expanded chunks at the end of the file"<<std::endl;
+    ToDisplay<<"--insert-range          Insert space before the audio data when the header grows,"<<std::endl;
+    ToDisplay<<"                        instead of copying the file, if the file system supports it"<<std::endl;
+    ToDisplay<<"                        Warning: not crash safe, the file is invalid if the system"<<std::endl;
+    ToDisplay<<"                        stops before the end (the copy replaces the file only when"<<std::endl;
+    ToDisplay<<"                        complete) and the audio data is not verified against digests"<<std::endl;
+    ToDisplay<<"--reserve=...           Padding before the audio data when it has to move, so next"<<std::endl;
+    ToDisplay<<"                        modifications are in place: a size in bytes (default 16384),"<<std::endl;
+    ToDisplay<<"                        a percentage of the header (e.g. 50%), or xml:KiB for the size"<<std::endl;
+    ToDisplay<<"                        up to which iXML and XMP can grow (e.g. xml:64)"<<std::endl;
+    ToDisplay<<"--reserve-only          Move the audio data of files with less padding before it than"<<std::endl;
+    ToDisplay<<"                        the reserve, even without other modification"<<std::endl;
+    ToDisplay<<"--verify-plan           After a modification in place, read back only the rewritten"<<std::endl;
+    ToDisplay<<"                        bytes instead of parsing the whole file again"<<std::endl;
     ToDisplay<<""<<std::endl;
     ToDisplay<<"--verbose, -v           Display more details about modified values"<<std::endl;
     ToDisplay<<""<<std::endl;
-    ToDisplay<<"--simulate, -s          Simulate only (no write)"<<std::endl;
+    ToDisplay<<"--simulate, -s          Simulate only (no write), with -v the bytes to rewrite"<<std::endl;
+    ToDisplay<<"                        and if the file would be modified in place"<<std::endl;
+    ToDisplay<<""<<std::endl;
+    ToDisplay<<"--jobs=                 Count of files opened, parsed and saved in parallel (default 1)"<<std::endl;
+    ToDisplay<<"--jobs-per-device=      Max count of files saved in parallel on a same device (default 0, no limit)"<<std::endl;
     ToDisplay<<""<<std::endl;
     ToDisplay<<"--specialchars          \\ is considered as an escape char (e.g. \\r and \\n)"<<std::endl;
     ToDisplay<<""<<std::endl;
@@ -173,6 +190,34 @@ std::string Help()
     ToDisplay<<"--MD5-Verify            Verify MD5 for audio data"<<std::endl;
     ToDisplay<<"--MD5-Embed             Embed MD5 for audio data"<<std::endl;
     ToDisplay<<"--MD5-Embed-Overwrite   Embed MD5 for audio data - Allow overwriting"<<std::endl;
+    ToDisplay<<"--Hash=                 Generate other digests for audio data, comma separated list of"<<std::endl;
+    ToDisplay<<"                        XXH3, SHA256, BLAKE3 (and MD5), in the same pass as MD5"<<std::endl;
+    ToDisplay<<"--Hash-Cache            Keep the digests in a cache, files with the same device, inode,"<<std::endl;
+    ToDisplay<<"                        size, modification time and data offset are not hashed again"<<std::endl;
+    ToDisplay<<"--Hash-Cache=Verify     Same, but some of the cached files are hashed again and compared"<<std::endl;
+    ToDisplay<<"--Hash-Cache-File=      File name of the digest cache (default DigestCache.txt in the"<<std::endl;
+    ToDisplay<<"                        application folder)"<<std::endl;
+    ToDisplay<<"--Hash-Cache-Rehash=    Percentage of the cached files hashed again with"<<std::endl;
+    ToDisplay<<"                        --Hash-Cache=Verify, the least recently hashed first (default 10)"<<std::endl;
+    ToDisplay<<"--Fixity-Index          Generate MD5 and write a digest per segment of the audio data in"<<std::endl;
+    ToDisplay<<"                        a sidecar file (FileName.fixity), resumed if interrupted"<<std::endl;
+    ToDisplay<<"--Fixity-Verify         Verify the audio data with the sidecar file, segments are"<<std::endl;
+    ToDisplay<<"                        verified in parallel and damaged byte ranges are reported"<<std::endl;
+    ToDisplay<<"--Fixity-Segment=       Size of the segments in MiB, multiple of 4 (default 64)"<<std::endl;
+    ToDisplay<<"--Loudness-Compute      Measure the loudness of the audio data (EBU R 128) and fill"<<std::endl;
+    ToDisplay<<"                        LoudnessValue, LoudnessRange, MaxTruePeakLevel,"<<std::endl;
+    ToDisplay<<"                        MaxMomentaryLoudness and MaxShortTermLoudness, PCM only"<<std::endl;
+    ToDisplay<<"--Levels                Measure the peak, RMS, DC offset, clipped samples per channel"<<std::endl;
+    ToDisplay<<"                        and the silence of the audio data, PCM only"<<std::endl;
+    ToDisplay<<"--Peak-Kernel=          Kernel of the true peak measurement: scalar, sse2 or avx2"<<std::endl;
+    ToDisplay<<"                        (default: the widest one supported by the CPU)"<<std::endl;
+    ToDisplay<<"--Silence-Detect        Detect the leading and trailing silences and the gaps of the"<<std::endl;
+    ToDisplay<<"                        audio data and mark them with cue points and labels, PCM only"<<std::endl;
+    ToDisplay<<"--Silence-Threshold=    Level in dBFS below which a frame is silent (default -60),"<<std::endl;
+    ToDisplay<<"                        also for --Levels"<<std::endl;
+    ToDisplay<<"--Silence-Duration=     Minimum duration in seconds of a silence (default 2)"<<std::endl;
+    ToDisplay<<"                        All the digests and measurements are done in one read of the"<<std::endl;
+    ToDisplay<<"                        audio data, each one in its own thread if possible"<<std::endl;
     ToDisplay<<""<<std::endl;
 
     return ToDisplay.str();
@@ -22,6 +22,7 @@
 #include "CLI/CommandLine_Parser.h"
 #include "CLI/CLI_Help.h"
 #include "Common/Common_About.h"
+#include "Riff/Riff_Peak.h"
 #include "ZenLib/ZtringList.h"
 using namespace ZenLib;
 //---------------------------------------------------------------------------
@@ -54,6 +55,10 @@ int Parse(Core &C, string &Argument)
 
     OPTION("--append",                                      Append)
     OPTION("-a",                                            Append)
+    OPTION("--insert-range",                                Insert_Range)
+    OPTION("--reserve=",                                    Reserve)
+    OPTION("--reserve-only",                                Reserve_Only)
+    OPTION("--verify-plan",                                 Verify_Plan)
 
     OPTION("--verbose",                                     Log_cout)
     OPTION("-v",                                            Log_cout)
@@ -61,6 +66,9 @@ int Parse(Core &C, string &Argument)
     OPTION("--simulate",                                    Simulate)
     OPTION("-s",                                            Simulate)
 
+    OPTION("--jobs-per-device=",                            Jobs_PerDevice)
+    OPTION("--jobs=",                                       Jobs)
+
     OPTION("--in-cset-remove",                              In_CSET_Remove)
     OPTION("--specialchars",                                SpecialChars)
     OPTION("--ignore-file-encoding",                        Ignore_File_Encoding)
@@ -117,6 +125,19 @@ int Parse(Core &C, string &Argument)
     OPTION("--md5-verify",                                  MD5_Verify)
     OPTION("--md5-embed-overwrite",                         MD5_Embed_Overwrite)
     OPTION("--md5-embed",                                   MD5_Embed)
+    OPTION("--hash=",                                       Hash)
+    OPTION("--hash-cache-file=",                            Hash_Cache_File)
+    OPTION("--hash-cache-rehash=",                          Hash_Cache_Rehash)
+    OPTION("--hash-cache",                                  Hash_Cache)
+    OPTION("--fixity-index",                                Fixity_Index)
+    OPTION("--fixity-verify",                               Fixity_Verify)
+    OPTION("--fixity-segment=",                             Fixity_Segment)
+    OPTION("--loudness-compute",                            Loudness_Compute)
+    OPTION("--levels",                                      Levels)
+    OPTION("--peak-kernel=",                                Peak_Kernel)
+    OPTION("--silence-detect",                              Silence_Detect)
+    OPTION("--silence-threshold=",                          Silence_Threshold)
+    OPTION("--silence-duration=",                           Silence_Duration)
     
     //Default
     OPTION("--",                                            Default)
@@ -190,6 +211,59 @@ CL_OPTION(Append)
     return -2; //Continue
 }
 
+//---------------------------------------------------------------------------
+CL_OPTION(Insert_Range)
+{
+    C.InsertRange=true;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Reserve)
+{
+    //Bytes, percentage of the header, or KiB up to which iXML and XMP can grow
+    string Value=Argument.substr(10);
+    int8u Kind=RIFF_Reserve_Size;
+    if (Value.find("xml:")==0)
+    {
+        Kind=RIFF_Reserve_XML;
+        Value.erase(0, 4);
+    }
+    else if (!Value.empty() && Value[Value.size()-1]=='%')
+    {
+        Kind=RIFF_Reserve_Percent;
+        Value.erase(Value.size()-1);
+    }
+    int64u Reserve=Ztring().From_UTF8(Value).To_int64u();
+    if (Value.empty() || Value.find_first_not_of("0123456789")!=string::npos || (Kind==RIFF_Reserve_Percent?Reserve>1000:(Kind==RIFF_Reserve_XML?Reserve*1024:Reserve)>256*1024*1024))
+    {
+        std::cout<<Argument.substr(10)<<" is not a valid reserve (bytes, percentage of the header with %, or xml:KiB)"<<std::endl;
+        return 0;
+    }
+
+    C.Reserve_Kind=Kind;
+    C.Reserve_Value=Reserve;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Reserve_Only)
+{
+    C.ReserveOnly=true;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Verify_Plan)
+{
+    C.VerifyPlan=true;
+
+    return -2; //Continue
+}
+
 //---------------------------------------------------------------------------
 CL_OPTION(Simulate)
 {
@@ -198,6 +272,38 @@ CL_OPTION(Simulate)
     return -2; //Continue
 }
 
+//---------------------------------------------------------------------------
+CL_OPTION(Jobs)
+{
+    Ztring Value=Ztring().From_UTF8(Argument.substr(7));
+    int64u Jobs=Value.To_int64u();
+    if (Jobs==0 || Ztring().From_Number(Jobs)!=Value)
+    {
+        std::cout<<Argument.substr(7)<<" is not a valid count of jobs"<<std::endl;
+        return 0;
+    }
+
+    C.Jobs=(size_t)Jobs;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Jobs_PerDevice)
+{
+    Ztring Value=Ztring().From_UTF8(Argument.substr(18));
+    int64u Jobs_PerDevice=Value.To_int64u();
+    if (Ztring().From_Number(Jobs_PerDevice)!=Value)
+    {
+        std::cout<<Argument.substr(18)<<" is not a valid count of jobs"<<std::endl;
+        return 0;
+    }
+
+    C.Jobs_PerDevice=(size_t)Jobs_PerDevice;
+
+    return -2; //Continue
+}
+
 //---------------------------------------------------------------------------
 CL_OPTION(Encoding)
 {
@@ -802,6 +908,190 @@ CL_OPTION(MD5_Embed_Overwrite)
     return -2; //Continue
 }
 
+//---------------------------------------------------------------------------
+CL_OPTION(Hash)
+{
+    ZtringList List;
+    List.Separator_Set(0, __T(","));
+    List.Write(Ztring().From_UTF8(Argument.substr(7)));
+    for (size_t Pos=0; Pos<List.size(); Pos++)
+    {
+        string Value=Ztring(List[Pos]).MakeLowerCase().To_UTF8();
+        if (Value=="md5")
+            C.GenerateMD5=true;
+        else if (Value=="xxh3")
+            C.GenerateHashes|=Hash_XXH3;
+        else if (Value=="sha256" || Value=="sha-256")
+            C.GenerateHashes|=Hash_SHA256;
+        else if (Value=="blake3")
+            C.GenerateHashes|=Hash_BLAKE3;
+        else
+        {
+            std::cout<<List[Pos].To_UTF8()<<" unknown hash"<<std::endl;
+            return 0;
+        }
+    }
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Hash_Cache)
+{
+    //Form : --hash-cache[=verify]
+    if (Argument.size()>12)
+    {
+        if (Argument[12]!='=' || Ztring().From_UTF8(Argument.substr(13)).MakeLowerCase()!=__T("verify"))
+        {
+            std::cout<<Argument.substr(13)<<" unknown digest cache mode"<<std::endl;
+            return 0;
+        }
+        C.Hash_Cache_Verify=true;
+    }
+    C.Hash_Cache_Enabled=true;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Hash_Cache_File)
+{
+    //Form : --hash-cache-file=(FileName)
+    C.Hash_Cache_FileName.assign(Argument, 18, std::string::npos);
+    C.Hash_Cache_Enabled=true;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Hash_Cache_Rehash)
+{
+    Ztring Value=Ztring().From_UTF8(Argument.substr(20));
+    float32 Rehash=Value.To_float32();
+    if (Value.empty() || Rehash<0 || Rehash>100 || Value.find_first_not_of(__T("0123456789."))!=string::npos)
+    {
+        std::cout<<Argument.substr(20)<<" is not a valid percentage"<<std::endl;
+        return 0;
+    }
+
+    C.Hash_Cache_Rehash=Rehash;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Fixity_Index)
+{
+    C.GenerateMD5=true;
+    C.FixityIndex=true;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Fixity_Verify)
+{
+    C.FixityVerify=true;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Fixity_Segment)
+{
+    //Size in MiB, a multiple of the read buffer size (4 MiB)
+    Ztring Value=Ztring().From_UTF8(Argument.substr(17));
+    int64u Fixity_Segment=Value.To_int64u();
+    if (Fixity_Segment==0 || Fixity_Segment%4 || Ztring().From_Number(Fixity_Segment)!=Value)
+    {
+        std::cout<<Argument.substr(17)<<" is not a valid segment size (multiple of 4 MiB)"<<std::endl;
+        return 0;
+    }
+
+    C.Fixity_Segment_Size=Fixity_Segment*1024*1024;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Loudness_Compute)
+{
+    C.ComputeLoudness=true;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Levels)
+{
+    C.ComputeLevels=true;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Peak_Kernel)
+{
+    string Value=Ztring().From_UTF8(Argument.substr(14)).MakeLowerCase().To_UTF8();
+    Riff_Peak::kernel Kernel=Riff_Peak::Kernel_FromString(Value);
+    if (Kernel==Riff_Peak::Kernel_Auto)
+    {
+        std::cout<<Argument.substr(14)<<" unknown kernel"<<std::endl;
+        return 0;
+    }
+    if (Kernel>Riff_Peak::Kernel_Best())
+    {
+        std::cout<<Argument.substr(14)<<" kernel not supported by this CPU"<<std::endl;
+        return 0;
+    }
+
+    C.Peak_Kernel=Kernel;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Silence_Detect)
+{
+    C.DetectSilences=true;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Silence_Threshold)
+{
+    //dBFS, negative
+    Ztring Value=Ztring().From_UTF8(Argument.substr(20));
+    float64 Threshold=Value.To_float64();
+    if (Value.empty() || Value.find_first_not_of(__T("-.0123456789"))!=string::npos || Threshold>=0 || Threshold<-200)
+    {
+        std::cout<<Argument.substr(20)<<" is not a valid threshold (dBFS, from -200 to 0)"<<std::endl;
+        return 0;
+    }
+
+    C.Silence_Threshold=Threshold;
+
+    return -2; //Continue
+}
+
+//---------------------------------------------------------------------------
+CL_OPTION(Silence_Duration)
+{
+    //Seconds
+    Ztring Value=Ztring().From_UTF8(Argument.substr(19));
+    float64 Duration=Value.To_float64();
+    if (Value.empty() || Value.find_first_not_of(__T(".0123456789"))!=string::npos || Duration<=0)
+    {
+        std::cout<<Argument.substr(19)<<" is not a valid duration (seconds)"<<std::endl;
+        return 0;
+    }
+
+    C.Silence_Duration=Duration;
+
+    return -2; //Continue
+}
+
 //***************************************************************************
 // Options - Default
 //***************************************************************************
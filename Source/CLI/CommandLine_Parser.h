@@ -47,7 +47,13 @@ CL_OPTION(NoPadding_Accept);
 CL_OPTION(Errors_Continue);
 CL_OPTION(Append);
 CL_OPTION(Log_cout);
+CL_OPTION(Insert_Range);
+CL_OPTION(Reserve);
+CL_OPTION(Reserve_Only);
+CL_OPTION(Verify_Plan);
 CL_OPTION(Simulate);
+CL_OPTION(Jobs);
+CL_OPTION(Jobs_PerDevice);
 CL_OPTION(SpecialChars);
 CL_OPTION(Encoding);
 CL_OPTION(Write_Encoding);
@@ -115,6 +121,19 @@ CL_OPTION(MD5_Generate);
 CL_OPTION(MD5_Verify);
 CL_OPTION(MD5_Embed);
 CL_OPTION(MD5_Embed_Overwrite);
+CL_OPTION(Hash);
+CL_OPTION(Hash_Cache);
+CL_OPTION(Hash_Cache_File);
+CL_OPTION(Hash_Cache_Rehash);
+CL_OPTION(Fixity_Index);
+CL_OPTION(Fixity_Verify);
+CL_OPTION(Fixity_Segment);
+CL_OPTION(Loudness_Compute);
+CL_OPTION(Levels);
+CL_OPTION(Peak_Kernel);
+CL_OPTION(Silence_Detect);
+CL_OPTION(Silence_Threshold);
+CL_OPTION(Silence_Duration);
 
 //---------------------------------------------------------------------------
 CL_OPTION(Default);
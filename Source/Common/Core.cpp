@@ -22,6 +22,9 @@
 #include "ZenLib/OS_Utils.h"
 #include "Common/Common_About.h"
 #include "Riff/Riff_Handler.h"
+#include "Riff/Riff_Hash_Cache.h"
+#include "Riff/Riff_Fixity_Index.h"
+#include "Riff/Riff_Silence.h"
 #include <sstream>
 #include <ctime>
 #include <algorithm>
@@ -29,6 +32,9 @@
     #undef _TEXT
     #undef __TEXT
     #include "shlobj.h"
+#else //_WIN32
+    #include <sys/stat.h>
+    #include <dirent.h>
 #endif //_WIN32
 using namespace ZenLib;
 using namespace std;
@@ -123,6 +129,112 @@ bool Prepare_Xml_For_Nesting(std::string& Xml)
     return UseCDATA;
 }
 
+//---------------------------------------------------------------------------
+// Identifier of the device/volume hosting the file, empty if unknown
+string Device_Get(const string &FileName)
+{
+    #ifdef _WIN32
+        TCHAR Volume[MAX_PATH];
+        if (!GetVolumePathName(Ztring().From_UTF8(FileName).c_str(), Volume, MAX_PATH))
+            return string();
+        return Ztring(Volume).MakeLowerCase().To_UTF8();
+    #else //_WIN32
+        struct stat Stat;
+        if (stat(Ztring().From_UTF8(FileName).To_Local().c_str(), &Stat))
+            return string();
+        return Ztring().From_Number((int64u)Stat.st_dev).To_UTF8();
+    #endif //_WIN32
+}
+
+//---------------------------------------------------------------------------
+// Extension is .wav, without building a lower case copy of the name
+template<typename T> bool Name_IsWav(const T* Name)
+{
+    size_t Size=0;
+    while (Name[Size])
+        Size++;
+    if (Size<4)
+        return false;
+    const T* Ext=Name+Size-4;
+    return Ext[0]=='.' && (Ext[1]=='w' || Ext[1]=='W') && (Ext[2]=='a' || Ext[2]=='A') && (Ext[3]=='v' || Ext[3]=='V');
+}
+
+//---------------------------------------------------------------------------
+// Content of one directory, hidden files are ignored, return the count of files found (including the ones filtered out)
+size_t Dir_List(const Ztring &Dir_Name, bool WavOnly, vector<string> &Files, vector<Ztring> &SubDirs)
+{
+    size_t Count=0;
+
+    #ifdef _WIN32
+        Ztring Base=Dir_Name;
+        if (!Base.empty() && Base[Base.size()-1]!=__T('\\') && Base[Base.size()-1]!=__T('/'))
+            Base+=__T('\\');
+        WIN32_FIND_DATA FindData;
+        HANDLE Find=FindFirstFile((Base+__T('*')).c_str(), &FindData);
+        if (Find==INVALID_HANDLE_VALUE)
+            return 0;
+        do
+        {
+            const TCHAR* Name=FindData.cFileName;
+            if (Name[0]==__T('.') && (!Name[1] || (Name[1]==__T('.') && !Name[2])))
+                continue; //Avoid . and ..
+            if (FindData.dwFileAttributes&FILE_ATTRIBUTE_DIRECTORY)
+                SubDirs.push_back(Base+Name);
+            else if (Name[0]!=__T('.'))
+            {
+                Count++;
+                if (!WavOnly || Name_IsWav(Name))
+                    Files.push_back((Base+Name).To_UTF8());
+            }
+        }
+        while (FindNextFile(Find, &FindData));
+        FindClose(Find);
+    #else //_WIN32
+        string Base=Dir_Name.To_Local();
+        if (!Base.empty() && Base[Base.size()-1]!='/')
+            Base+='/';
+        DIR* Dir=opendir(Base.c_str());
+        if (!Dir)
+            return 0;
+        struct dirent* DirEnt;
+        while ((DirEnt=readdir(Dir))!=NULL)
+        {
+            const char* Name=DirEnt->d_name;
+            if (Name[0]=='.' && (!Name[1] || (Name[1]=='.' && !Name[2])))
+                continue; //Avoid . and ..
+            string Name_Complete=Base+Name;
+            bool IsDir;
+            #ifdef DT_DIR
+            if (DirEnt->d_type!=DT_UNKNOWN && DirEnt->d_type!=DT_LNK)
+                IsDir=DirEnt->d_type==DT_DIR;
+            else
+            #endif //DT_DIR
+            {
+                struct stat Stat;
+                IsDir=!stat(Name_Complete.c_str(), &Stat) && S_ISDIR(Stat.st_mode);
+            }
+            if (IsDir)
+                SubDirs.push_back(Ztring().From_Local(Name_Complete));
+            else if (Name[0]!='.')
+            {
+                Count++;
+                if (!WavOnly || Name_IsWav(Name))
+                    Files.push_back(Ztring().From_Local(Name_Complete).To_UTF8());
+            }
+        }
+        closedir(Dir);
+    #endif //_WIN32
+
+    return Count;
+}
+
+//---------------------------------------------------------------------------
+// Largest size first
+template<typename T> bool Size_Compare(const T &A, const T &B)
+{
+    return A.first>B.first;
+}
+
 //---------------------------------------------------------------------------
 
 //***************************************************************************
@@ -139,7 +251,25 @@ Core::Core()
     FileNotValid_Skip=false;
     WrongExtension_Skip=false;
     NewChunksAtTheEnd=false;
+    InsertRange=false;
+    Reserve_Kind=RIFF_Reserve_Size;
+    Reserve_Value=RIFF_WAVE_FLLR_DefaultSise;
+    ReserveOnly=false;
+    VerifyPlan=false;
     GenerateMD5=false;
+    GenerateHashes=0;
+    Hash_Cache_Enabled=false;
+    Hash_Cache_Verify=false;
+    Hash_Cache_Rehash=10;
+    FixityIndex=false;
+    FixityVerify=false;
+    Fixity_Segment_Size=RIFF_Fixity_Segment_DefaultSize;
+    ComputeLoudness=false;
+    ComputeLevels=false;
+    Peak_Kernel=0;
+    DetectSilences=false;
+    Silence_Threshold=RIFF_Silence_DefaultThreshold;
+    Silence_Duration=RIFF_Silence_DefaultDuration;
     VerifyMD5=false;
     VerifyMD5_Force=false;
     EmbedMD5=false;
@@ -179,6 +309,8 @@ Core::Core()
 
     Batch_Enabled=false;
     Batch_IsBackuping=false;
+    Jobs=1;
+    Jobs_PerDevice=0;
 
     Trace_UseDec=false;
 
@@ -194,6 +326,13 @@ Core::Core()
     Files_Modified_NotWritten_Count=0;
     Canceled=false;
     SaveMode=false;
+    Menu_File_Open_Files_Walking=false;
+    Menu_File_Open_Files_Found_Pos=0;
+    Savers_Enabled=false;
+    Outputter=NULL;
+    Out_Tech_File_Failed=false;
+    Out_Core_CSV_File_Failed=false;
+    Hash_Cache=NULL;
     #ifdef _WIN32
         TCHAR Path[MAX_PATH];
         BOOL Result=SHGetSpecialFolderPath(NULL, Path, CSIDL_APPDATA, true);
@@ -205,6 +344,16 @@ Core::Core()
 
 Core::~Core()
 {
+    if (Menu_File_Open_Files_Walking)
+        Canceled=true; //Files found by the directory walk are not used
+    Menu_File_Open_Files_Workers_Stop();
+    Batch_Launch_Write_Wait(Canceled);
+    Output_Wait();
+    if (Hash_Cache)
+    {
+        Hash_Cache->Save();
+        delete Hash_Cache; //Hash_Cache=NULL;
+    }
 }
 
 //***************************************************************************
@@ -222,11 +371,36 @@ size_t Core::Menu_File_Open (const string& FileName)
 //---------------------------------------------------------------------------
 void Core::Menu_File_Open_Files_Begin ()
 {
+    //Digest cache
+    if (Hash_Cache_Enabled && !Hash_Cache)
+    {
+        Ztring FileName=Ztring().From_UTF8(Hash_Cache_FileName);
+        if (FileName.empty())
+        {
+            if (!Dir::Exists(ApplicationFolder))
+                Dir::Create(ApplicationFolder);
+            FileName=ApplicationFolder+PathSeparator+__T("DigestCache.txt");
+        }
+        Hash_Cache=new Riff_Hash_Cache(FileName, Hash_Cache_Verify?Hash_Cache_Rehash/100:0);
+        if (!Hash_Cache->Load())
+        {
+            StdErr(FileName.To_UTF8()+": digest cache can not be read, not used");
+            delete Hash_Cache; Hash_Cache=NULL;
+        }
+    }
 }
 
 //---------------------------------------------------------------------------
 size_t Core::Menu_File_Open_Files_Continue (const string &FileName)
 {
+    //Directory - files are filtered and added during the walk
+    if (!File::Exists(Ztring().From_UTF8(FileName)) && Dir::Exists(Ztring().From_UTF8(FileName)))
+    {
+        size_t Count=Menu_File_Open_Files_Walk(Ztring().From_UTF8(FileName));
+        if (Count)
+            return Count;
+    }
+
     ZtringList List;
     if (File::Exists(Ztring().From_UTF8(FileName)))
         List.push_back(Ztring().From_UTF8(FileName));
@@ -237,6 +411,7 @@ size_t Core::Menu_File_Open_Files_Continue (const string &FileName)
             List.push_back(Ztring().From_UTF8(FileName));
     }
 
+    CriticalSectionLocker CSL(CS); //Workers may already open files found by a directory walk
     for (size_t Pos=0; Pos<List.size(); Pos++)
         if (!WrongExtension_Skip || (List[Pos].size()>4 && Ztring(List[Pos]).MakeLowerCase().rfind(__T(".wav"))==List[Pos].size()-4))
             Handlers[List[Pos].To_UTF8()]; //Adding the reference
@@ -244,6 +419,105 @@ size_t Core::Menu_File_Open_Files_Continue (const string &FileName)
     return List.size();
 }
 
+//---------------------------------------------------------------------------
+size_t Core::Menu_File_Open_Files_Walk (const Ztring &Dir_Name)
+{
+    {
+        CriticalSectionLocker CSL(CS);
+        Walk_Pending.clear();
+        Walk_Pending.push_back(Dir_Name);
+        Walk_Busy=0;
+        Walk_Count=0;
+
+        //Parallel open - files are opened by workers as soon as they are found, previous instances are opened again after the walk
+        if (Jobs>1 && Workers.empty())
+        {
+            for (handlers::iterator Item=Handlers.begin(); Item!=Handlers.end(); Item++)
+                Item->second.Open_State=Open_State_None;
+            Menu_File_Open_Files_Found.clear();
+            Menu_File_Open_Files_Found_Pos=0;
+            Menu_File_Open_Files_Ahead=0;
+            Progress_Parallel.Done=0;
+            Menu_File_Open_Files_Walking=true;
+        }
+    }
+
+    //Subdirectories are listed in parallel, the calling thread is one of the walkers
+    vector<walker*> Walkers;
+    for (size_t Pos=1; Pos<Jobs; Pos++)
+    {
+        Walkers.push_back(new walker(this));
+        Walkers.back()->Run();
+    }
+    Menu_File_Open_Files_Walk_Worker();
+    for (size_t Pos=0; Pos<Walkers.size(); Pos++)
+    {
+        while (Walkers[Pos]->IsRunning())
+            Sleep(1);
+        delete Walkers[Pos];
+    }
+
+    return Walk_Count;
+}
+
+//---------------------------------------------------------------------------
+void Core::Menu_File_Open_Files_Walk_Worker ()
+{
+    vector<string> Files;
+    vector<Ztring> SubDirs;
+    for (;;)
+    {
+        Ztring Dir_Name;
+        {
+            CriticalSectionLocker CSL(CS);
+            if (Walk_Pending.empty())
+            {
+                if (!Walk_Busy)
+                    return; //Nothing more to list
+            }
+            else
+            {
+                Dir_Name=Walk_Pending.back();
+                Walk_Pending.pop_back();
+                Walk_Busy++;
+            }
+        }
+
+        //Waiting for directories found by other walkers
+        if (Dir_Name.empty())
+        {
+            Sleep(1);
+            continue;
+        }
+
+        Files.clear();
+        SubDirs.clear();
+        size_t Count=Dir_List(Dir_Name, WrongExtension_Skip, Files, SubDirs);
+
+        CriticalSectionLocker CSL(CS);
+        for (size_t Pos=0; Pos<Files.size(); Pos++)
+        {
+            handlers::iterator Item=Handlers.find(Files[Pos]);
+            if (Item!=Handlers.end())
+                continue; //Already in the list
+            Item=Handlers.insert(handlers::value_type(Files[Pos], handler())).first; //Adding the reference
+            if (Menu_File_Open_Files_Walking)
+                Menu_File_Open_Files_Found.push_back(Item);
+        }
+        Walk_Pending.insert(Walk_Pending.end(), SubDirs.begin(), SubDirs.end());
+
+        //Parallel open - launching workers with the first files found
+        if (Menu_File_Open_Files_Walking && Workers.empty() && !Menu_File_Open_Files_Found.empty())
+            for (size_t Pos=1; Pos<Jobs; Pos++)
+            {
+                Workers.push_back(new worker(this));
+                Workers.back()->Run();
+            }
+        Walk_Count+=Count;
+        Walk_Busy--;
+    }
+}
+
 //---------------------------------------------------------------------------
 size_t Core::Menu_File_Open_Files_Finish ()
 {
@@ -255,6 +529,8 @@ size_t Core::Menu_File_Open_Files_Finish ()
     }
     catch (const char *)
     {
+        Menu_File_Open_Files_Workers_Stop();
+        Batch_Launch_Write_Wait();
         return 0;
     }
     return Menu_File_Open_Files_Finish_End();
@@ -291,11 +567,64 @@ bool Core::Menu_File_Open_Files_Finish_Start()
     if (Batch_Enabled)
         Batch_Begin();
 
+    //Parallel open - largest files are taken first, workers may already be launched by the directory walk
+    bool Parallel=Jobs>1 && (Handlers.size()>1 || !Workers.empty());
+    vector<pair<int64u, handlers::iterator> > Sizes;
+    if (Parallel)
+        for (handlers::iterator Item=Handlers.begin(); Item!=Handlers.end(); Item++)
+            Sizes.push_back(make_pair(File::Size_Get(Ztring().From_UTF8(Item->first)), Item));
+    stable_sort(Sizes.begin(), Sizes.end(), Size_Compare<pair<int64u, handlers::iterator> >);
+
     CriticalSectionLocker CSL(CS);
     Menu_File_Open_Files_File_Pos=0;
     Menu_File_Open_Files_File_Total=Handlers.size();
     Handler=Handlers.begin();
 
+    //Parallel save
+    Savers_Enabled=Batch_Enabled && Jobs>1;
+
+    //Parallel open - previous instances are released, files taken during the directory walk are kept
+    if (Parallel)
+    {
+        if (Workers.empty())
+        {
+            Menu_File_Open_Files_Ahead=0;
+            Progress_Parallel.Done=0;
+        }
+        Menu_File_Open_Files_Next=Handlers.begin();
+        Menu_File_Open_Files_BySize.clear();
+        int64u Sizes_Total=0;
+        for (size_t Pos=0; Pos<Sizes.size(); Pos++)
+        {
+            handlers::iterator Item=Sizes[Pos].second;
+            Sizes_Total+=Sizes[Pos].first;
+            if (!Workers.empty() && Item->second.Open_State!=Open_State_None)
+                continue;
+            if (Item->second.Riff)
+            {
+                if (Item->second.Riff->IsModified_Get())
+                    Files_Modified_NotWritten_Count--;
+                delete Item->second.Riff; Item->second.Riff=NULL;
+            }
+            Item->second.Open_State=Open_State_None;
+            Menu_File_Open_Files_BySize.push_back(Item);
+        }
+        Menu_File_Open_Files_BySize_Pos=0;
+        Progress_Parallel.Total=Sizes_Total;
+    }
+    Menu_File_Open_Files_Walking=false;
+
+    //Parallel open - launching workers, the calling thread handles files in order
+    if (Parallel)
+    {
+        size_t Workers_Count=(Jobs<Handlers.size()?Jobs:Handlers.size())-1;
+        for (size_t Pos=Workers.size(); Pos<Workers_Count; Pos++)
+        {
+            Workers.push_back(new worker(this));
+            Workers.back()->Run();
+        }
+    }
+
     return Handler!=Handlers.end();
 }
 
@@ -307,81 +636,41 @@ float Core::Menu_File_Open_Files_Finish_Middle ()
 
     try
     {
-        if (Handler->second.Riff)
+        bool Open_Result;
+        if (Workers.empty())
         {
-            if (Handler->second.Riff->IsModified_Get())
-                Files_Modified_NotWritten_Count--;
-            delete Handler->second.Riff; Handler->second.Riff=NULL;
-        }
-        if (Handler->second.Riff==NULL || !Handler->second.Riff->IsValid_Get())
-        {
-            //Creation and configuration
-            delete Handler->second.Riff; Handler->second.Riff=new Riff_Handler();
-            StdClear(Handler);
-
-            //Options
-            Options_Update(Handler);
-            
-            //Settings - Removal
-            Handler->second.In_Core_Remove=In_Core_Remove;
-            Handler->second.In__PMX_Remove=In__PMX_Remove;
-            Handler->second.In__PMX_XML=In__PMX_XML;
-            Handler->second.In__PMX_FileName=In__PMX_FileName;
-            Handler->second.In_aXML_Remove=In_aXML_Remove;
-            Handler->second.In_aXML_XML=In_aXML_XML;
-            Handler->second.In_aXML_FileName=In_aXML_FileName;
-            Handler->second.In_iXML_Remove=In_iXML_Remove;
-            Handler->second.In_iXML_XML=In_iXML_XML;
-            Handler->second.In_iXML_FileName=In_iXML_FileName;
-            Handler->second.In_cue__Remove=In_cue__Remove;
-            Handler->second.In_cue__XML=In_cue__XML;
-            Handler->second.In_cue__FileName=In_cue__FileName;
-            Handler->second.In_CSET_Remove=In_CSET_Remove;
-
-            //Settings - Adding default Core values if the Core value does not exist yet (from --xxx=)
-            for (map<string, Ztring>::iterator In_Core_Item=Handler_Default.In_Core.begin(); In_Core_Item!=Handler_Default.In_Core.end(); In_Core_Item++)
-            {
-                map<string, Ztring>::iterator Handler_in_Core_Item=Handler->second.In_Core.find(Ztring().From_UTF8(In_Core_Item->first).MakeLowerCase().To_UTF8());
-                if (Handler_in_Core_Item==Handler->second.In_Core.end())
-                    Handler->second.In_Core[Ztring().From_UTF8(In_Core_Item->first).MakeLowerCase().To_UTF8()]=In_Core_Item->second;
-            }
-            
-            //Special Characters
-            if (SpecialChars_Enabled)
-            {
-                for (map<string, Ztring>::iterator Field=Handler->second.In_Core.begin(); Field!=Handler->second.In_Core.end(); Field++)
-                {
-                    Field->second.FindAndReplace(__T("\\\\"), __T("|SC1|"), 0, Ztring_Recursive);
-                    Field->second.FindAndReplace(__T("\\r"), __T("\r"), 0, Ztring_Recursive);
-                    Field->second.FindAndReplace(__T("\\n"), __T("\n"), 0, Ztring_Recursive);
-                    Field->second.FindAndReplace(__T("\\t"), __T("\t"), 0, Ztring_Recursive);
-                    Field->second.FindAndReplace(__T("\\0"), __T("\0"), 0, Ztring_Recursive);
-                    Field->second.FindAndReplace(__T("|SC1|"), __T("\\"), 0, Ztring_Recursive);
-                }
-            }
-
-            //Reading
-            if (!Handler->second.Riff->Open(Handler->first))
-            {
-                StdAll(Handler);
-                if ((FileNotValid_Skip && !Handler->second.Riff->IsValid_Get()) ||(!Errors_Continue && Text_stderr_Updated))
-                    throw string(); //Error during the parsing, exiting
-            }
-            if (Handler->second.Riff->Canceled_Get())
+            if (Handler->second.Riff)
             {
-                delete Handler->second.Riff, Handler->second.Riff=NULL;
-                CriticalSectionLocker CSL(CS);
-                Canceled=true;
-                throw string(); //Canceling
+                if (Handler->second.Riff->IsModified_Get())
+                    Files_Modified_NotWritten_Count--;
+                delete Handler->second.Riff; Handler->second.Riff=NULL;
             }
+            Open_Result=Menu_File_Open_Files_Finish_Open(Handler);
+        }
+        else
+            Open_Result=Menu_File_Open_Files_Finish_Wait(Handler);
 
-            if (Handler->second.Riff->IsModified_Get())
-                Files_Modified_NotWritten_Count++;
-
+        //Reading
+        if (!Open_Result)
+        {
             StdAll(Handler);
-            StdOut(Handler->first+": Is open");
+            if ((FileNotValid_Skip && !Handler->second.Riff->IsValid_Get()) ||(!Errors_Continue && Text_stderr_Updated))
+                throw string(); //Error during the parsing, exiting
+        }
+        if (Handler->second.Riff->Canceled_Get())
+        {
+            delete Handler->second.Riff, Handler->second.Riff=NULL;
+            CriticalSectionLocker CSL(CS);
+            Canceled=true;
+            throw string(); //Canceling
         }
 
+        if (Handler->second.Riff->IsModified_Get())
+            Files_Modified_NotWritten_Count++;
+
+        StdAll(Handler);
+        StdOut(Handler->first+": Is open");
+
         bool IsModified_Old=Handler->second.Riff->IsModified_Get();
 
         //Modifying file with --xxx values
@@ -505,16 +794,20 @@ float Core::Menu_File_Open_Files_Finish_Middle ()
         if (!Errors_Continue && Text_stderr_Updated)
             throw string(); //Error during the parsing, exiting
 
-        //Batch - Activate
-        if (Batch_Enabled)
-            Batch_Launch(Handler);
-
         bool IsModified_New=Handler->second.Riff->IsModified_Get();
         if (!IsModified_Old && IsModified_New)
             Files_Modified_NotWritten_Count++;
 
         StdAll(Handler);
 
+        //Batch - Activate
+        if (Batch_Enabled)
+        {
+            Batch_Launch(Handler);
+            if (!Savers_Enabled || Simulation_Enabled)
+                StdAll(Handler); //Else the file may still be saved by a saver thread, which reports by itself
+        }
+
         CriticalSectionLocker CSL(CS);
 
         Handler++;
@@ -534,6 +827,19 @@ float Core::Menu_File_Open_Files_Finish_Middle ()
             //File is not a valid RIFF file, we keep it out from the map
             handlers::iterator Handler_ToDelete=Handler;
             Handler++;
+            if (!Workers.empty())
+            {
+                if (Menu_File_Open_Files_Next==Handler_ToDelete)
+                    Menu_File_Open_Files_Next++;
+                for (size_t Pos=0; Pos<Menu_File_Open_Files_BySize.size(); Pos++)
+                    if (Menu_File_Open_Files_BySize[Pos]==Handler_ToDelete)
+                    {
+                        Menu_File_Open_Files_BySize.erase(Menu_File_Open_Files_BySize.begin()+Pos);
+                        if (Pos<Menu_File_Open_Files_BySize_Pos)
+                            Menu_File_Open_Files_BySize_Pos--;
+                        break;
+                    }
+            }
             Handlers.erase(Handler_ToDelete);
 
             Menu_File_Open_Files_File_Pos--;
@@ -547,11 +853,208 @@ float Core::Menu_File_Open_Files_Finish_Middle ()
         return 1.0;
 
     Menu_File_Open_Files_File_Pos++;
+    if (Menu_File_Open_Files_File_Pos>=Menu_File_Open_Files_File_Total)
+        Progress_Parallel.Total=0; //Back to the count of files, finished
     if (Menu_File_Open_Files_File_Total==0)
         return 1.0;
     return ((float)Menu_File_Open_Files_File_Pos)/Menu_File_Open_Files_File_Total;
 }
 
+//---------------------------------------------------------------------------
+bool Core::Menu_File_Open_Files_Finish_Open(handlers::iterator &Handler)
+{
+    //Creation and configuration
+    Riff_Handler* Riff=new Riff_Handler();
+    Riff->Progress_Parent_Set(&Progress_Parallel);
+    {
+        CriticalSectionLocker CSL(CS);
+        Handler->second.Riff=Riff;
+    }
+    StdClear(Handler);
+
+    //Options (file is not open yet, nothing is reported)
+    Options_Update(Handler);
+
+    //Settings - Removal
+    Handler->second.In_Core_Remove=In_Core_Remove;
+    Handler->second.In__PMX_Remove=In__PMX_Remove;
+    Handler->second.In__PMX_XML=In__PMX_XML;
+    Handler->second.In__PMX_FileName=In__PMX_FileName;
+    Handler->second.In_aXML_Remove=In_aXML_Remove;
+    Handler->second.In_aXML_XML=In_aXML_XML;
+    Handler->second.In_aXML_FileName=In_aXML_FileName;
+    Handler->second.In_iXML_Remove=In_iXML_Remove;
+    Handler->second.In_iXML_XML=In_iXML_XML;
+    Handler->second.In_iXML_FileName=In_iXML_FileName;
+    Handler->second.In_cue__Remove=In_cue__Remove;
+    Handler->second.In_cue__XML=In_cue__XML;
+    Handler->second.In_cue__FileName=In_cue__FileName;
+    Handler->second.In_CSET_Remove=In_CSET_Remove;
+
+    //Settings - Adding default Core values if the Core value does not exist yet (from --xxx=)
+    for (map<string, Ztring>::iterator In_Core_Item=Handler_Default.In_Core.begin(); In_Core_Item!=Handler_Default.In_Core.end(); In_Core_Item++)
+    {
+        map<string, Ztring>::iterator Handler_in_Core_Item=Handler->second.In_Core.find(Ztring().From_UTF8(In_Core_Item->first).MakeLowerCase().To_UTF8());
+        if (Handler_in_Core_Item==Handler->second.In_Core.end())
+            Handler->second.In_Core[Ztring().From_UTF8(In_Core_Item->first).MakeLowerCase().To_UTF8()]=In_Core_Item->second;
+    }
+
+    //Special Characters
+    if (SpecialChars_Enabled)
+    {
+        for (map<string, Ztring>::iterator Field=Handler->second.In_Core.begin(); Field!=Handler->second.In_Core.end(); Field++)
+        {
+            Field->second.FindAndReplace(__T("\\\\"), __T("|SC1|"), 0, Ztring_Recursive);
+            Field->second.FindAndReplace(__T("\\r"), __T("\r"), 0, Ztring_Recursive);
+            Field->second.FindAndReplace(__T("\\n"), __T("\n"), 0, Ztring_Recursive);
+            Field->second.FindAndReplace(__T("\\t"), __T("\t"), 0, Ztring_Recursive);
+            Field->second.FindAndReplace(__T("\\0"), __T("\0"), 0, Ztring_Recursive);
+            Field->second.FindAndReplace(__T("|SC1|"), __T("\\"), 0, Ztring_Recursive);
+        }
+    }
+
+    //Reading
+    return Handler->second.Riff->Open(Handler->first);
+}
+
+//---------------------------------------------------------------------------
+bool Core::Menu_File_Open_Files_Finish_Wait(handlers::iterator &Handler)
+{
+    for (;;)
+    {
+        handlers::iterator Item;
+        {
+            CriticalSectionLocker CSL(CS);
+            if (Handler->second.Open_State==Open_State_Done)
+            {
+                Menu_File_Open_Files_Ahead--;
+                return Handler->second.Open_Result;
+            }
+
+            //Taking the file if no worker did it yet, else helping with the next ones in order
+            if (Handler->second.Open_State==Open_State_None)
+            {
+                Item=Handler;
+                Item->second.Open_State=Open_State_Running;
+                Menu_File_Open_Files_Ahead++;
+            }
+            else
+                Item=Menu_File_Open_Files_Claim(true);
+        }
+
+        if (Item==Handlers.end())
+        {
+            Sleep(1);
+            continue;
+        }
+
+        bool Result=Menu_File_Open_Files_Finish_Open(Item);
+
+        CriticalSectionLocker CSL(CS);
+        Item->second.Open_Result=Result;
+        Item->second.Open_State=Open_State_Done;
+    }
+}
+
+//---------------------------------------------------------------------------
+Core::handlers::iterator Core::Menu_File_Open_Files_Claim(bool InOrder)
+{
+    handlers::iterator Item=Handlers.end();
+
+    //Files found by the directory walk, sizes and order are not known yet
+    if (Menu_File_Open_Files_Walking)
+    {
+        if (Menu_File_Open_Files_Ahead<Jobs*4 && Menu_File_Open_Files_Found_Pos<Menu_File_Open_Files_Found.size())
+            Item=Menu_File_Open_Files_Found[Menu_File_Open_Files_Found_Pos++];
+    }
+
+    //Largest files first, so a big file does not finish alone at the end
+    else if (!InOrder && Menu_File_Open_Files_Ahead<Jobs*2)
+    {
+        while (Menu_File_Open_Files_BySize_Pos<Menu_File_Open_Files_BySize.size() && Menu_File_Open_Files_BySize[Menu_File_Open_Files_BySize_Pos]->second.Open_State!=Open_State_None)
+            Menu_File_Open_Files_BySize_Pos++;
+        if (Menu_File_Open_Files_BySize_Pos<Menu_File_Open_Files_BySize.size())
+            Item=Menu_File_Open_Files_BySize[Menu_File_Open_Files_BySize_Pos];
+    }
+
+    //Else stealing the next files needed by the calling thread
+    if (!Menu_File_Open_Files_Walking && Item==Handlers.end() && Menu_File_Open_Files_Ahead<Jobs*4)
+    {
+        while (Menu_File_Open_Files_Next!=Handlers.end() && Menu_File_Open_Files_Next->second.Open_State!=Open_State_None)
+            Menu_File_Open_Files_Next++;
+        Item=Menu_File_Open_Files_Next;
+    }
+
+    if (Item!=Handlers.end())
+    {
+        Item->second.Open_State=Open_State_Running;
+        Menu_File_Open_Files_Ahead++;
+    }
+    return Item;
+}
+
+//---------------------------------------------------------------------------
+void Core::Menu_File_Open_Files_Worker()
+{
+    for (;;)
+    {
+        handlers::iterator Item;
+        {
+            CriticalSectionLocker CSL(CS);
+            if (Canceled)
+                return;
+            if (!Menu_File_Open_Files_Walking) //Else waiting for the next files found by the directory walk
+            {
+                while (Menu_File_Open_Files_Next!=Handlers.end() && Menu_File_Open_Files_Next->second.Open_State!=Open_State_None)
+                    Menu_File_Open_Files_Next++;
+                if (Menu_File_Open_Files_Next==Handlers.end())
+                    return; //All files are taken
+            }
+            Item=Menu_File_Open_Files_Claim();
+        }
+
+        //Open files not yet used are limited
+        if (Item==Handlers.end())
+        {
+            Sleep(1);
+            continue;
+        }
+
+        bool Result=Menu_File_Open_Files_Finish_Open(Item);
+
+        CriticalSectionLocker CSL(CS);
+        Item->second.Open_Result=Result;
+        Item->second.Open_State=Open_State_Done;
+    }
+}
+
+//---------------------------------------------------------------------------
+void Core::Menu_File_Open_Files_Workers_Stop()
+{
+    if (Workers.empty())
+        return;
+
+    //Canceling files currently parsed
+    vector<Riff_Handler*> ToCancel;
+    {
+        CriticalSectionLocker CSL(CS);
+        if (Canceled)
+            for (handlers::iterator Item=Handlers.begin(); Item!=Handlers.end(); Item++)
+                if (Item->second.Open_State==Open_State_Running && Item->second.Riff)
+                    ToCancel.push_back(Item->second.Riff);
+    }
+    for (size_t Pos=0; Pos<ToCancel.size(); Pos++)
+        ToCancel[Pos]->Cancel();
+
+    for (size_t Pos=0; Pos<Workers.size(); Pos++)
+    {
+        while (Workers[Pos]->IsRunning())
+            Sleep(10);
+        delete Workers[Pos];
+    }
+    Workers.clear();
+}
+
 //---------------------------------------------------------------------------
 size_t Core::Menu_File_Open_Files_Finish_End()
 {
@@ -562,11 +1065,14 @@ size_t Core::Menu_File_Open_Files_Finish_End()
     {
         CS.Enter();
         Canceled=true;
-        Handler->second.Riff->Cancel();
+        if (Handler!=Handlers.end() && Handler->second.Riff)
+            Handler->second.Riff->Cancel();
         CS.Leave();
 	    while(!IsExited())
 		    Sleep(20);
     }
+    Menu_File_Open_Files_Workers_Stop();
+    Progress_Parallel.Total=0;
         
     CriticalSectionLocker CSL(CS);
 
@@ -591,6 +1097,10 @@ size_t Core::Menu_File_Open_Files_Finish_End()
     if (Batch_Enabled)
         Batch_Finish();
 
+    //Digest cache
+    if (Hash_Cache)
+        Hash_Cache->Save();
+
     Canceled=false;
     return Handlers.size();
 }
@@ -627,6 +1137,14 @@ bool Core::Menu_File_Open_Files_BackToLastSave()
 //---------------------------------------------------------------------------
 float Core::Menu_File_Open_State ()
 {
+    //Parallel open - lock-free, bytes done across all files in progress
+    if (Progress_Parallel.Total)
+    {
+        float ToReturn=Progress_Parallel.Get();
+        if (ToReturn<1)
+            return ToReturn;
+    }
+
     CriticalSectionLocker CSL(CS);
     if (Menu_File_Open_Files_File_Total==0)
         return 1.0; //No file
@@ -955,13 +1473,19 @@ size_t Core::Menu_File_Save_End ()
     {
         CS.Enter();
         Canceled=true;
-        Handler->second.Riff->Cancel();
+        if (Handler!=Handlers.end() && Handler->second.Riff)
+            Handler->second.Riff->Cancel();
         CS.Leave();
         while(!IsExited())
             Sleep(20);
     }
+    Batch_Launch_Write_Wait(Canceled);
 
     Batch_Launch_End();
+
+    //Digest cache
+    if (Hash_Cache)
+        Hash_Cache->Save();
     
     return Handlers.size();
 }
@@ -1531,18 +2055,33 @@ void Core::Batch_Begin()
         Out_XML_Doc->InsertEndChild(Out_XML_Doc->NewDeclaration());
         Out_XML_Doc->InsertEndChild(Out_XML_Doc->NewElement("conformance_point_document"));
     }
+
+    //Ordered output, file rows are written by a dedicated thread
+    if (!Out_Tech_CSV_FileName.empty() || !Out_Core_CSV_FileName.empty())
+        Output_Start();
 }
 
 //---------------------------------------------------------------------------
 void Core::Batch_Finish()
 {
+    //Ordered output, remaining rows
+    Output_Wait();
+
     //--out-technical-file
     if (!Out_Tech_CSV_FileName.empty())
+    {
+        if (Out_Tech_File_Failed) //Error on the last rows
+            StdErr("--out-technical-file: error during file writing");
         Out_Tech_File.Close();
+    }
 
     //--out-Core-CSV=file
     if (!Out_Core_CSV_FileName.empty())
+    {
+        if (Out_Core_CSV_File_Failed) //Error on the last rows
+            StdErr("--out-Core-CSV=file: error during file writing");
         Out_Core_CSV_File.Close();
+    }
 
     //--out-Tech-XML=file
     if (Out_Tech_XML_Doc)
@@ -1624,6 +2163,94 @@ void Core::Batch_Finish()
     }
 }
 
+//---------------------------------------------------------------------------
+void Core::Output_Start()
+{
+    Output_Wait();
+
+    Out_Tech_File_Failed=false;
+    Out_Core_CSV_File_Failed=false;
+    Output_Stop=false;
+    Outputter=new outputter(this);
+    Outputter->Run();
+}
+
+//---------------------------------------------------------------------------
+bool Core::Output_Write(File &F, std::atomic<bool> &Failed, const Ztring &Text)
+{
+    if (!Outputter)
+        return F.Write(Text)!=0;
+    if (Failed)
+        return false; //A previous row of this file was not written
+
+    //Kept with the other rows of this file until Output_Commit()
+    Output_Rows.push_back(output_item());
+    Output_Rows.back().F=&F;
+    Output_Rows.back().Failed=&Failed;
+    Output_Rows.back().Text=Text;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void Core::Output_Commit()
+{
+    CriticalSectionLocker CSL(Output_CS);
+    Output_Pending.push_back(vector<output_item>());
+    Output_Pending.back().swap(Output_Rows);
+}
+
+//---------------------------------------------------------------------------
+void Core::Output_Worker()
+{
+    vector<output_item> Rows;
+    for (;;)
+    {
+        //Next file, files are committed in order
+        bool Found=false;
+        bool Stop;
+        {
+            CriticalSectionLocker CSL(Output_CS);
+            if (!Output_Pending.empty())
+            {
+                Rows.swap(Output_Pending.front());
+                Output_Pending.pop_front();
+                Found=true;
+            }
+            Stop=Output_Stop;
+        }
+        if (!Found)
+        {
+            if (Stop)
+                return;
+            Sleep(1);
+            continue;
+        }
+
+        //After an error, next rows of the file are dropped, the error is reported by the calling thread
+        for (size_t Pos=0; Pos<Rows.size(); Pos++)
+            if (!*Rows[Pos].Failed && !Rows[Pos].F->Write(Rows[Pos].Text))
+                *Rows[Pos].Failed=true;
+        Rows.clear();
+    }
+}
+
+//---------------------------------------------------------------------------
+void Core::Output_Wait()
+{
+    if (!Outputter)
+        return;
+
+    {
+        CriticalSectionLocker CSL(Output_CS);
+        Output_Stop=true;
+    }
+    while (Outputter->IsRunning())
+        Sleep(1);
+    delete Outputter; Outputter=NULL;
+    Output_Pending.clear();
+    Output_Rows.clear();
+}
+
 //---------------------------------------------------------------------------
 void Core::Batch_Launch()
 {
@@ -1642,7 +2269,13 @@ bool Core::Batch_Launch_Start()
 
     Batch_Begin();
 
+    //Parallel save
+    Savers_Enabled=Jobs>1;
+
     CriticalSectionLocker CSL(CS);
+    for (handlers::iterator Item=Handlers.begin(); Item!=Handlers.end(); Item++)
+        if (Item->second.Riff)
+            Item->second.Riff->Cancel_Clear();
     Menu_File_Open_Files_File_Pos=0;
     Menu_File_Open_Files_File_Total=Handlers.size();
     Handler=Handlers.begin();
@@ -1678,6 +2311,8 @@ void Core::Batch_Launch_End()
     if (Handlers.empty())
         return;
 
+    Batch_Launch_Write_Wait();
+
     Batch_Finish();
 }
 
@@ -1717,11 +2352,24 @@ void Core::Batch_Launch(handlers::iterator &Handler)
     if (Out_cue__XML || !Out_cue__FileName.empty() || Out_XML_Doc)
         Batch_Launch_cue_(Handler);
 
+    //Ordered output
+    if (Outputter)
+        Output_Commit();
+
     //Write
     if (!Simulation_Enabled)
         Batch_Launch_Write(Handler);
     else if (Handler->second.Riff->IsModified_Get() && !Batch_IsBackuping)
+    {
         StdOut(Handler->first+": would be modified (if no simulation)"); //Log
+
+        //Cost of the write, known before any I/O
+        int64u Rewrite_Size, Insert_Size;
+        bool InPlace;
+        if (Handler->second.Riff->Save_Plan(Rewrite_Size, InPlace, Insert_Size))
+            StdOut(Handler->first+": write plan, "+Ztring::ToZtring(Rewrite_Size).To_UTF8()+" bytes to rewrite, in place: "+(InPlace?"yes":"no")
+                  +(Insert_Size?(", "+Ztring::ToZtring(Insert_Size).To_UTF8()+" bytes inserted before the audio data if supported"):string()));
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -1731,7 +2379,7 @@ void Core::Batch_Launch_Technical(handlers::iterator &Handler)
 
     //Technical chunk (with a Conformance Point Document)
     if (!Out_Tech_CSV_FileName.empty())
-        if (!Out_Tech_File.Write(Technical+EOL)) //Saving file part
+        if (!Output_Write(Out_Tech_File, Out_Tech_File_Failed, Technical+EOL)) //Saving file part
         {
             StdErr("--out-technical-file: error during file writing");
             Out_Tech_File.Close();
@@ -1812,7 +2460,7 @@ void Core::Batch_Launch_Core(handlers::iterator &Handler)
 
     //Core chunk (with a Conformance Point Document)
     if (!Out_Core_CSV_FileName.empty() && (!Batch_IsBackuping || Handler->second.Riff->IsModified_Get())) //If backuping, only if file is modified
-        if (!Out_Core_CSV_File.Write(Core+EOL)) //Saving file part
+        if (!Output_Write(Out_Core_CSV_File, Out_Core_CSV_File_Failed, Core+EOL)) //Saving file part
         {
             StdErr("--out-Core-CSV=file: error during file writing");
             Out_Core_CSV_File.Close();
@@ -2135,16 +2783,136 @@ void Core::Batch_Launch_cue_(handlers::iterator &Handler)
 
 //---------------------------------------------------------------------------
 void Core::Batch_Launch_Write(handlers::iterator &Handler)
+{
+    if (Savers_Enabled)
+    {
+        Batch_Launch_Write_Queue(Handler);
+        return;
+    }
+
+    if (Batch_Launch_Write_Save(Handler))
+        Files_Modified_NotWritten_Count--;
+}
+
+//---------------------------------------------------------------------------
+bool Core::Batch_Launch_Write_Save(handlers::iterator &Handler)
 {
     //Writing
     StdClear(Handler);
     bool WasModified=Handler->second.Riff->IsModified_Get();
-    if (Handler->second.Riff->Save())
+    bool Written=Handler->second.Riff->Save() && WasModified;
+    StdAll(Handler);
+
+    return Written;
+}
+
+//---------------------------------------------------------------------------
+bool Core::Batch_Launch_Write_Staged(saver* Saver)
+{
+    handlers::iterator Handler=Saver->Handler;
+
+    //Writing
+    StdClear(Handler);
+    bool WasModified=Handler->second.Riff->IsModified_Get();
+    bool Written=Handler->second.Riff->Save_Write();
+
+    //Verifying, the write slot is available for the next file
+    if (Written)
     {
-        if (WasModified)
-            Files_Modified_NotWritten_Count--;
+        {
+            CriticalSectionLocker CSL(CS);
+            Saver->Stage=saver::Stage_Verify_Queued;
+        }
+        for (;;)
+        {
+            {
+                CriticalSectionLocker CSL(CS);
+                size_t Verify_Count=0;
+                for (size_t Pos=0; Pos<Savers.size(); Pos++)
+                    if (Savers[Pos]->Stage==saver::Stage_Verify)
+                        Verify_Count++;
+                if (Verify_Count<Jobs)
+                {
+                    Saver->Stage=saver::Stage_Verify;
+                    break;
+                }
+            }
+            Sleep(1);
+        }
+        Written=Handler->second.Riff->Save_Verify();
     }
     StdAll(Handler);
+
+    //Verify slot is available for the next file, even if this saver is not yet reaped
+    {
+        CriticalSectionLocker CSL(CS);
+        Saver->Stage=saver::Stage_Done;
+    }
+
+    return Written && WasModified;
+}
+
+//---------------------------------------------------------------------------
+void Core::Batch_Launch_Write_Queue(handlers::iterator &Handler)
+{
+    string Device=Device_Get(Handler->first);
+
+    //Waiting for a free write slot, globally and on the device of the file, and for room in the verify queue
+    for (;;)
+    {
+        {
+            CriticalSectionLocker CSL(CS);
+            size_t Write_Count=0;
+            size_t Device_Count=0;
+            for (size_t Pos=0; Pos<Savers.size();)
+            {
+                if (!Savers[Pos]->IsRunning())
+                {
+                    if (Savers[Pos]->Written)
+                        Files_Modified_NotWritten_Count--;
+                    delete Savers[Pos];
+                    Savers.erase(Savers.begin()+Pos);
+                    continue;
+                }
+                if (Savers[Pos]->Stage==saver::Stage_Write)
+                {
+                    Write_Count++;
+                    if (!Device.empty() && Savers[Pos]->Device==Device)
+                        Device_Count++;
+                }
+                Pos++;
+            }
+            if (Savers.size()<Jobs*2 && Write_Count<Jobs && (!Jobs_PerDevice || Device_Count<Jobs_PerDevice))
+            {
+                Savers.push_back(new saver(this, Handler, Device));
+                Savers.back()->Run();
+                return;
+            }
+        }
+        Sleep(1);
+    }
+}
+
+//---------------------------------------------------------------------------
+void Core::Batch_Launch_Write_Wait(bool Cancel)
+{
+    if (Cancel)
+        for (size_t Pos=0; Pos<Savers.size(); Pos++)
+            Savers[Pos]->Handler->second.Riff->Cancel();
+
+    for (size_t Pos=0; Pos<Savers.size(); Pos++)
+        while (Savers[Pos]->IsRunning())
+            Sleep(10);
+
+    CriticalSectionLocker CSL(CS);
+    for (size_t Pos=0; Pos<Savers.size(); Pos++)
+    {
+        if (Savers[Pos]->Written)
+            Files_Modified_NotWritten_Count--;
+        delete Savers[Pos];
+    }
+    Savers.clear();
+    Savers_Enabled=false;
 }
 
 //---------------------------------------------------------------------------
@@ -2157,7 +2925,23 @@ void Core::Options_Update(handlers::iterator &Handler)
         Handler->second.Riff->Overwrite_Reject=Overwrite_Reject;
         Handler->second.Riff->NoPadding_Accept=NoPadding_Accept;
         Handler->second.Riff->NewChunksAtTheEnd=NewChunksAtTheEnd;
+        Handler->second.Riff->InsertRange=InsertRange;
+        Handler->second.Riff->Reserve_Kind=Reserve_Kind;
+        Handler->second.Riff->Reserve_Value=Reserve_Value;
+        Handler->second.Riff->ReserveOnly=ReserveOnly;
+        Handler->second.Riff->VerifyPlan=VerifyPlan;
         Handler->second.Riff->GenerateMD5=GenerateMD5;
+        Handler->second.Riff->GenerateHashes=GenerateHashes;
+        Handler->second.Riff->Hash_Cache=Hash_Cache;
+        Handler->second.Riff->FixityIndex=FixityIndex;
+        Handler->second.Riff->FixityVerify=FixityVerify;
+        Handler->second.Riff->Fixity_Segment_Size=Fixity_Segment_Size;
+        Handler->second.Riff->ComputeLoudness=ComputeLoudness;
+        Handler->second.Riff->ComputeLevels=ComputeLevels;
+        Handler->second.Riff->Peak_Kernel=Peak_Kernel;
+        Handler->second.Riff->DetectSilences=DetectSilences;
+        Handler->second.Riff->Silence_Threshold=Silence_Threshold;
+        Handler->second.Riff->Silence_Duration=Silence_Duration;
         Handler->second.Riff->VerifyMD5=VerifyMD5;
         Handler->second.Riff->VerifyMD5_Force=VerifyMD5_Force;
         Handler->second.Riff->EmbedMD5=EmbedMD5;
@@ -2197,6 +2981,8 @@ void Core::StdClear(handlers::iterator &Handler)
 //---------------------------------------------------------------------------
 void Core::StdAll(handlers::iterator &Handler)
 {
+    CriticalSectionLocker CSL(Std_CS);
+
     time_t Time=time(NULL);
     Ztring TimeS; TimeS.Date_From_Seconds_1970_Local((int32u)Time);
 
@@ -2254,6 +3040,8 @@ void Core::StdOut(string Text)
     if (Text.empty())
         return;
 
+    CriticalSectionLocker CSL(Std_CS);
+
     time_t Time=time(NULL);
     Ztring TimeS; TimeS.Date_From_Seconds_1970_Local((int32u)Time);
 
@@ -2277,6 +3065,8 @@ void Core::StdErr(string Text)
     if (Text.empty())
         return;
 
+    CriticalSectionLocker CSL(Std_CS);
+
     time_t Time=time(NULL);
     Ztring TimeS; TimeS.Date_From_Seconds_1970_Local((int32u)Time);
 
@@ -2288,8 +3078,5 @@ void Core::StdErr(string Text)
 //---------------------------------------------------------------------------
 bool Core::Text_stderr_Updated_Get()
 {
-    bool Temp=Text_stderr_Updated;
-    Text_stderr_Updated=false;
-    
-    return Temp;
+    return Text_stderr_Updated.exchange(false);
 }
@@ -13,6 +13,8 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <deque>
+#include <atomic>
 //#include <tchar.h>
 #include "Riff/Riff_Handler.h"
 #include "ZenLib/ZtringList.h"
@@ -117,7 +119,26 @@ public:
     bool                                FileNotValid_Skip;
     bool                                WrongExtension_Skip;
     bool                                NewChunksAtTheEnd;
+    bool                                InsertRange;
+    int8u                               Reserve_Kind; //riff_reserve, size of the padding when the audio data moves
+    int64u                              Reserve_Value;
+    bool                                ReserveOnly; //Files are modified only if the padding before the audio data is smaller than the reserve
+    bool                                VerifyPlan; //After an in-place write, only the rewritten bytes are read back instead of parsing the file again
     bool                                GenerateMD5;
+    int8u                               GenerateHashes; //Riff_Hash flags
+    bool                                Hash_Cache_Enabled; //Digests of unmodified files are read from the digest cache
+    string                              Hash_Cache_FileName; //Empty for the default one in ApplicationFolder
+    bool                                Hash_Cache_Verify; //Some cached files are hashed again
+    float32                             Hash_Cache_Rehash; //Percentage of the cached files hashed again if Hash_Cache_Verify
+    bool                                FixityIndex; //A digest per segment of the audio data is written in a sidecar file
+    bool                                FixityVerify;
+    int64u                              Fixity_Segment_Size;
+    bool                                ComputeLoudness; //EBU R 128 loudness, written in the bext v2 fields
+    bool                                ComputeLevels; //Peak, RMS, DC offset, clipping and silence, in the information
+    int8u                               Peak_Kernel; //Riff_Peak::kernel, for comparing the kernels
+    bool                                DetectSilences; //Leading, trailing silences and gaps, written as cue points
+    float64                             Silence_Threshold; //dBFS
+    float64                             Silence_Duration; //Seconds
     bool                                VerifyMD5;
     bool                                VerifyMD5_Force;
     bool                                EmbedMD5;
@@ -158,6 +179,8 @@ public:
     bool                                Out_cue__XML;
     bool                                Batch_Enabled;
     bool                                Batch_IsBackuping; //Does not read modifications, only data from the file
+    size_t                              Jobs; //Count of files opened or saved in parallel
+    size_t                              Jobs_PerDevice; //Max count of files saved in parallel on a same device, 0 for no limit
     bool                                Out_Log_cout;
     Riff_Handler::rules                 Rules;
     string                              OpenSaveFolder;
@@ -181,6 +204,13 @@ public:
     size_t                              Files_Modified_NotWritten_Count;
 
 protected:
+    enum open_state
+    {
+        Open_State_None,
+        Open_State_Running, //A worker is opening the file
+        Open_State_Done,    //Open, waiting for Menu_File_Open_Files_Finish_Middle()
+    };
+
     struct handler
     {
         Riff_Handler       *Riff;
@@ -199,6 +229,8 @@ protected:
         bool                In_cue__XML;
         string              In_cue__FileName;
         bool                In_CSET_Remove;
+        open_state          Open_State;
+        bool                Open_Result;
 
         handler()
         {
@@ -213,6 +245,8 @@ protected:
             In_cue__Remove=false;
             In_cue__XML=false;
             In_CSET_Remove=false;
+            Open_State=Open_State_None;
+            Open_Result=false;
         }
 
         ~handler()
@@ -229,13 +263,16 @@ protected:
     string                              Out_XML_Buf;
     tinyxml2::XMLDocument*              Out_XML_Doc;
     File                                Out_Tech_File;
+    std::atomic<bool>                   Out_Tech_File_Failed; //Set by the output thread
     ZtringList                          Out_Tech_CSV_File_Header;
     tinyxml2::XMLDocument*              Out_Tech_XML_Doc;
     string                              Out_Tech_XML_Buf;
     File                                Out_Core_CSV_File;
+    std::atomic<bool>                   Out_Core_CSV_File_Failed; //Set by the output thread
     ZtringList                          Out_Core_CSV_File_Header;
     tinyxml2::XMLDocument*              Out_Core_XML_Doc;
     string                              Out_Core_XML_Buf;
+    Riff_Hash_Cache*                    Hash_Cache;
     void Batch_Begin                    ();
     void Batch_Finish                   ();
     void Batch_Launch                   (handlers::iterator &Handler);
@@ -246,13 +283,31 @@ protected:
     void Batch_Launch_iXML              (handlers::iterator &Handler);
     void Batch_Launch_cue_              (handlers::iterator &Handler);
     void Batch_Launch_Write             (handlers::iterator &Handler);
+    bool Batch_Launch_Write_Save        (handlers::iterator &Handler); //Return true if a modified file is written
+    class saver;
+    bool Batch_Launch_Write_Staged      (saver* Saver); //Parallel save only, write then verify, return true if a modified file is written
+    void Batch_Launch_Write_Queue       (handlers::iterator &Handler); //Parallel save only
+    void Batch_Launch_Write_Wait        (bool Cancel=false);
+    void Output_Start                   ();
+    bool Output_Write                   (File &F, std::atomic<bool> &Failed, const Ztring &Text); //Written by the output thread if started, false if a previous row failed
+    void Output_Commit                  (); //Rows of the current file are complete
+    void Output_Worker                  ();
+    void Output_Wait                    (); //Writes remaining rows then stops the output thread
     void Options_Update                 (handlers::iterator &Handler);
+    bool Menu_File_Open_Files_Finish_Open(handlers::iterator &Handler);
+    bool Menu_File_Open_Files_Finish_Wait(handlers::iterator &Handler); //Parallel open only
+    handlers::iterator Menu_File_Open_Files_Claim(bool InOrder=false); //Parallel open only, CS must be locked
+    void Menu_File_Open_Files_Worker    ();
+    void Menu_File_Open_Files_Workers_Stop();
+    size_t Menu_File_Open_Files_Walk    (const Ztring &Dir_Name); //Return the count of files found
+    void Menu_File_Open_Files_Walk_Worker();
     void Entry();
 
     //Status
     void                                StdClear(handlers::iterator &Handler);
     void                                StdAll(handlers::iterator &Handler);
-    bool                                Text_stderr_Updated;
+    std::atomic<bool>                   Text_stderr_Updated; //Set under Std_CS, read by the opening loop without it
+    CriticalSection                     Std_CS;
 
     //Temp
     size_t                              Menu_File_Open_Files_File_Pos;
@@ -263,6 +318,81 @@ protected:
     ZtringList                          BackupFiles;
     ZtringList                          Menu_Close_File_FileNames;
     bool                                SaveMode;
+
+    //Parallel open
+    class worker : public Thread
+    {
+    public:
+        worker(Core* C_) : C(C_) {}
+        void Entry() {C->Menu_File_Open_Files_Worker();}
+    private:
+        Core* C;
+    };
+    vector<worker*>                     Workers;
+    handlers::iterator                  Menu_File_Open_Files_Next; //Next file to be taken by a worker
+    size_t                              Menu_File_Open_Files_Ahead; //Count of files taken but not yet used by the calling thread
+    vector<handlers::iterator>          Menu_File_Open_Files_BySize; //Files sorted by size, largest first
+    size_t                              Menu_File_Open_Files_BySize_Pos; //First file not yet taken in Menu_File_Open_Files_BySize
+    bool                                Menu_File_Open_Files_Walking; //Workers take the files found by the directory walk, until Menu_File_Open_Files_Finish_Start()
+    vector<handlers::iterator>          Menu_File_Open_Files_Found; //Files found by the directory walk, in the order they are found
+    size_t                              Menu_File_Open_Files_Found_Pos; //First file not yet taken in Menu_File_Open_Files_Found
+    Riff_Base::progress                 Progress_Parallel; //Bytes done across all files opened in parallel, Total is 0 if not used
+
+    //Parallel directory enumeration
+    class walker : public Thread
+    {
+    public:
+        walker(Core* C_) : C(C_) {}
+        void Entry() {C->Menu_File_Open_Files_Walk_Worker();}
+    private:
+        Core* C;
+    };
+    vector<Ztring>                      Walk_Pending; //Directories not yet listed
+    size_t                              Walk_Busy; //Count of directories currently listed
+    size_t                              Walk_Count; //Count of files found, including the ones filtered out
+
+    //Parallel save
+    class saver : public Thread
+    {
+    public:
+        enum stage
+        {
+            Stage_Write,
+            Stage_Verify_Queued,
+            Stage_Verify,
+            Stage_Done
+        };
+        saver(Core* C_, handlers::iterator Handler_, const string &Device_) : C(C_), Handler(Handler_), Device(Device_), Stage(Stage_Write), Written(false) {}
+        void Entry() {Written=C->Batch_Launch_Write_Staged(this);}
+        Core*               C;
+        handlers::iterator  Handler;
+        string              Device;
+        stage               Stage;
+        bool                Written;
+    };
+    vector<saver*>                      Savers;
+    bool                                Savers_Enabled;
+
+    //Ordered output
+    struct output_item
+    {
+        File*               F;
+        std::atomic<bool>*  Failed;
+        Ztring              Text;
+    };
+    class outputter : public Thread
+    {
+    public:
+        outputter(Core* C_) : C(C_) {}
+        void Entry() {C->Output_Worker();}
+    private:
+        Core* C;
+    };
+    outputter*                          Outputter;
+    CriticalSection                     Output_CS;
+    deque<vector<output_item> >         Output_Pending; //Rows per file, committed in file order by Batch_Launch()
+    vector<output_item>                 Output_Rows; //Rows of the current file, not yet committed
+    bool                                Output_Stop;
 };
 
 #endif
@@ -459,6 +459,18 @@ void GUI_Main::Bext_Toggle_Set(bool Toggle)
     Bext_Toggle=Toggle;
 }
 
+//---------------------------------------------------------------------------
+void GUI_Main::Jobs_Set(size_t Jobs)
+{
+    C->Jobs=Jobs;
+}
+
+//---------------------------------------------------------------------------
+void GUI_Main::Jobs_PerDevice_Set(size_t Jobs_PerDevice)
+{
+    C->Jobs_PerDevice=Jobs_PerDevice;
+}
+
 //---------------------------------------------------------------------------
 bool GUI_Main::Trace_UseDec_Get()
 {
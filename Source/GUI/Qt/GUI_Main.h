@@ -58,6 +58,8 @@ public:
     void OpenSaveDirectory_Set(const string &Value);
     void BackupDirectory_Set(const string &Value);
     void LogFile_Set(const string &Value);
+    void Jobs_Set(size_t Jobs);
+    void Jobs_PerDevice_Set(size_t Jobs_PerDevice);
 
     //Preferences
     GUI_Preferences* Preferences;
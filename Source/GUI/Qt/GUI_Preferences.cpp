@@ -45,7 +45,7 @@ options Groups[Group_Max]=
 {
     {
         "Technical Metadata",
-        21,
+        24,
         {
             {"Tech_FileSize", "FileSize", Type_CheckBox, true},
             {"Tech_Format", "Format", Type_CheckBox, true},
@@ -68,6 +68,9 @@ options Groups[Group_Max]=
             {"Tech_Errors", "Errors", Type_CheckBox, true},
             {"Tech_Warnings", "Warnings", Type_CheckBox, true},
             {"Tech_Information", "Information", Type_CheckBox, true},
+            {"Tech_XXH3Generated", "XXH3Generated", Type_CheckBox, true},
+            {"Tech_SHA256Generated", "SHA256Generated", Type_CheckBox, true},
+            {"Tech_BLAKE3Generated", "BLAKE3Generated", Type_CheckBox, true},
         },
         true,
         false,
@@ -505,6 +508,16 @@ void GUI_Preferences::OnLoad()
     Main->Bext_MaxVersion_Set(Extra_Bext_MaxVersion->value());
     Extra_Bext_Toggle->setChecked(Config("Extra_Bext_Toggle").To_int64u()?true:false);
     Main->Bext_Toggle_Set(Extra_Bext_Toggle->isChecked());
+    if (Config("Extra_Jobs").empty() || !Config("Extra_Jobs").To_int64u() || Config("Extra_Jobs").To_int64u()>64)
+        Extra_Jobs->setValue(1);
+    else
+        Extra_Jobs->setValue((int8u)Config("Extra_Jobs").To_int64u());
+    Main->Jobs_Set((size_t)Extra_Jobs->value());
+    if (Config("Extra_Jobs_PerDevice").To_int64u()>64)
+        Extra_Jobs_PerDevice->setValue(0);
+    else
+        Extra_Jobs_PerDevice->setValue((int8u)Config("Extra_Jobs_PerDevice").To_int64u());
+    Main->Jobs_PerDevice_Set((size_t)Extra_Jobs_PerDevice->value());
 
     close();
 }
@@ -602,6 +615,26 @@ void GUI_Preferences::OnSave()
         Prefs.Write(Content);
         Main->Bext_Toggle_Set(Data.To_int8u()?true:false);
     }
+    {
+        Ztring Content;
+        Content+=__T("Extra_Jobs");
+        Content+=__T(" = ");
+        Ztring Data=Ztring().From_Number((int64u)Extra_Jobs->value());
+        Content+=Data;
+        Content+=EOL;
+        Prefs.Write(Content);
+        Main->Jobs_Set(Data.To_int8u());
+    }
+    {
+        Ztring Content;
+        Content+=__T("Extra_Jobs_PerDevice");
+        Content+=__T(" = ");
+        Ztring Data=Ztring().From_Number((int64u)Extra_Jobs_PerDevice->value());
+        Content+=Data;
+        Content+=EOL;
+        Prefs.Write(Content);
+        Main->Jobs_PerDevice_Set(Data.To_int8u());
+    }
         
     //Menu
     Main->Menu_Update();
@@ -920,12 +953,35 @@ void GUI_Preferences::Create()
     QGroupBox* Extra_Bext=new QGroupBox("bext");
     Extra_Bext->setLayout(Extra_Bext_Layout);
 
+    //Extra - Jobs
+    Extra_Jobs=new QDoubleSpinBox();
+    Extra_Jobs->setMinimum(1);
+    Extra_Jobs->setMaximum(64);
+    Extra_Jobs->setDecimals(0);
+    QLabel* Extra_Jobs_Label=new QLabel("Count of files opened or saved in parallel:");
+
+    Extra_Jobs_PerDevice=new QDoubleSpinBox();
+    Extra_Jobs_PerDevice->setMinimum(0);
+    Extra_Jobs_PerDevice->setMaximum(64);
+    Extra_Jobs_PerDevice->setDecimals(0);
+    QLabel* Extra_Jobs_PerDevice_Label=new QLabel("Max count of files saved in parallel on a same device (0 for no limit):");
+
+    QGridLayout* Extra_Jobs_Layout=new QGridLayout();
+    Extra_Jobs_Layout->addWidget(Extra_Jobs_Label, 0, 0);
+    Extra_Jobs_Layout->addWidget(Extra_Jobs, 0, 1);
+    Extra_Jobs_Layout->addWidget(Extra_Jobs_PerDevice_Label, 1, 0);
+    Extra_Jobs_Layout->addWidget(Extra_Jobs_PerDevice, 1, 1);
+
+    QGroupBox* Extra_Performance=new QGroupBox("Performance");
+    Extra_Performance->setLayout(Extra_Jobs_Layout);
+
     //Extra
     QVBoxLayout* Extra=new QVBoxLayout();
     Extra->addWidget(Extra_OpenSaveDirectory);
     Extra->addWidget(Extra_BackupDirectory);
     Extra->addWidget(Extra_LogFile);
     Extra->addWidget(Extra_Bext);
+    Extra->addWidget(Extra_Performance);
     Extra->addStretch();
     QWidget* Extra_Widget=new QWidget();
     Extra_Widget->setLayout(Extra);
@@ -236,6 +236,8 @@ private:
     QDoubleSpinBox* Extra_Bext_DefaultVersion;
     QDoubleSpinBox* Extra_Bext_MaxVersion;
     QCheckBox*      Extra_Bext_Toggle;
+    QDoubleSpinBox* Extra_Jobs;
+    QDoubleSpinBox* Extra_Jobs_PerDevice;
 };
 
 #endif
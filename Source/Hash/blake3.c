@@ -0,0 +1,337 @@
+/*!\file
+\brief     BLAKE3 checksum routines (portable, hash mode only), in the public
+   domain */
+
+/*
+ * To compute the digest of a chunk of bytes, declare a BLAKE3Context
+ * structure, pass it to BLAKE3Init, call BLAKE3Update as needed on
+ * buffers full of bytes, and then call BLAKE3Final, which will fill a
+ * supplied 32-byte array with the digest.
+ *
+ * Input is split in 1 KiB chunks, the chaining values of the chunks are
+ * merged two by two in a binary tree, so the subtrees can be hashed in
+ * parallel (BLAKE3Subtree) then added in order (BLAKE3AddSubtree).
+ */
+
+#include "Hash/blake3.h"
+
+#include <string.h>
+
+#define BLOCK_LEN 64
+
+#define CHUNK_START 1
+#define CHUNK_END 2
+#define PARENT 4
+#define ROOT 8
+
+static const uint32_t IV[8] = {
+	0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+	0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+static const unsigned char Schedule[7][16] = {
+	{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+	{2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+	{3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+	{10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+	{12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+	{9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+	{11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13}
+};
+
+#define ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define G(a, b, c, d, x, y) \
+	a = a + b + x; d = ROR(d ^ a, 16); c = c + d; b = ROR(b ^ c, 12); \
+	a = a + b + y; d = ROR(d ^ a, 8); c = c + d; b = ROR(b ^ c, 7)
+
+static void compress(uint32_t out[16], uint32_t const cv[8], unsigned char const block[BLOCK_LEN],
+		     uint64_t counter, unsigned block_len, unsigned flags)
+{
+	uint32_t m[16], v[16];
+	int i;
+
+	for (i = 0; i < 16; i++)
+		m[i] = (uint32_t) block[i * 4] | (uint32_t) block[i * 4 + 1] << 8 |
+			(uint32_t) block[i * 4 + 2] << 16 | (uint32_t) block[i * 4 + 3] << 24;
+	for (i = 0; i < 8; i++)
+		v[i] = cv[i];
+	v[8] = IV[0];
+	v[9] = IV[1];
+	v[10] = IV[2];
+	v[11] = IV[3];
+	v[12] = (uint32_t) counter;
+	v[13] = (uint32_t) (counter >> 32);
+	v[14] = block_len;
+	v[15] = flags;
+
+	for (i = 0; i < 7; i++) {
+		unsigned char const *s = Schedule[i];
+		G(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);
+		G(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);
+		G(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);
+		G(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);
+		G(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);
+		G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+		G(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);
+		G(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);
+	}
+
+	for (i = 0; i < 8; i++) {
+		out[i] = v[i] ^ v[i + 8];
+		out[i + 8] = v[i + 8] ^ cv[i];
+	}
+}
+
+static void parent_block(unsigned char block[BLOCK_LEN], uint32_t const left[8], uint32_t const right[8])
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		block[i * 4] = (unsigned char) left[i];
+		block[i * 4 + 1] = (unsigned char) (left[i] >> 8);
+		block[i * 4 + 2] = (unsigned char) (left[i] >> 16);
+		block[i * 4 + 3] = (unsigned char) (left[i] >> 24);
+		block[32 + i * 4] = (unsigned char) right[i];
+		block[32 + i * 4 + 1] = (unsigned char) (right[i] >> 8);
+		block[32 + i * 4 + 2] = (unsigned char) (right[i] >> 16);
+		block[32 + i * 4 + 3] = (unsigned char) (right[i] >> 24);
+	}
+}
+
+static void parent_cv(uint32_t cv[8], uint32_t const left[8], uint32_t const right[8])
+{
+	unsigned char block[BLOCK_LEN];
+	uint32_t out[16];
+
+	parent_block(block, left, right);
+	compress(out, IV, block, 0, BLOCK_LEN, PARENT);
+	memcpy(cv, out, 8 * sizeof(uint32_t));
+}
+
+/*
+ * Chunk state
+ */
+static void chunk_reset(struct BLAKE3Context *ctx, uint64_t chunk_counter)
+{
+	memcpy(ctx->cv, IV, sizeof(IV));
+	ctx->chunk_counter = chunk_counter;
+	ctx->block_len = 0;
+	ctx->blocks_compressed = 0;
+}
+
+static unsigned chunk_len(struct BLAKE3Context const *ctx)
+{
+	return ctx->blocks_compressed * BLOCK_LEN + ctx->block_len;
+}
+
+static unsigned chunk_start(struct BLAKE3Context const *ctx)
+{
+	return ctx->blocks_compressed ? 0 : CHUNK_START;
+}
+
+static void chunk_update(struct BLAKE3Context *ctx, unsigned char const *buf, size_t len)
+{
+	while (len) {
+		size_t t;
+
+		/* Compress the full block only when more input comes, the last one has other flags */
+		if (ctx->block_len == BLOCK_LEN) {
+			uint32_t out[16];
+			compress(out, ctx->cv, ctx->block, ctx->chunk_counter, BLOCK_LEN, chunk_start(ctx));
+			memcpy(ctx->cv, out, sizeof(ctx->cv));
+			ctx->blocks_compressed++;
+			ctx->block_len = 0;
+		}
+
+		t = BLOCK_LEN - ctx->block_len;
+		if (t > len)
+			t = len;
+		memcpy(ctx->block + ctx->block_len, buf, t);
+		ctx->block_len += (unsigned) t;
+		buf += t;
+		len -= t;
+	}
+}
+
+static void chunk_output(struct BLAKE3Context const *ctx, uint32_t out[16], unsigned flags)
+{
+	unsigned char block[BLOCK_LEN];
+
+	memset(block, 0, sizeof(block));
+	memcpy(block, ctx->block, ctx->block_len);
+	compress(out, ctx->cv, block, (flags & ROOT) ? 0 : ctx->chunk_counter, ctx->block_len,
+		 chunk_start(ctx) | CHUNK_END | flags);
+}
+
+static void chunk_cv(uint32_t cv[8], unsigned char const *buf, uint64_t chunk_counter)
+{
+	uint32_t out[16];
+	int i;
+
+	memcpy(cv, IV, sizeof(IV));
+	for (i = 0; i < BLAKE3_CHUNK_LEN / BLOCK_LEN; i++) {
+		compress(out, cv, buf + i * BLOCK_LEN, chunk_counter, BLOCK_LEN,
+			 (i == 0 ? CHUNK_START : 0) | (i == BLAKE3_CHUNK_LEN / BLOCK_LEN - 1 ? CHUNK_END : 0));
+		memcpy(cv, out, 8 * sizeof(uint32_t));
+	}
+}
+
+/*
+ * Stack of chaining values, merged lazily: the last subtree may be the
+ * root one, so it is merged only when more input comes
+ */
+static unsigned popcount64(uint64_t x)
+{
+	unsigned count = 0;
+
+	while (x) {
+		count++;
+		x &= x - 1;
+	}
+	return count;
+}
+
+static void merge_cv_stack(struct BLAKE3Context *ctx, uint64_t chunk_counter)
+{
+	unsigned post_merge = popcount64(chunk_counter);
+
+	while (ctx->cv_stack_len > post_merge) {
+		parent_cv(ctx->cv_stack[ctx->cv_stack_len - 2], ctx->cv_stack[ctx->cv_stack_len - 2],
+			  ctx->cv_stack[ctx->cv_stack_len - 1]);
+		ctx->cv_stack_len--;
+	}
+}
+
+static void push_cv(struct BLAKE3Context *ctx, uint32_t const cv[8], uint64_t chunk_counter)
+{
+	merge_cv_stack(ctx, chunk_counter);
+	memcpy(ctx->cv_stack[ctx->cv_stack_len], cv, 8 * sizeof(uint32_t));
+	ctx->cv_stack_len++;
+}
+
+/* A full chunk is kept until more input comes */
+static void flush_chunk(struct BLAKE3Context *ctx)
+{
+	uint32_t out[16];
+
+	chunk_output(ctx, out, 0);
+	push_cv(ctx, out, ctx->chunk_counter);
+	chunk_reset(ctx, ctx->chunk_counter + 1);
+}
+
+/*
+ * Chaining value of a complete subtree
+ */
+void BLAKE3Subtree(uint32_t cv[8], unsigned char const *buf, size_t len, uint64_t chunk_counter)
+{
+	uint32_t left[8], right[8];
+
+	if (len <= BLAKE3_CHUNK_LEN) {
+		chunk_cv(cv, buf, chunk_counter);
+		return;
+	}
+
+	len /= 2;
+	BLAKE3Subtree(left, buf, len, chunk_counter);
+	BLAKE3Subtree(right, buf + len, len, chunk_counter + len / BLAKE3_CHUNK_LEN);
+	parent_cv(cv, left, right);
+}
+
+void BLAKE3AddSubtree(struct BLAKE3Context *ctx, uint32_t const cv[8], uint64_t chunk_count)
+{
+	if (chunk_len(ctx) == BLAKE3_CHUNK_LEN)
+		flush_chunk(ctx);
+	push_cv(ctx, cv, ctx->chunk_counter);
+	chunk_reset(ctx, ctx->chunk_counter + chunk_count);
+}
+
+/*
+ * Start BLAKE3 accumulation.
+ */
+void BLAKE3Init(struct BLAKE3Context *ctx)
+{
+	chunk_reset(ctx, 0);
+	ctx->cv_stack_len = 0;
+}
+
+/*
+ * Update context to reflect the concatenation of another buffer full
+ * of bytes.
+ */
+void BLAKE3Update(struct BLAKE3Context *ctx, unsigned char const *buf, size_t len)
+{
+	/* Complete the current chunk */
+	if (chunk_len(ctx)) {
+		size_t t = BLAKE3_CHUNK_LEN - chunk_len(ctx);
+		if (t > len)
+			t = len;
+		chunk_update(ctx, buf, t);
+		buf += t;
+		len -= t;
+		if (!len)
+			return;
+		flush_chunk(ctx);
+	}
+
+	/* Largest aligned subtrees, the last one is split so its parent may be the root */
+	while (len > BLAKE3_CHUNK_LEN) {
+		uint64_t done = ctx->chunk_counter * BLAKE3_CHUNK_LEN;
+		size_t subtree = BLAKE3_CHUNK_LEN;
+		uint32_t cv[8];
+
+		while (subtree * 2 <= len && !(done & (subtree * 2 - 1)))
+			subtree *= 2;
+		if (subtree == BLAKE3_CHUNK_LEN) {
+			chunk_cv(cv, buf, ctx->chunk_counter);
+			push_cv(ctx, cv, ctx->chunk_counter);
+		} else {
+			uint64_t half = subtree / 2 / BLAKE3_CHUNK_LEN;
+			BLAKE3Subtree(cv, buf, subtree / 2, ctx->chunk_counter);
+			push_cv(ctx, cv, ctx->chunk_counter);
+			BLAKE3Subtree(cv, buf + subtree / 2, subtree / 2, ctx->chunk_counter + half);
+			push_cv(ctx, cv, ctx->chunk_counter + half);
+		}
+		chunk_reset(ctx, ctx->chunk_counter + subtree / BLAKE3_CHUNK_LEN);
+		buf += subtree;
+		len -= subtree;
+	}
+
+	if (len) {
+		chunk_update(ctx, buf, len);
+		merge_cv_stack(ctx, ctx->chunk_counter);
+	}
+}
+
+/*
+ * Final wrapup - merge the stack of chaining values up to the root.
+ */
+void BLAKE3Final(unsigned char digest[32], struct BLAKE3Context *ctx)
+{
+	unsigned char block[BLOCK_LEN];
+	uint32_t out[16], cv[8];
+	unsigned remaining;
+	int i;
+
+	if (!ctx->cv_stack_len)
+		chunk_output(ctx, out, ROOT);
+	else {
+		if (chunk_len(ctx)) {
+			chunk_output(ctx, out, 0);
+			remaining = ctx->cv_stack_len;
+		} else {
+			memcpy(out, ctx->cv_stack[ctx->cv_stack_len - 1], 8 * sizeof(uint32_t));
+			remaining = ctx->cv_stack_len - 1;
+		}
+		while (remaining) {
+			remaining--;
+			memcpy(cv, out, sizeof(cv));
+			parent_block(block, ctx->cv_stack[remaining], cv);
+			compress(out, IV, block, 0, BLOCK_LEN, PARENT | (remaining ? 0 : ROOT));
+		}
+	}
+
+	for (i = 0; i < 32; i++)
+		digest[i] = (unsigned char) (out[i / 4] >> ((i % 4) * 8));
+	memset(ctx, 0, sizeof(*ctx));
+}
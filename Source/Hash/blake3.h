@@ -0,0 +1,33 @@
+#ifndef BLAKE3_H
+#define BLAKE3_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLAKE3_CHUNK_LEN 1024
+
+struct BLAKE3Context {
+	uint32_t cv[8];		/* Current chunk */
+	uint64_t chunk_counter;
+	unsigned char block[64];
+	unsigned block_len;
+	unsigned blocks_compressed;
+	unsigned cv_stack_len;	/* Chaining values of the complete subtrees */
+	uint32_t cv_stack[54][8];
+};
+
+void BLAKE3Init(struct BLAKE3Context *context);
+void BLAKE3Update(struct BLAKE3Context *context, unsigned char const *buf,
+	       size_t len);
+void BLAKE3Final(unsigned char digest[32], struct BLAKE3Context *context);
+
+/* Tree hashing: the chaining value of a complete subtree (len is a power of 2
+   count of chunks, chunk_counter a multiple of this count) may be computed
+   independently, e.g. by another thread, then added to the context at the
+   same position; more input must follow before BLAKE3Final() */
+void BLAKE3Subtree(uint32_t cv[8], unsigned char const *buf, size_t len,
+	       uint64_t chunk_counter);
+void BLAKE3AddSubtree(struct BLAKE3Context *context, uint32_t const cv[8],
+	       uint64_t chunk_count);
+
+#endif /* !BLAKE3_H */
@@ -0,0 +1,158 @@
+/*!\file
+\brief     SHA-256 (FIPS 180-4) checksum routines, in the public domain */
+
+/*
+ * To compute the message digest of a chunk of bytes, declare a
+ * SHA256Context structure, pass it to SHA256Init, call SHA256Update as
+ * needed on buffers full of bytes, and then call SHA256Final, which
+ * will fill a supplied 32-byte array with the digest.
+ */
+
+#include "Hash/sha256.h"
+
+#include <string.h>
+
+static const uint32_t K[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/*
+ * The core of the SHA-256 algorithm, this alters an existing state to
+ * reflect the addition of 64 bytes of new data.
+ */
+static void SHA256Transform(uint32_t state[8], unsigned char const *in)
+{
+	uint32_t w[64];
+	uint32_t a, b, c, d, e, f, g, h, t1, t2;
+	int i;
+
+	for (i = 0; i < 16; i++)
+		w[i] = (uint32_t) in[i * 4] << 24 | (uint32_t) in[i * 4 + 1] << 16 |
+			(uint32_t) in[i * 4 + 2] << 8 | in[i * 4 + 3];
+	for (; i < 64; i++)
+		w[i] = w[i - 16] + (ROR(w[i - 15], 7) ^ ROR(w[i - 15], 18) ^ (w[i - 15] >> 3))
+			+ w[i - 7] + (ROR(w[i - 2], 17) ^ ROR(w[i - 2], 19) ^ (w[i - 2] >> 10));
+
+	a = state[0];
+	b = state[1];
+	c = state[2];
+	d = state[3];
+	e = state[4];
+	f = state[5];
+	g = state[6];
+	h = state[7];
+
+	for (i = 0; i < 64; i++) {
+		t1 = h + (ROR(e, 6) ^ ROR(e, 11) ^ ROR(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+		t2 = (ROR(a, 2) ^ ROR(a, 13) ^ ROR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+/*
+ * Start SHA-256 accumulation.
+ */
+void SHA256Init(struct SHA256Context *ctx)
+{
+	ctx->state[0] = 0x6a09e667;
+	ctx->state[1] = 0xbb67ae85;
+	ctx->state[2] = 0x3c6ef372;
+	ctx->state[3] = 0xa54ff53a;
+	ctx->state[4] = 0x510e527f;
+	ctx->state[5] = 0x9b05688c;
+	ctx->state[6] = 0x1f83d9ab;
+	ctx->state[7] = 0x5be0cd19;
+
+	ctx->bits = 0;
+}
+
+/*
+ * Update context to reflect the concatenation of another buffer full
+ * of bytes.
+ */
+void SHA256Update(struct SHA256Context *ctx, unsigned char const *buf, size_t len)
+{
+	size_t t;
+
+	t = (size_t) (ctx->bits >> 3) & 0x3f;	/* Bytes already in ctx->in */
+	ctx->bits += (uint64_t) len << 3;
+
+	/* Handle any leading odd-sized chunks */
+	if (t) {
+		unsigned char *p = ctx->in + t;
+
+		t = 64 - t;
+		if (len < t) {
+			memcpy(p, buf, len);
+			return;
+		}
+		memcpy(p, buf, t);
+		SHA256Transform(ctx->state, ctx->in);
+		buf += t;
+		len -= t;
+	}
+
+	/* Process data in 64-byte chunks */
+	while (len >= 64) {
+		SHA256Transform(ctx->state, buf);
+		buf += 64;
+		len -= 64;
+	}
+
+	/* Handle any remaining bytes of data. */
+	memcpy(ctx->in, buf, len);
+}
+
+/*
+ * Final wrapup - pad to 64-byte boundary with the bit pattern
+ * 1 0* (64-bit count of bits processed, MSB-first)
+ */
+void SHA256Final(unsigned char digest[32], struct SHA256Context *ctx)
+{
+	size_t count;
+	int i;
+
+	count = (size_t) (ctx->bits >> 3) & 0x3f;
+	ctx->in[count++] = 0x80;
+
+	/* Not enough room for the bit count, pad this block and use another one */
+	if (count > 56) {
+		memset(ctx->in + count, 0, 64 - count);
+		SHA256Transform(ctx->state, ctx->in);
+		count = 0;
+	}
+	memset(ctx->in + count, 0, 56 - count);
+
+	for (i = 0; i < 8; i++)
+		ctx->in[56 + i] = (unsigned char) (ctx->bits >> (56 - i * 8));
+	SHA256Transform(ctx->state, ctx->in);
+
+	for (i = 0; i < 32; i++)
+		digest[i] = (unsigned char) (ctx->state[i / 4] >> (24 - (i % 4) * 8));
+	memset(ctx, 0, sizeof(*ctx));	/* In case it's sensitive */
+}
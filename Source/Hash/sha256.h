@@ -0,0 +1,18 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct SHA256Context {
+	uint32_t state[8];
+	uint64_t bits;
+	unsigned char in[64];
+};
+
+void SHA256Init(struct SHA256Context *context);
+void SHA256Update(struct SHA256Context *context, unsigned char const *buf,
+	       size_t len);
+void SHA256Final(unsigned char digest[32], struct SHA256Context *context);
+
+#endif /* !SHA256_H */
@@ -0,0 +1,304 @@
+/*!\file
+\brief     XXH3 64-bit checksum routines (xxHash 0.8 specification, seed 0,
+   default secret), in the public domain */
+
+/*
+ * To compute the checksum of a chunk of bytes, declare a XXH3Context
+ * structure, pass it to XXH3Init, call XXH3Update as needed on buffers
+ * full of bytes, and then call XXH3Final, which will fill a supplied
+ * 8-byte array with the checksum (big-endian, as displayed by xxhsum).
+ */
+
+#include "Hash/xxh3.h"
+
+#include <string.h>
+
+#define PRIME32_1 0x9E3779B1U
+#define PRIME32_2 0x85EBCA77U
+#define PRIME32_3 0xC2B2AE3DU
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+#define PRIME_MX1 0x165667919E3779F9ULL
+#define PRIME_MX2 0x9FB21C651E98DF25ULL
+
+#define STRIPE_LEN 64
+#define SECRET_SIZE 192
+#define STRIPES_PER_BLOCK ((SECRET_SIZE - STRIPE_LEN) / 8)
+#define MIDSIZE_MAX 240
+
+static const unsigned char Secret[SECRET_SIZE] = {
+	0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+	0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+	0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+	0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+	0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+	0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+	0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+	0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+	0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+	0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+	0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+	0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e
+};
+
+static uint32_t read32(unsigned char const *p)
+{
+	return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static uint64_t read64(unsigned char const *p)
+{
+	return (uint64_t) read32(p) | (uint64_t) read32(p + 4) << 32;
+}
+
+static uint64_t swap64(uint64_t x)
+{
+	return (x << 56) | ((x << 40) & 0x00ff000000000000ULL) | ((x << 24) & 0x0000ff0000000000ULL)
+		| ((x << 8) & 0x000000ff00000000ULL) | ((x >> 8) & 0x00000000ff000000ULL)
+		| ((x >> 24) & 0x0000000000ff0000ULL) | ((x >> 40) & 0x000000000000ff00ULL) | (x >> 56);
+}
+
+static uint64_t rotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+/* Low and high halves of the 128-bit product, xored */
+static uint64_t mul128_fold64(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 p = (unsigned __int128) a * b;
+	return (uint64_t) p ^ (uint64_t) (p >> 64);
+#else
+	uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+	uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+	uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+	uint64_t hi_hi = (a >> 32) * (b >> 32);
+	uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+	uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+	uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+	return lower ^ upper;
+#endif
+}
+
+static uint64_t xxh64_avalanche(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= PRIME64_2;
+	h ^= h >> 29;
+	h *= PRIME64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+static uint64_t avalanche(uint64_t h)
+{
+	h ^= h >> 37;
+	h *= PRIME_MX1;
+	h ^= h >> 32;
+	return h;
+}
+
+static uint64_t rrmxmx(uint64_t h, uint64_t len)
+{
+	h ^= rotl64(h, 49) ^ rotl64(h, 24);
+	h *= PRIME_MX2;
+	h ^= (h >> 35) + len;
+	h *= PRIME_MX2;
+	return h ^ (h >> 28);
+}
+
+static uint64_t mix16(unsigned char const *in, unsigned char const *secret)
+{
+	return mul128_fold64(read64(in) ^ read64(secret), read64(in + 8) ^ read64(secret + 8));
+}
+
+/*
+ * Inputs up to MIDSIZE_MAX bytes, hashed at once.
+ */
+static uint64_t hash_short(unsigned char const *in, size_t len)
+{
+	uint64_t acc;
+	size_t i;
+
+	if (len == 0)
+		return xxh64_avalanche(read64(Secret + 56) ^ read64(Secret + 64));
+	if (len <= 3) {
+		uint32_t combined = (uint32_t) in[0] << 16 | (uint32_t) in[len >> 1] << 24
+			| (uint32_t) in[len - 1] | (uint32_t) len << 8;
+		return xxh64_avalanche(combined ^ (uint64_t) (read32(Secret) ^ read32(Secret + 4)));
+	}
+	if (len <= 8) {
+		uint64_t in64 = read32(in + len - 4) + ((uint64_t) read32(in) << 32);
+		return rrmxmx(in64 ^ (read64(Secret + 8) ^ read64(Secret + 16)), len);
+	}
+	if (len <= 16) {
+		uint64_t lo = read64(in) ^ (read64(Secret + 24) ^ read64(Secret + 32));
+		uint64_t hi = read64(in + len - 8) ^ (read64(Secret + 40) ^ read64(Secret + 48));
+		return avalanche(len + swap64(lo) + hi + mul128_fold64(lo, hi));
+	}
+
+	acc = len * PRIME64_1;
+	if (len <= 128) {
+		if (len > 32) {
+			if (len > 64) {
+				if (len > 96) {
+					acc += mix16(in + 48, Secret + 96);
+					acc += mix16(in + len - 64, Secret + 112);
+				}
+				acc += mix16(in + 32, Secret + 64);
+				acc += mix16(in + len - 48, Secret + 80);
+			}
+			acc += mix16(in + 16, Secret + 32);
+			acc += mix16(in + len - 32, Secret + 48);
+		}
+		acc += mix16(in, Secret);
+		acc += mix16(in + len - 16, Secret + 16);
+		return avalanche(acc);
+	}
+
+	for (i = 0; i < 8; i++)
+		acc += mix16(in + 16 * i, Secret + 16 * i);
+	acc = avalanche(acc);
+	for (i = 8; i < len / 16; i++)
+		acc += mix16(in + 16 * i, Secret + 16 * (i - 8) + 3);
+	acc += mix16(in + len - 16, Secret + 136 - 17);
+	return avalanche(acc);
+}
+
+static void accumulate512(uint64_t acc[8], unsigned char const *in, unsigned char const *secret)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		uint64_t data = read64(in + 8 * i);
+		uint64_t key = data ^ read64(secret + 8 * i);
+		acc[i ^ 1] += data;
+		acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+	}
+}
+
+static void scramble(uint64_t acc[8], unsigned char const *secret)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		uint64_t a = acc[i];
+		a ^= a >> 47;
+		a ^= read64(secret + 8 * i);
+		acc[i] = a * PRIME32_1;
+	}
+}
+
+/*
+ * Stripes are consumed only when more input follows, the last stripe
+ * is handled by XXH3Final.
+ */
+static void consume(uint64_t acc[8], unsigned *stripes, unsigned char const *in, size_t count)
+{
+	while (count--) {
+		accumulate512(acc, in, Secret + *stripes * 8);
+		in += STRIPE_LEN;
+		if (++*stripes == STRIPES_PER_BLOCK) {
+			scramble(acc, Secret + SECRET_SIZE - STRIPE_LEN);
+			*stripes = 0;
+		}
+	}
+}
+
+/*
+ * Start XXH3 accumulation.
+ */
+void XXH3Init(struct XXH3Context *ctx)
+{
+	ctx->acc[0] = PRIME32_3;
+	ctx->acc[1] = PRIME64_1;
+	ctx->acc[2] = PRIME64_2;
+	ctx->acc[3] = PRIME64_3;
+	ctx->acc[4] = PRIME64_4;
+	ctx->acc[5] = PRIME32_2;
+	ctx->acc[6] = PRIME64_5;
+	ctx->acc[7] = PRIME32_1;
+	ctx->len = 0;
+	ctx->stripes = 0;
+	ctx->buffered = 0;
+}
+
+/*
+ * Update context to reflect the concatenation of another buffer full
+ * of bytes.
+ */
+void XXH3Update(struct XXH3Context *ctx, unsigned char const *buf, size_t len)
+{
+	ctx->len += len;
+
+	/* Enough room, keeping the bytes until more input comes */
+	if (ctx->buffered + len <= sizeof(ctx->in)) {
+		memcpy(ctx->in + ctx->buffered, buf, len);
+		ctx->buffered += (unsigned) len;
+		return;
+	}
+
+	/* Complete the buffer and consume it */
+	if (ctx->buffered) {
+		size_t t = sizeof(ctx->in) - ctx->buffered;
+		memcpy(ctx->in + ctx->buffered, buf, t);
+		buf += t;
+		len -= t;
+		consume(ctx->acc, &ctx->stripes, ctx->in, sizeof(ctx->in) / STRIPE_LEN);
+		ctx->buffered = 0;
+	}
+
+	/* Consume directly from the input, keeping the last stripe for XXH3Final */
+	if (len > sizeof(ctx->in)) {
+		size_t count = (len - 1) / STRIPE_LEN;
+		consume(ctx->acc, &ctx->stripes, buf, count);
+		buf += count * STRIPE_LEN;
+		len -= count * STRIPE_LEN;
+		memcpy(ctx->in + sizeof(ctx->in) - STRIPE_LEN, buf - STRIPE_LEN, STRIPE_LEN);
+	}
+
+	memcpy(ctx->in, buf, len);
+	ctx->buffered = (unsigned) len;
+}
+
+/*
+ * Final wrapup - consume the remaining stripes, the last one overlapping
+ * the previous bytes if needed, and merge the accumulators.
+ */
+void XXH3Final(unsigned char digest[8], struct XXH3Context *ctx)
+{
+	uint64_t h;
+	int i;
+
+	if (ctx->len <= MIDSIZE_MAX)
+		h = hash_short(ctx->in, (size_t) ctx->len);
+	else {
+		unsigned char last[STRIPE_LEN];
+		unsigned char const *p;
+
+		if (ctx->buffered >= STRIPE_LEN) {
+			consume(ctx->acc, &ctx->stripes, ctx->in, (ctx->buffered - 1) / STRIPE_LEN);
+			p = ctx->in + ctx->buffered - STRIPE_LEN;
+		} else {
+			unsigned t = STRIPE_LEN - ctx->buffered;
+			memcpy(last, ctx->in + sizeof(ctx->in) - t, t);
+			memcpy(last + t, ctx->in, ctx->buffered);
+			p = last;
+		}
+		accumulate512(ctx->acc, p, Secret + SECRET_SIZE - STRIPE_LEN - 7);
+
+		h = ctx->len * PRIME64_1;
+		for (i = 0; i < 4; i++)
+			h += mul128_fold64(ctx->acc[2 * i] ^ read64(Secret + 11 + 16 * i),
+				ctx->acc[2 * i + 1] ^ read64(Secret + 11 + 16 * i + 8));
+		h = avalanche(h);
+	}
+
+	for (i = 0; i < 8; i++)
+		digest[i] = (unsigned char) (h >> (56 - i * 8));
+	memset(ctx, 0, sizeof(*ctx));
+}
@@ -0,0 +1,20 @@
+#ifndef XXH3_H
+#define XXH3_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct XXH3Context {
+	uint64_t acc[8];
+	uint64_t len;
+	unsigned stripes;
+	unsigned buffered;
+	unsigned char in[256];
+};
+
+void XXH3Init(struct XXH3Context *context);
+void XXH3Update(struct XXH3Context *context, unsigned char const *buf,
+	       size_t len);
+void XXH3Final(unsigned char digest[8], struct XXH3Context *context);
+
+#endif /* !XXH3_H */
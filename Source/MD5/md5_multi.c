@@ -0,0 +1,367 @@
+/*!\file
+\brief     Multi-buffer MD5, several independent streams hashed at once */
+
+/*
+ * MD5 can not be parallelized within one stream, but the 32-bit
+ * operations of independent streams can be done in the lanes of SIMD
+ * registers. The kernels below run the rounds of md5.c on 4 (SSE2),
+ * 8 (AVX2) or 16 (AVX-512) streams, the kernel is chosen at run time
+ * from the CPU features. Partial blocks and the bit count are handled
+ * by MD5Update(), so results are the same as with md5.c.
+ */
+
+#include "MD5/md5_multi.h"
+
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MD5_MULTI_X86
+#define MD5_MULTI_TARGET(x)	__attribute__((target(x)))
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#define MD5_MULTI_X86
+#define MD5_MULTI_TARGET(x)	/* Nothing */
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+#ifdef MD5_MULTI_X86
+
+/* The four core functions, same as in md5.c */
+#define F1(x, y, z) V_XOR(z, V_AND(x, V_XOR(y, z)))
+#define F2(x, y, z) F1(z, x, y)
+#define F3(x, y, z) V_XOR(V_XOR(x, y), z)
+#define F4(x, y, z) V_XOR(y, V_OR(x, V_NOT(z)))
+
+/* This is the central step in the MD5 algorithm, on all lanes */
+#define MD5STEP(f, w, x, y, z, i, k, s) \
+	w = V_ADD(w, V_ADD(f(x, y, z), V_ADD(X[i], V_SET1(k)))); \
+	w = V_ROL(w, s); \
+	w = V_ADD(w, x)
+
+#define MD5ROUNDS \
+	MD5STEP(F1, a, b, c, d, 0, 0xd76aa478, 7); \
+	MD5STEP(F1, d, a, b, c, 1, 0xe8c7b756, 12); \
+	MD5STEP(F1, c, d, a, b, 2, 0x242070db, 17); \
+	MD5STEP(F1, b, c, d, a, 3, 0xc1bdceee, 22); \
+	MD5STEP(F1, a, b, c, d, 4, 0xf57c0faf, 7); \
+	MD5STEP(F1, d, a, b, c, 5, 0x4787c62a, 12); \
+	MD5STEP(F1, c, d, a, b, 6, 0xa8304613, 17); \
+	MD5STEP(F1, b, c, d, a, 7, 0xfd469501, 22); \
+	MD5STEP(F1, a, b, c, d, 8, 0x698098d8, 7); \
+	MD5STEP(F1, d, a, b, c, 9, 0x8b44f7af, 12); \
+	MD5STEP(F1, c, d, a, b, 10, 0xffff5bb1, 17); \
+	MD5STEP(F1, b, c, d, a, 11, 0x895cd7be, 22); \
+	MD5STEP(F1, a, b, c, d, 12, 0x6b901122, 7); \
+	MD5STEP(F1, d, a, b, c, 13, 0xfd987193, 12); \
+	MD5STEP(F1, c, d, a, b, 14, 0xa679438e, 17); \
+	MD5STEP(F1, b, c, d, a, 15, 0x49b40821, 22); \
+	\
+	MD5STEP(F2, a, b, c, d, 1, 0xf61e2562, 5); \
+	MD5STEP(F2, d, a, b, c, 6, 0xc040b340, 9); \
+	MD5STEP(F2, c, d, a, b, 11, 0x265e5a51, 14); \
+	MD5STEP(F2, b, c, d, a, 0, 0xe9b6c7aa, 20); \
+	MD5STEP(F2, a, b, c, d, 5, 0xd62f105d, 5); \
+	MD5STEP(F2, d, a, b, c, 10, 0x02441453, 9); \
+	MD5STEP(F2, c, d, a, b, 15, 0xd8a1e681, 14); \
+	MD5STEP(F2, b, c, d, a, 4, 0xe7d3fbc8, 20); \
+	MD5STEP(F2, a, b, c, d, 9, 0x21e1cde6, 5); \
+	MD5STEP(F2, d, a, b, c, 14, 0xc33707d6, 9); \
+	MD5STEP(F2, c, d, a, b, 3, 0xf4d50d87, 14); \
+	MD5STEP(F2, b, c, d, a, 8, 0x455a14ed, 20); \
+	MD5STEP(F2, a, b, c, d, 13, 0xa9e3e905, 5); \
+	MD5STEP(F2, d, a, b, c, 2, 0xfcefa3f8, 9); \
+	MD5STEP(F2, c, d, a, b, 7, 0x676f02d9, 14); \
+	MD5STEP(F2, b, c, d, a, 12, 0x8d2a4c8a, 20); \
+	\
+	MD5STEP(F3, a, b, c, d, 5, 0xfffa3942, 4); \
+	MD5STEP(F3, d, a, b, c, 8, 0x8771f681, 11); \
+	MD5STEP(F3, c, d, a, b, 11, 0x6d9d6122, 16); \
+	MD5STEP(F3, b, c, d, a, 14, 0xfde5380c, 23); \
+	MD5STEP(F3, a, b, c, d, 1, 0xa4beea44, 4); \
+	MD5STEP(F3, d, a, b, c, 4, 0x4bdecfa9, 11); \
+	MD5STEP(F3, c, d, a, b, 7, 0xf6bb4b60, 16); \
+	MD5STEP(F3, b, c, d, a, 10, 0xbebfbc70, 23); \
+	MD5STEP(F3, a, b, c, d, 13, 0x289b7ec6, 4); \
+	MD5STEP(F3, d, a, b, c, 0, 0xeaa127fa, 11); \
+	MD5STEP(F3, c, d, a, b, 3, 0xd4ef3085, 16); \
+	MD5STEP(F3, b, c, d, a, 6, 0x04881d05, 23); \
+	MD5STEP(F3, a, b, c, d, 9, 0xd9d4d039, 4); \
+	MD5STEP(F3, d, a, b, c, 12, 0xe6db99e5, 11); \
+	MD5STEP(F3, c, d, a, b, 15, 0x1fa27cf8, 16); \
+	MD5STEP(F3, b, c, d, a, 2, 0xc4ac5665, 23); \
+	\
+	MD5STEP(F4, a, b, c, d, 0, 0xf4292244, 6); \
+	MD5STEP(F4, d, a, b, c, 7, 0x432aff97, 10); \
+	MD5STEP(F4, c, d, a, b, 14, 0xab9423a7, 15); \
+	MD5STEP(F4, b, c, d, a, 5, 0xfc93a039, 21); \
+	MD5STEP(F4, a, b, c, d, 12, 0x655b59c3, 6); \
+	MD5STEP(F4, d, a, b, c, 3, 0x8f0ccc92, 10); \
+	MD5STEP(F4, c, d, a, b, 10, 0xffeff47d, 15); \
+	MD5STEP(F4, b, c, d, a, 1, 0x85845dd1, 21); \
+	MD5STEP(F4, a, b, c, d, 8, 0x6fa87e4f, 6); \
+	MD5STEP(F4, d, a, b, c, 15, 0xfe2ce6e0, 10); \
+	MD5STEP(F4, c, d, a, b, 6, 0xa3014314, 15); \
+	MD5STEP(F4, b, c, d, a, 13, 0x4e0811a1, 21); \
+	MD5STEP(F4, a, b, c, d, 4, 0xf7537e82, 6); \
+	MD5STEP(F4, d, a, b, c, 11, 0xbd3af235, 10); \
+	MD5STEP(F4, c, d, a, b, 2, 0x2ad7d2bb, 15); \
+	MD5STEP(F4, b, c, d, a, 9, 0xeb86d391, 21)
+
+/*
+ * Processes the same count of consecutive 64-byte blocks for each lane,
+ * state[] is the buf[] member of each context.
+ */
+#define MD5KERNEL(name, target, lanes, vec) \
+static MD5_MULTI_TARGET(target) void name(uint32_t *state[], \
+	unsigned char const *data[], size_t blocks) \
+{ \
+	uint32_t T[16][lanes]; \
+	vec a, b, c, d, aa, bb, cc, dd, X[16]; \
+	size_t i; \
+	unsigned j, l; \
+	\
+	for (l = 0; l < lanes; l++) \
+		for (j = 0; j < 4; j++) \
+			T[j][l] = state[l][j]; \
+	a = V_LOAD(T[0]); \
+	b = V_LOAD(T[1]); \
+	c = V_LOAD(T[2]); \
+	d = V_LOAD(T[3]); \
+	\
+	for (i = 0; i < blocks; i++) { \
+		/* Transposing, word j of each lane in the lanes of X[j] */ \
+		for (l = 0; l < lanes; l++) \
+			for (j = 0; j < 16; j++) \
+				memcpy(&T[j][l], data[l] + i * 64 + j * 4, 4); \
+		for (j = 0; j < 16; j++) \
+			X[j] = V_LOAD(T[j]); \
+		\
+		aa = a; \
+		bb = b; \
+		cc = c; \
+		dd = d; \
+		MD5ROUNDS; \
+		a = V_ADD(a, aa); \
+		b = V_ADD(b, bb); \
+		c = V_ADD(c, cc); \
+		d = V_ADD(d, dd); \
+	} \
+	\
+	V_STORE(T[0], a); \
+	V_STORE(T[1], b); \
+	V_STORE(T[2], c); \
+	V_STORE(T[3], d); \
+	for (l = 0; l < lanes; l++) \
+		for (j = 0; j < 4; j++) \
+			state[l][j] = T[j][l]; \
+}
+
+/* SSE2, 4 lanes */
+#define V_ADD(x, y)	_mm_add_epi32(x, y)
+#define V_AND(x, y)	_mm_and_si128(x, y)
+#define V_OR(x, y)	_mm_or_si128(x, y)
+#define V_XOR(x, y)	_mm_xor_si128(x, y)
+#define V_NOT(x)	_mm_xor_si128(x, _mm_set1_epi32(-1))
+#define V_ROL(x, s)	_mm_or_si128(_mm_slli_epi32(x, s), _mm_srli_epi32(x, 32 - (s)))
+#define V_SET1(k)	_mm_set1_epi32((int)(k))
+#define V_LOAD(p)	_mm_loadu_si128((__m128i const *)(p))
+#define V_STORE(p, x)	_mm_storeu_si128((__m128i *)(p), x)
+MD5KERNEL(MD5Multi_Blocks_SSE2, "sse2", 4, __m128i)
+#undef V_ADD
+#undef V_AND
+#undef V_OR
+#undef V_XOR
+#undef V_NOT
+#undef V_ROL
+#undef V_SET1
+#undef V_LOAD
+#undef V_STORE
+
+/* AVX2, 8 lanes */
+#define V_ADD(x, y)	_mm256_add_epi32(x, y)
+#define V_AND(x, y)	_mm256_and_si256(x, y)
+#define V_OR(x, y)	_mm256_or_si256(x, y)
+#define V_XOR(x, y)	_mm256_xor_si256(x, y)
+#define V_NOT(x)	_mm256_xor_si256(x, _mm256_set1_epi32(-1))
+#define V_ROL(x, s)	_mm256_or_si256(_mm256_slli_epi32(x, s), _mm256_srli_epi32(x, 32 - (s)))
+#define V_SET1(k)	_mm256_set1_epi32((int)(k))
+#define V_LOAD(p)	_mm256_loadu_si256((__m256i const *)(p))
+#define V_STORE(p, x)	_mm256_storeu_si256((__m256i *)(p), x)
+MD5KERNEL(MD5Multi_Blocks_AVX2, "avx2", 8, __m256i)
+#undef V_ADD
+#undef V_AND
+#undef V_OR
+#undef V_XOR
+#undef V_NOT
+#undef V_ROL
+#undef V_SET1
+#undef V_LOAD
+#undef V_STORE
+
+/* AVX-512, 16 lanes */
+#define V_ADD(x, y)	_mm512_add_epi32(x, y)
+#define V_AND(x, y)	_mm512_and_si512(x, y)
+#define V_OR(x, y)	_mm512_or_si512(x, y)
+#define V_XOR(x, y)	_mm512_xor_si512(x, y)
+#define V_NOT(x)	_mm512_xor_si512(x, _mm512_set1_epi32(-1))
+#define V_ROL(x, s)	_mm512_rol_epi32(x, s)
+#define V_SET1(k)	_mm512_set1_epi32((int)(k))
+#define V_LOAD(p)	_mm512_loadu_si512((void const *)(p))
+#define V_STORE(p, x)	_mm512_storeu_si512((void *)(p), x)
+MD5KERNEL(MD5Multi_Blocks_AVX512, "avx512f", 16, __m512i)
+#undef V_ADD
+#undef V_AND
+#undef V_OR
+#undef V_XOR
+#undef V_NOT
+#undef V_ROL
+#undef V_SET1
+#undef V_LOAD
+#undef V_STORE
+
+/*
+ * Lanes of the widest kernel supported by the CPU and the OS
+ */
+static unsigned MD5Multi_Detect(void)
+{
+#if defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return 16;
+	if (__builtin_cpu_supports("avx2"))
+		return 8;
+	if (__builtin_cpu_supports("sse2"))
+		return 4;
+	return 1;
+#else
+	int info[4];
+	unsigned long long xcr0 = 0;
+
+	__cpuid(info, 1);
+	if (!(info[3] & (1 << 26)))
+		return 1;	/* No SSE2 */
+	if (!(info[2] & (1 << 27)))
+		return 4;	/* No OSXSAVE, AVX registers are not saved */
+	xcr0 = _xgetbv(0);
+	__cpuidex(info, 7, 0);
+	if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6)
+		return 16;
+	if ((info[1] & (1 << 5)) && (xcr0 & 0x06) == 0x06)
+		return 8;
+	return 4;
+#endif
+}
+
+#endif /* MD5_MULTI_X86 */
+
+unsigned MD5Multi_Lanes(void)
+{
+#ifdef MD5_MULTI_X86
+	static unsigned lanes = 0;	/* Same value from any thread */
+
+	if (!lanes)
+		lanes = MD5Multi_Detect();
+	return lanes;
+#else
+	return 1;
+#endif
+}
+
+/*
+ * Update the bit count as MD5Update() does
+ */
+static void MD5Multi_Bits(struct MD5Context *ctx, size_t len)
+{
+	uint64_t bits = ((uint64_t) ctx->bits[1] << 32 | ctx->bits[0]) + ((uint64_t) len << 3);
+
+	ctx->bits[0] = (uint32_t) bits;
+	ctx->bits[1] = (uint32_t) (bits >> 32);
+}
+
+void MD5Multi_Update(struct MD5Context *ctx[], unsigned char const *buf[],
+	       unsigned const len[], unsigned count)
+{
+	unsigned char const *p[MD5_MULTI_LANES_MAX];
+	unsigned n[MD5_MULTI_LANES_MAX];
+	unsigned i;
+
+	while (count > MD5_MULTI_LANES_MAX) {
+		MD5Multi_Update(ctx, buf, len, MD5_MULTI_LANES_MAX);
+		ctx += MD5_MULTI_LANES_MAX;
+		buf += MD5_MULTI_LANES_MAX;
+		len += MD5_MULTI_LANES_MAX;
+		count -= MD5_MULTI_LANES_MAX;
+	}
+
+	/* Handle any leading odd-sized chunks with the scalar code */
+
+	for (i = 0; i < count; i++) {
+		unsigned t = (ctx[i]->bits[0] >> 3) & 0x3f;
+
+		p[i] = buf[i];
+		n[i] = len[i];
+		if (t) {
+			t = 64 - t;
+			if (t > n[i])
+				t = n[i];
+			MD5Update(ctx[i], p[i], t);
+			p[i] += t;
+			n[i] -= t;
+		}
+	}
+
+#ifdef MD5_MULTI_X86
+	/* Process data in 64-byte chunks, several contexts at once */
+
+	if (MD5Multi_Lanes() > 1)
+		for (;;) {
+			uint32_t *state[MD5_MULTI_LANES_MAX];
+			unsigned char const *data[MD5_MULTI_LANES_MAX];
+			unsigned active[MD5_MULTI_LANES_MAX];
+			uint32_t unused[4];
+			unsigned a = 0, width, l;
+			size_t blocks = (size_t) -1;
+
+			for (i = 0; i < count && a < MD5Multi_Lanes(); i++)
+				if (n[i] >= 64) {
+					active[a++] = i;
+					if (n[i] / 64 < blocks)
+						blocks = n[i] / 64;
+				}
+			if (a < 2)
+				break;	/* Nothing to do together */
+
+			/* Smallest kernel with enough lanes, the other lanes compute a copy of the first one */
+			width = a <= 4 ? 4 : (a <= 8 ? 8 : 16);
+			for (l = 0; l < width; l++) {
+				if (l < a) {
+					state[l] = ctx[active[l]]->buf;
+					data[l] = p[active[l]];
+				} else {
+					memcpy(unused, state[0], sizeof(unused));
+					state[l] = unused;
+					data[l] = data[0];
+				}
+			}
+			if (width == 4)
+				MD5Multi_Blocks_SSE2(state, data, blocks);
+			else if (width == 8)
+				MD5Multi_Blocks_AVX2(state, data, blocks);
+			else
+				MD5Multi_Blocks_AVX512(state, data, blocks);
+
+			for (l = 0; l < a; l++) {
+				MD5Multi_Bits(ctx[active[l]], blocks * 64);
+				p[active[l]] += blocks * 64;
+				n[active[l]] -= (unsigned) (blocks * 64);
+			}
+		}
+#endif
+
+	/* Handle the remaining data with the scalar code */
+
+	for (i = 0; i < count; i++)
+		if (n[i])
+			MD5Update(ctx[i], p[i], n[i]);
+}
@@ -0,0 +1,17 @@
+#ifndef MD5_MULTI_H
+#define MD5_MULTI_H
+
+#include "MD5/md5.h"
+
+/* Maximum count of contexts updated at once */
+#define MD5_MULTI_LANES_MAX 16
+
+/* Count of contexts the best kernel of this CPU updates at once, 1 if there is none */
+unsigned MD5Multi_Lanes(void);
+
+/* Same result as MD5Update() on each context, full blocks of the contexts
+   are processed together by SIMD kernels (up to MD5_MULTI_LANES_MAX) */
+void MD5Multi_Update(struct MD5Context *ctx[], unsigned char const *buf[],
+	       unsigned const len[], unsigned count);
+
+#endif /* !MD5_MULTI_H */
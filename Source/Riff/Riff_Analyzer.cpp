@@ -0,0 +1,128 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Analyzer.h"
+#include "ZenLib/Utils.h"
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Riff_Analyzer_PCM::Riff_Analyzer_PCM(int16u FormatTag_, int16u Channels_, int32u SampleRate_, int16u BitsPerSample_, int16u BlockAlign_)
+{
+    FormatTag=FormatTag_;
+    Channels=Channels_;
+    SampleRate=SampleRate_;
+    BitsPerSample=BitsPerSample_;
+    BlockAlign=BlockAlign_;
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Analyzer_PCM::IsSupported() const
+{
+    if (!Channels || SampleRate<10 || !BlockAlign || BlockAlign%Channels)
+        return false;
+    size_t Bytes=BlockAlign/Channels;
+    if (FormatTag==1)
+        return Bytes>=1 && Bytes<=4 && BitsPerSample<=Bytes*8;
+    if (FormatTag==3)
+        return Bytes==4 || Bytes==8;
+    return false;
+}
+
+//***************************************************************************
+// Feeding
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void Riff_Analyzer_PCM::Update(const int8u* Buffer, size_t Buffer_Size)
+{
+    if (!IsSupported())
+        return;
+
+    //Frame split between the previous buffer and this one
+    if (!Frame_Partial.empty())
+    {
+        size_t ToCopy=BlockAlign-Frame_Partial.size();
+        if (ToCopy>Buffer_Size)
+            ToCopy=Buffer_Size;
+        Frame_Partial.insert(Frame_Partial.end(), Buffer, Buffer+ToCopy);
+        Buffer+=ToCopy;
+        Buffer_Size-=ToCopy;
+        if (Frame_Partial.size()<BlockAlign)
+            return;
+        Process_Frames(&Frame_Partial[0], 1);
+        Frame_Partial.clear();
+    }
+
+    size_t Frames=Buffer_Size/BlockAlign;
+    if (Frames)
+        Process_Frames(Buffer, Frames);
+
+    Frame_Partial.assign(Buffer+Frames*BlockAlign, Buffer+Buffer_Size);
+}
+
+//---------------------------------------------------------------------------
+void Riff_Analyzer_PCM::Process_Frames(const int8u* Buffer, size_t Frames)
+{
+    if (Block.empty())
+        Block.resize(Channels*Block_Frames); //Only if decoded
+
+    while (Frames)
+    {
+        size_t ToDo=Frames<Block_Frames?Frames:Block_Frames;
+        Decode(Buffer, ToDo);
+        Process(&Block[0], ToDo);
+        Buffer+=ToDo*BlockAlign;
+        Frames-=ToDo;
+    }
+}
+
+//---------------------------------------------------------------------------
+void Riff_Analyzer_PCM::Decode(const int8u* Buffer, size_t Frames)
+{
+    //The format is tested once per block, not per sample
+    size_t Bytes=BlockAlign/Channels;
+    for (size_t Channel=0; Channel<Channels; Channel++)
+    {
+        const int8u* In=Buffer+Channel*Bytes;
+        float64* Out=&Block[Channel*Frames];
+        if (FormatTag==3)
+        {
+            if (Bytes==4)
+                for (size_t Frame=0; Frame<Frames; Frame++)
+                    Out[Frame]=LittleEndian2float32(In+Frame*BlockAlign);
+            else
+                for (size_t Frame=0; Frame<Frames; Frame++)
+                    Out[Frame]=LittleEndian2float64(In+Frame*BlockAlign);
+            continue;
+        }
+        switch (Bytes)
+        {
+            case 1 :
+                    for (size_t Frame=0; Frame<Frames; Frame++)
+                        Out[Frame]=((int)In[Frame*BlockAlign]-128)/128.0; //Unsigned
+                    break;
+            case 2 :
+                    for (size_t Frame=0; Frame<Frames; Frame++)
+                        Out[Frame]=(int16s)(In[Frame*BlockAlign] | (In[Frame*BlockAlign+1]<<8))/32768.0;
+                    break;
+            case 3 :
+                    for (size_t Frame=0; Frame<Frames; Frame++)
+                        Out[Frame]=((int32s)((In[Frame*BlockAlign]<<8) | (In[Frame*BlockAlign+1]<<16) | ((int32u)In[Frame*BlockAlign+2]<<24))>>8)/8388608.0;
+                    break;
+            default:
+                    for (size_t Frame=0; Frame<Frames; Frame++)
+                        Out[Frame]=(int32s)(In[Frame*BlockAlign] | (In[Frame*BlockAlign+1]<<8) | (In[Frame*BlockAlign+2]<<16) | ((int32u)In[Frame*BlockAlign+3]<<24))/2147483648.0;
+        }
+    }
+}
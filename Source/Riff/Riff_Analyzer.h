@@ -0,0 +1,76 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#ifndef Riff_AnalyzerH
+#define Riff_AnalyzerH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "ZenLib/Conf.h"
+#include <vector>
+using namespace ZenLib;
+using namespace std;
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Consumer of the audio data, all analyzers are fed by one read of the data chunk
+//***************************************************************************
+
+class Riff_Analyzer
+{
+public:
+    //Constructor/Destructor
+    virtual ~Riff_Analyzer() {}
+
+    //Feeding, buffers are in order and of any size
+    virtual void    Update(const int8u* Buffer, size_t Buffer_Size)=0;
+    virtual void    Finish()=0;
+
+    //True if the analyzer may be fed from its own thread, false if it must be fed from the reading thread
+    virtual bool    Thread_Allowed() const {return true;}
+};
+
+//***************************************************************************
+// Analyzer of PCM samples, decoded to planar blocks of float64 (-1.0 to 1.0)
+//***************************************************************************
+
+class Riff_Analyzer_PCM : public Riff_Analyzer
+{
+public:
+    //Constructor/Destructor
+    Riff_Analyzer_PCM(int16u FormatTag, int16u Channels, int32u SampleRate, int16u BitsPerSample, int16u BlockAlign); //FormatTag: 1 (integer PCM) or 3 (float PCM), the sub-format for WAVE_FORMAT_EXTENSIBLE
+
+    bool            IsSupported() const;
+
+    //Feeding
+    void            Update(const int8u* Buffer, size_t Buffer_Size); //Frames may be split between buffers
+
+protected:
+    //Format
+    int16u          FormatTag;
+    int16u          Channels;
+    int32u          SampleRate;
+    int16u          BitsPerSample;
+    int16u          BlockAlign;
+
+    //Whole frames, interleaved as in the file, decoded to blocks by default
+    virtual void    Process_Frames(const int8u* Buffer, size_t Frames);
+
+    //Block of Channels x Frames samples, Frames is at most Block_Frames
+    static const size_t Block_Frames=4096;
+    virtual void    Process(const float64* /*Block*/, size_t /*Frames*/) {}
+
+private:
+    vector<int8u>   Frame_Partial; //Bytes of a frame split between 2 buffers
+    vector<float64> Block;
+    void            Decode(const int8u* Buffer, size_t Frames);
+};
+
+#endif
@@ -10,11 +10,27 @@
 //---------------------------------------------------------------------------
 #include "Riff/Riff_Base.h"
 #include "Riff/Riff_Chunks.h" //Needed for ds64
+extern "C"
+{
+#include "MD5/md5.h"
+#include "Hash/xxh3.h"
+#include "Hash/sha256.h"
+#include "Hash/blake3.h"
+}
 #include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <cstring>
 #include <iomanip>
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #ifdef __linux__
+        #include <sys/vfs.h>
+    #endif //__linux__
+#endif //_WIN32
 
 #ifdef MACSTORE
 #include "Common/Mac_Helpers.h"
@@ -98,16 +114,11 @@ void Riff_Base::Read (chunk &Chunk_In)
         int8u Temp[1];
         if (Global->In.Position_Get()==Global->In.Size_Get())
             Temp[0]='A'; //Malformed
-        else if (Global->In.Read(Temp, 1)<1)
+        else if (Global->In_Read(Temp, 1)<1)
             throw exception_read();
-        Global->CS.Enter();
-        Global->Progress=(float)Global->In.Position_Get()/Global->In.Size_Get();
-        if (Global->Canceling)
-        {
-            Global->CS.Leave();
+        Global->Progress->Done_Set(Global->In.Position_Get());
+        if (Global->Progress->Canceling)
             throw exception_canceled();
-        }
-        Global->CS.Leave();
         //SleeperThread::msleep(20);
         if ((Temp[0]<'A' || Temp[0]>'z') && Temp[0]!=' ')
             File_in_Chunk_Content_HasPadding=true;
@@ -151,7 +162,7 @@ bool Riff_Base::Read_Header (chunk &NewChunk)
     //Chunk name
     if (Global->In.Position_Get()+8>Chunk.File_In_Position+Chunk.Header.Size+Chunk.Content.Size)
         throw exception_valid("small");
-    if (Global->In.Read(Temp, 4)<4)
+    if (Global->In_Read(Temp, 4)<4)
         throw exception_read();
     NewChunk.Header.Name=CC4(Temp);
     if (Chunk.Header.Level==0 && Global->ds64==NULL && !(NewChunk.Header.Name==Elements::RIFF || NewChunk.Header.Name==Elements::RF64))
@@ -164,7 +175,7 @@ bool Riff_Base::Read_Header (chunk &NewChunk)
     //Chunk size
     if (Global->In.Position_Get()+4>Chunk.File_In_Position+Chunk.Header.Size+Chunk.Content.Size)
         throw exception_valid("small");
-    if (Global->In.Read(Temp, 4)<4)
+    if (Global->In_Read(Temp, 4)<4)
         throw exception_read();
     NewChunk.Content.Size=LittleEndian2int32u(Temp);
     if (Global->IsRF64 && Global->ds64 && NewChunk.Header.Level==2 && NewChunk.Header.Name==Elements::WAVE_data && NewChunk.Content.Size==Global->ds64->dataSize%0x100000000LL)
@@ -182,7 +193,7 @@ bool Riff_Base::Read_Header (chunk &NewChunk)
     {
         if (Global->In.Position_Get()+4>Chunk.File_In_Position+Chunk.Header.Size+Chunk.Content.Size)
             throw exception_valid("small");
-        if (Global->In.Read(Temp, 4)<4)
+        if (Global->In_Read(Temp, 4)<4)
             throw exception_read();
         NewChunk.Header.List=NewChunk.Header.Name;
         NewChunk.Header.Name=CC4(Temp);
@@ -224,7 +235,22 @@ void Riff_Base::Read_Internal_ReadAllInBuffer ()
     if (Chunk.File_In_Position+Chunk.Header.Size+Chunk.Content.Size>Global->In.Size_Get())
         throw exception_valid(!Global->TruncatedChunks.str().empty()?"truncated ("+Global->TruncatedChunks.str()+")":"truncated");
 
-    delete Chunk.Content.Buffer; Chunk.Content.Buffer=NULL;
+    if (!Chunk.Content.Buffer_IsMapped)
+        delete[] Chunk.Content.Buffer;
+    Chunk.Content.Buffer=NULL;
+    Chunk.Content.Buffer_IsMapped=false;
+
+    //Parsing in place if the file is mapped
+    if (Global->In_Map.Data)
+    {
+        Chunk.Content.Buffer=Global->In_Map.Data+Chunk.File_In_Position+Chunk.Header.Size;
+        Chunk.Content.Buffer_IsMapped=true;
+        Global->In.GoTo(Chunk.File_In_Position+Chunk.Header.Size+Chunk.Content.Size);
+        Global->Progress->Done_Set(Global->In.Position_Get());
+        if (Global->Progress->Canceling)
+            throw exception_canceled();
+        return;
+    }
 
     try
     {
@@ -238,17 +264,12 @@ void Riff_Base::Read_Internal_ReadAllInBuffer ()
     //Reading
     while(Chunk.Content.Buffer_Offset<Chunk.Content.Size)
     {
-        size_t BytesRead=Global->In.Read(Chunk.Content.Buffer+Chunk.Content.Buffer_Offset, (size_t)Chunk.Content.Size-Chunk.Content.Buffer_Offset);
+        size_t BytesRead=Global->In_Read(Chunk.Content.Buffer+Chunk.Content.Buffer_Offset, (size_t)Chunk.Content.Size-Chunk.Content.Buffer_Offset);
         if (BytesRead==0)
             break; //Read is finished
-        Global->CS.Enter();
-        Global->Progress=(float)Global->In.Position_Get()/Global->In.Size_Get();
-        if (Global->Canceling)
-        {
-            Global->CS.Leave();
+        Global->Progress->Done_Set(Global->In.Position_Get());
+        if (Global->Progress->Canceling)
             throw exception_canceled();
-        }
-        Global->CS.Leave();
         //SleeperThread::msleep(20);
         Chunk.Content.Buffer_Offset+=BytesRead;
     }
@@ -257,6 +278,148 @@ void Riff_Base::Read_Internal_ReadAllInBuffer ()
     Chunk.Content.Buffer_Offset=0;
 }
 
+//---------------------------------------------------------------------------
+void Riff_Base::Map_Detach ()
+{
+    //Copying chunk content still pointing into the mapped file
+    if (Chunk.Content.Buffer_IsMapped)
+    {
+        int8u* Buffer=new int8u[(size_t)Chunk.Content.Size];
+        memcpy(Buffer, Chunk.Content.Buffer, (size_t)Chunk.Content.Size);
+        Chunk.Content.Buffer=Buffer;
+        Chunk.Content.Buffer_IsMapped=false;
+    }
+
+    for (size_t Pos=0; Pos<Subs.size(); Pos++)
+        Subs[Pos]->Map_Detach();
+}
+
+//---------------------------------------------------------------------------
+void Riff_Base::Map_Close ()
+{
+    if (!Global->In_Map.Data)
+        return;
+
+    Map_Detach();
+    Global->In_Map_Close();
+}
+
+//***************************************************************************
+// Mapping
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool Riff_Base::global::In_Map_Open ()
+{
+    In_Map_Close();
+
+    #ifndef _WIN32
+        int64u Size=In.Size_Get();
+        if (Size==0 || Size==(int64u)-1 || Size>(size_t)-1)
+            return false;
+
+        int Fd=open(File_Name.To_Local().c_str(), O_RDONLY);
+        if (Fd<0)
+            return false;
+        struct stat Stat;
+        if (fstat(Fd, &Stat) || (int64u)Stat.st_size!=Size)
+        {
+            close(Fd);
+            return false;
+        }
+        #ifdef __linux__
+            //Not on network file systems, a change on the server side would crash on access
+            struct statfs StatFs;
+            if (!fstatfs(Fd, &StatFs))
+                switch ((int32u)StatFs.f_type)
+                {
+                    case 0x00006969 : //NFS
+                    case 0x0000517B : //SMB
+                    case 0xFF534D42 : //CIFS
+                    case 0xFE534D42 : //SMB2
+                    case 0x65735546 : //FUSE
+                                        close(Fd);
+                                        return false;
+                    default         : ;
+                }
+        #endif //__linux__
+
+        //Private and writable, content is modified in place by some chunks without changing the file
+        void* Data=mmap(NULL, (size_t)Size, PROT_READ|PROT_WRITE, MAP_PRIVATE, Fd, 0);
+        close(Fd); //The mapping keeps its own reference
+        if (Data==MAP_FAILED)
+            return false;
+
+        In_Map.Data=(int8u*)Data;
+        In_Map.Size=Size;
+        return true;
+    #else //_WIN32
+        return false; //Not implemented, buffered reads are used
+    #endif //_WIN32
+}
+
+//---------------------------------------------------------------------------
+void Riff_Base::global::In_Map_Close ()
+{
+    #ifndef _WIN32
+        if (In_Map.Data)
+            munmap(In_Map.Data, (size_t)In_Map.Size);
+    #endif //_WIN32
+    In_Map=mapping();
+}
+
+//---------------------------------------------------------------------------
+void Riff_Base::global::In_Prefetch_Clear ()
+{
+    delete[] In_Prefetch.Data;
+    In_Prefetch=prefetch();
+}
+
+//---------------------------------------------------------------------------
+size_t Riff_Base::global::In_Read (int8u* Buffer, size_t Buffer_Size)
+{
+    int64u Position=In.Position_Get();
+
+    if (In_Map.Data)
+    {
+        if (Position>=In_Map.Size)
+            return 0;
+        if (Buffer_Size>In_Map.Size-Position)
+            Buffer_Size=(size_t)(In_Map.Size-Position);
+        memcpy(Buffer, In_Map.Data+Position, Buffer_Size);
+        In.GoTo(Position+Buffer_Size);
+        return Buffer_Size;
+    }
+
+    //Small read outside of the window (file header, or what is after the data chunk), filling the window from there
+    if ((Position<In_Prefetch.Offset || Position>=In_Prefetch.Offset+In_Prefetch.Size) && Buffer_Size<RIFF_Prefetch_Size/2)
+    {
+        if (!In_Prefetch.Data)
+            In_Prefetch.Data=new int8u[RIFF_Prefetch_Size];
+        In_Prefetch.Offset=Position;
+        In_Prefetch.Size=In.Read_At(In_Prefetch.Data, RIFF_Prefetch_Size, Position);
+        In_Prefetch.Count_Fill++;
+    }
+
+    //From the window
+    size_t BytesRead=0;
+    if (Position>=In_Prefetch.Offset && Position<In_Prefetch.Offset+In_Prefetch.Size)
+    {
+        BytesRead=(size_t)(In_Prefetch.Offset+In_Prefetch.Size-Position);
+        if (BytesRead>Buffer_Size)
+            BytesRead=Buffer_Size;
+        memcpy(Buffer, In_Prefetch.Data+(size_t)(Position-In_Prefetch.Offset), BytesRead);
+        In.GoTo(Position+BytesRead);
+        In_Prefetch.Count_Memory++;
+    }
+
+    //Remaining part, directly from the file
+    if (BytesRead<Buffer_Size)
+        BytesRead+=In.Read(Buffer+BytesRead, Buffer_Size-BytesRead);
+
+    return BytesRead;
+}
+
 //***************************************************************************
 // Modify
 //***************************************************************************
@@ -264,6 +427,10 @@ void Riff_Base::Read_Internal_ReadAllInBuffer ()
 //---------------------------------------------------------------------------
 void Riff_Base::Modify (int32u Chunk_Name_1, int32u Chunk_Name_2, int32u Chunk_Name_3)
 {
+    //Buffers are going to be modified or freed, and the file rewritten
+    if (Chunk.Header.Level==0)
+        Map_Close();
+
     if (Chunk_Name_1==0x00000000)
         Modify_Internal();
     else
@@ -364,21 +531,114 @@ void Riff_Base::Modify_Internal_Subs (int32u Chunk_Name_1, int32u Chunk_Name_2,
 //***************************************************************************
 
 //---------------------------------------------------------------------------
-void Riff_Base::Write ()
+//Digest of the audio data copied in the temporary file, with the fastest algorithm already used when parsing
+struct Riff_Base::global::digest
 {
+    enum kind
+    {
+        Kind_None,
+        Kind_XXH3,
+        Kind_MD5,
+        Kind_BLAKE3,
+        Kind_SHA256,
+    };
+    kind                Kind;
+    string              Name;
+    string              Expected;
+    XXH3Context         XXH3;
+    MD5Context          MD5;
+    BLAKE3Context       BLAKE3;
+    SHA256Context       SHA256;
+
+    digest(global &Global)
+    {
+        Kind=Kind_None;
+        chunk_strings* Hashes=Global.HashesGenerated;
+        if (Hashes && !Hashes->Strings["xxh3generated"].empty())
+            Set(Kind_XXH3, "XXH3", Hashes->Strings["xxh3generated"]);
+        else if (Global.MD5Generated && !Global.MD5Generated->Strings["md5generated"].empty())
+            Set(Kind_MD5, "MD5", Global.MD5Generated->Strings["md5generated"]);
+        else if (Hashes && !Hashes->Strings["blake3generated"].empty())
+            Set(Kind_BLAKE3, "BLAKE3", Hashes->Strings["blake3generated"]);
+        else if (Hashes && !Hashes->Strings["sha256generated"].empty())
+            Set(Kind_SHA256, "SHA256", Hashes->Strings["sha256generated"]);
+    }
 
-    if (Chunk.Header.Level==0)
+    void Set(kind Kind_, const char* Name_, const string &Expected_)
+    {
+        Kind=Kind_;
+        Name=Name_;
+        Expected=Ztring().From_UTF8(Expected_).MakeLowerCase().To_UTF8();
+        switch (Kind)
+        {
+            case Kind_XXH3  : XXH3Init(&XXH3); break;
+            case Kind_MD5   : MD5Init(&MD5); break;
+            case Kind_BLAKE3: BLAKE3Init(&BLAKE3); break;
+            case Kind_SHA256: SHA256Init(&SHA256); break;
+            default         : ;
+        }
+    }
+
+    void Update(const int8u* Buffer, size_t Buffer_Size)
+    {
+        switch (Kind)
+        {
+            case Kind_XXH3  : XXH3Update(&XXH3, Buffer, Buffer_Size); break;
+            case Kind_MD5   : MD5Update(&MD5, Buffer, (unsigned)Buffer_Size); break;
+            case Kind_BLAKE3: BLAKE3Update(&BLAKE3, Buffer, Buffer_Size); break;
+            case Kind_SHA256: SHA256Update(&SHA256, Buffer, Buffer_Size); break;
+            default         : ;
+        }
+    }
+
+    bool Verify()
     {
-        //Reset buffers and states
-        if(Global->Out_Buffer_Begin.Data)
-            delete[] Global->Out_Buffer_Begin.Data;
-        Global->Out_Buffer_Begin=global::buffer();
-        if(Global->Out_Buffer_End.Data)
-            delete[] Global->Out_Buffer_End.Data;
-        Global->Out_Buffer_End=global::buffer();
-        Global->Out_Buffer_WriteAtEnd=false;
+        int8u Digest[32];
+        size_t Digest_Size;
+        switch (Kind)
+        {
+            case Kind_XXH3  : XXH3Final(Digest, &XXH3); Digest_Size=8; break;
+            case Kind_MD5   : MD5Final(Digest, &MD5); Digest_Size=16; break;
+            case Kind_BLAKE3: BLAKE3Final(Digest, &BLAKE3); Digest_Size=32; break;
+            case Kind_SHA256: SHA256Final(Digest, &SHA256); Digest_Size=32; break;
+            default         : return true;
+        }
+
+        ostringstream DigestS;
+        DigestS<<hex<<setfill('0');
+        for (size_t Pos=0; Pos<Digest_Size; Pos++)
+            DigestS<<setw(2)<<(int)Digest[Pos];
+        return DigestS.str()==Expected;
     }
+};
+
+//---------------------------------------------------------------------------
+void Riff_Base::Write ()
+{
+    if (!IsModified())
+        return; //Nothing to do if the file is not modifed
 
+    //The file is going to be rewritten
+    Map_Close();
+    Global->Out_Digest_Verified.clear();
+
+    //Everything is known before the first write
+    Write_Plan();
+    if (!Global->Out_Plan.InPlace || !Write_InPlace())
+        Write_Copy();
+}
+
+//---------------------------------------------------------------------------
+void Riff_Base::Write_Plan ()
+{
+    Global->Out_Plan.Clear();
+    Write_Plan_Chunk();
+    Global->Out_Plan.Finish(Global->File_Size, Global->InsertRange?Global->Block_Size:0);
+}
+
+//---------------------------------------------------------------------------
+void Riff_Base::Write_Plan_Chunk ()
+{
     //Header
     if (Chunk.Header.Level)
     {
@@ -433,8 +693,6 @@ void Riff_Base::Write ()
             Write_Internal(Header, 8);
         }
     }
-    else if (!IsModified())
-        return; //Nothing to do if the file is not modifed (Level 0)
 
     //Testing if chunk order is valid from user preferences
     if (Chunk.Header.Level==0 && Global->NewChunksAtTheEnd)
@@ -485,137 +743,180 @@ void Riff_Base::Write ()
     }
     
     //Content
-    if (Chunk.Content.IsModified)
+    if (Chunk.Content.IsModified && !Subs.empty())
     {
-        if (!Subs.empty())
-            for (size_t Pos=0; Pos<Subs.size(); Pos++)
-                Subs[Pos]->Write();
-        else
-        {
-            Write_Internal();
-            
-            //Padding
-            if (Chunk.Content.Size%2)
-            {
-                int8u Temp[1];
-                Temp[0]=0x00;
-                Write_Internal(Temp, 1);
-            }
-        }
+        for (size_t Pos=0; Pos<Subs.size(); Pos++)
+            Subs[Pos]->Write_Plan_Chunk();
     }
     else
     {
         Write_Internal();
-        
+
         //Padding
         if (Chunk.Content.Size%2)
-        {
-            int8u Temp[1];
-            Temp[0]=0x00;
-            Write_Internal(Temp, 1);
-        }
+            Global->Out_Plan.Zero(1);
     }
+}
 
-    if (Chunk.Header.Level==0 && Global->Out_Buffer_File_TryModification)
+//---------------------------------------------------------------------------
+bool Riff_Base::Write_InPlace ()
+{
+    //Real writing
+    Global->In.Close();
+    if (!Global->Out.Open(Global->File_Name, File::Access_Read_Write))
+        throw exception_write("Can not open input file in read/write mode");
+
+    //Space before the audio data, the file system moves the audio data and what is after it.
+    //Not crash safe: until the headers are written (with one call), the chunk sizes do not match the content.
+    if (Global->Out_Plan.Insert_Size && !Global->Out.Insert_Range(Global->Out_Plan.Insert_Offset, Global->Out_Plan.Insert_Size))
     {
-        //Testing if all is OK.
-        if (Global->data)
-        {
-            //Test if we can write over the file
-            Global->Out_Buffer_File_IsModified=true;
-            if (Global->Out_Buffer_End.Data && Global->data->File_Offset+Global->data->Size+Global->Out_Buffer_End.Size<Global->In.Size_Get())
-                Global->Out_Buffer_File_IsModified=false;
-            if (Global->Out_Buffer_Begin.Size!=Global->data->File_Offset)
-                Global->Out_Buffer_File_IsModified=false;
-        }
+        //Not supported, nothing is modified
+        Global->Out.Close();
+        if (!Global->In.Open(Global->File_Name))
+            throw exception_write("Can not open input file");
+        Global->Out_Plan.Insert_Cancel();
+        return false;
+    }
 
-        if (Global->Out_Buffer_File_IsModified)
-        {
-            //Real writing
-            Global->In.Close();
-            if (!Global->Out.Open(Global->File_Name, File::Access_Read_Write))
-                throw exception_write("Can not open input file in read/write mode");
+    //Chunks moved in the file are read before anything is overwritten
+    if (!Global->Out_Plan.Read_Copies(Global->Out))
+        throw exception_write(Global->Out_Plan.Insert_Size?"Can not read input file, file may be CORRUPTED":"Can not read input file");
 
-            //Begin
-            if (Global->Out_Buffer_Begin.Data)
-            {
-                if (Global->Out.Write(Global->Out_Buffer_Begin.Data, Global->Out_Buffer_Begin.Size)!=Global->Out_Buffer_Begin.Size)
-                    throw exception_write("Can not write input file, file may be CORRUPTED");
-            }
+    if (!Global->Out_Plan.Write_Memory(Global->Out))
+        throw exception_write("Can not write input file, file may be CORRUPTED");
 
-            //End
-            if (!Global->Out.GoTo(Global->data->File_Offset+Global->data->Size))
-                throw exception_write("Can not seek input file, file may be CORRUPTED");
+    //Cleanup
+    Global->Out.Close();
+    return true;
+}
 
-            if (Global->Out_Buffer_End.Data)
-            {
-                if (Global->Out.Write(Global->Out_Buffer_End.Data, Global->Out_Buffer_End.Size)!=Global->Out_Buffer_End.Size)
-                    throw exception_write("Can not write the file, file may be CORRUPTED");
-            }
+//---------------------------------------------------------------------------
+void Riff_Base::Write_Copy ()
+{
+    //Real writing
+    #ifdef MACSTORE
+    Global->Temp_Name=makeUniqueFileName();
+    Global->Temp_Path=makeTemporaryDirectoryForFile(Global->File_Name);
+
+    if (!Global->Out.Create(Global->Temp_Path+Global->Temp_Name, false))
+    #else
+    if (!Global->Out.Create(Global->File_Name+__T(".tmp"), false))
+    #endif
+        throw exception_write("Can not create temporary file");
+
+    if (!Global->Out_Plan.Write_Memory(Global->Out))
+        throw exception_write("Can not write temporary file");
+
+    //Copies, the audio data is hashed while copied if a digest was generated when parsing
+    global::digest Digest(*Global);
+    for (size_t Pos=0; Pos<Global->Out_Plan.Extents.size(); Pos++)
+        if (Global->Out_Plan.Extents[Pos].Kind==Riff_Write_Plan::extent::Kind_Copy)
+            Write_Copy_Extent(Global->Out_Plan.Extents[Pos], Pos==Global->Out_Plan.Data?&Digest:NULL);
+
+    //Cleanup
+    Global->In.Close();
+    Global->Out.Close();
+
+    //The original file is kept if the audio data changed since it was parsed
+    if (!Digest.Verify())
+    {
+        #ifdef MACSTORE
+        File::Delete(Global->Temp_Path+Global->Temp_Name);
+        #else
+        File::Delete(Global->File_Name+__T(".tmp"));
+        #endif
+        throw exception_write("audio data differs from the parsed one ("+Digest.Name+"), file not modified");
+    }
+    if (Digest.Kind!=global::digest::Kind_None)
+        Global->Out_Digest_Verified=Digest.Name;
+
+    //Renaming files
+    if (!File::Delete(Global->File_Name))
+        throw exception_write("Original file can't be deleted");
+    #ifdef MACSTORE
+    if (!File::Move(Global->Temp_Path+Global->Temp_Name, Global->File_Name))
+    #else
+    if (!File::Move(Global->File_Name+__T(".tmp"), Global->File_Name))
+    #endif
+        throw exception_write("Temporary file can't be renamed");
+
+    #ifdef MACSTORE
+    if (Global->Temp_Path.size() && Dir::Exists(Global->Temp_Path))
+        deleteTemporaryDirectory(Global->Temp_Path);
+
+    Global->Temp_Name=__T("");
+    Global->Temp_Path=__T("");
+    #endif
+}
 
-            //Cleanup
-            Global->Out.Close();
-        }
-        else
+//---------------------------------------------------------------------------
+void Riff_Base::Write_Copy_Extent (const Riff_Write_Plan::extent &Extent, global::digest* Digest)
+{
+    if (Digest && Digest->Kind==global::digest::Kind_None)
+        Digest=NULL;
+
+    //Shared by the file system (reflink) if supported, for the part aligned on blocks, the content must not be seen
+    int64u Block_Size=Global->Block_Size;
+    if (Digest==NULL && Extent.Source%Block_Size==Extent.Offset%Block_Size)
+    {
+        int64u Head=(Block_Size-Extent.Source%Block_Size)%Block_Size;
+        int64u Middle=Extent.Size>Head?(Extent.Size-Head)/Block_Size*Block_Size:0;
+        if (Middle)
         {
-            //Real writing
-            #ifdef MACSTORE
-            Global->Temp_Name=makeUniqueFileName();
-            Global->Temp_Path=makeTemporaryDirectoryForFile(Global->File_Name);
-
-            if (!Global->Out.Create(Global->Temp_Path+Global->Temp_Name, false))
-            #else
-            if (!Global->Out.Create(Global->File_Name+__T(".tmp"), false))
-            #endif
-                throw exception_write("Can not create temporary file");
-
-            //Begin
-            if (Global->Out_Buffer_Begin.Data)
+            Write_Copy_Range(Extent.Source, Extent.Offset, Head, NULL);
+            if (Global->Out.Clone_Range_From(Global->In, Extent.Source+Head, Middle, Extent.Offset+Head)==Middle)
             {
-                if (Global->Out.Write(Global->Out_Buffer_Begin.Data, Global->Out_Buffer_Begin.Size)!=Global->Out_Buffer_Begin.Size)
-                    throw exception_write("Can not write temporary file");
+                Global->Out_Plan.Cloned_Size+=Middle;
+                Global->Progress->Done_Set(Extent.Source+Head+Middle);
+                Write_Copy_Range(Extent.Source+Head+Middle, Extent.Offset+Head+Middle, Extent.Size-Head-Middle, NULL);
             }
+            else
+                Write_Copy_Range(Extent.Source+Head, Extent.Offset+Head, Extent.Size-Head, NULL);
+            return;
+        }
+    }
 
-            //Middle
-            bool Out_Buffer_File_TryModification_Temp=Global->Out_Buffer_File_TryModification;
-            int64u Chunk_Content_Size_Temp=Chunk.Content.Size;
-            Global->Out_Buffer_File_TryModification=false;
-            Chunk.File_In_Position=Global->data->File_Offset-Chunk.Header.Size;
-            if (!Global->In.GoTo(Chunk.File_In_Position))
-                throw exception_write("Can not seek input file");
-            Chunk.Content.Size=Global->data->Size;
-            Write_Internal(); //We use the already made method, with some configuring before and after
-            Global->Out_Buffer_File_TryModification=Out_Buffer_File_TryModification_Temp;
-            Chunk.Content.Size=Chunk_Content_Size_Temp;
-
-            //End
-            if (Global->Out_Buffer_End.Data)
-            {
-                if (Global->Out.Write(Global->Out_Buffer_End.Data, Global->Out_Buffer_End.Size)!=Global->Out_Buffer_End.Size)
-                    throw exception_write("Can not write temporary file");
-            }
+    Write_Copy_Range(Extent.Source, Extent.Offset, Extent.Size, Digest);
+}
+
+//---------------------------------------------------------------------------
+void Riff_Base::Write_Copy_Range (int64u Source, int64u Offset, int64u Size, global::digest* Digest)
+{
+    int64u Copied=0;
 
-            //Cleanup
-            Global->In.Close();
-            Global->Out.Close();
-
-            //Renaming files
-            if (!File::Delete(Global->File_Name))
-                throw exception_write("Original file can't be deleted");
-            #ifdef MACSTORE
-            if (!File::Move(Global->Temp_Path+Global->Temp_Name, Global->File_Name))
-            #else
-            if (!File::Move(Global->File_Name+__T(".tmp"), Global->File_Name))
-            #endif
-                throw exception_write("Temporary file can't be renamed");
-
-            #ifdef MACSTORE
-            if (Global->Temp_Path.size() && Dir::Exists(Global->Temp_Path))
-                deleteTemporaryDirectory(Global->Temp_Path);
-
-            Global->Temp_Name=__T("");
-            Global->Temp_Path=__T("");
-            #endif
+    //Copied by the system if the content does not need to be seen, by parts for the progress
+    if (Digest==NULL)
+        while (Copied<Size)
+        {
+            int64u ToCopy=Size-Copied>RIFF_Copy_Size?RIFF_Copy_Size:(Size-Copied);
+            int64u Result=Global->Out.Copy_Range_From(Global->In, Source+Copied, ToCopy, Offset+Copied);
+            Copied+=Result;
+            Global->Progress->Done_Set(Source+Copied);
+            if (Global->Progress->Canceling)
+                throw exception_canceled();
+            if (Result<ToCopy)
+                break; //Not supported, the remaining part is copied through a buffer
+        }
+
+    //Copied through a buffer
+    if (Copied<Size)
+    {
+        vector<int8u> Buffer((size_t)(Size-Copied>RIFF_Copy_Buffer_Size?RIFF_Copy_Buffer_Size:(Size-Copied)));
+        const int8u* Buffers[1]={&Buffer[0]};
+        while (Copied<Size)
+        {
+            size_t ToCopy=Size-Copied>Buffer.size()?Buffer.size():(size_t)(Size-Copied);
+            size_t BytesRead=Global->In.Read_At(&Buffer[0], ToCopy, Source+Copied);
+            if (BytesRead==0)
+                throw exception_write("Can not read input file");
+            if (Digest)
+                Digest->Update(&Buffer[0], BytesRead);
+            if (Global->Out.Write_At(Buffers, &BytesRead, 1, Offset+Copied)!=BytesRead)
+                throw exception_write("Can not write temporary file");
+            Copied+=BytesRead;
+            Global->Progress->Done_Set(Source+Copied);
+            if (Global->Progress->Canceling)
+                throw exception_canceled();
         }
     }
 }
@@ -648,112 +949,67 @@ void Riff_Base::Read_Internal ()
 //---------------------------------------------------------------------------
 void Riff_Base::Write_Internal ()
 {
-    Global->In.GoTo(Chunk.File_In_Position+Chunk.Header.Size);
-    
-    int8u Temp[32768];
-    while(Global->In.Position_Get()<Chunk.File_In_Position+Chunk.Header.Size+Chunk.Content.Size)
-    {
-        //Reading
-        size_t Temp_Offset=0;
-        while(Temp_Offset<32768)
-        {
-            size_t BytesRead=Global->In.Read(Temp+Temp_Offset, (Chunk.File_In_Position+Chunk.Header.Size+Chunk.Content.Size-Global->In.Position_Get()>32768)?32768:(size_t)(Chunk.File_In_Position+Chunk.Header.Size+Chunk.Content.Size-Global->In.Position_Get()));
-            if (BytesRead==0)
-                break; //Read is finished
-            Global->CS.Enter();
-            Global->Progress=(float)Global->In.Position_Get()/Global->In.Size_Get();
-            if (Global->Canceling)
-            {
-                Global->CS.Leave();
-                throw exception_canceled();
-            }
-            Global->CS.Leave();
-            //SleeperThread::msleep(20);
-            Temp_Offset+=BytesRead;
-        }
-
-        Write_Internal(Temp, Temp_Offset);
-    }
+    Global->Out_Plan.Copy(Chunk.File_In_Position+Chunk.Header.Size, Chunk.Content.Size);
 }
 
 //---------------------------------------------------------------------------
-void Riff_Base::Write_Internal (const int8u* Temp, size_t Temp_Offset)
+void Riff_Base::Write_Internal (const int8u* Buffer, size_t Buffer_Size)
 {
-        //Writing
-        if (Global->Out_Buffer_File_TryModification)
-        {
-            if (!Global->Out_Buffer_WriteAtEnd)
-            {
-                if (Global->Out_Buffer_Begin.Data==NULL)
-                {
-                    if (Global->data==NULL)
-                        throw exception_write(); //TODO: change it
-                    Global->Out_Buffer_Begin.Size_Maximum=(size_t)Global->data->File_Offset;
-                    Global->Out_Buffer_Begin.Data=new int8u[Global->Out_Buffer_Begin.Size_Maximum];
-                }
-
-                if (Global->Out_Buffer_Begin.Size+Temp_Offset>Global->Out_Buffer_Begin.Size_Maximum)
-                {
-                    //Increasing the buffer size
-                    Global->Out_Buffer_Begin.Size_Maximum+=Temp_Offset;
-                    Global->Out_Buffer_Begin.Size_Maximum*=2;
-                    int8u* Buffer_New=new int8u[Global->Out_Buffer_Begin.Size_Maximum];
-                    memcpy(Buffer_New, Global->Out_Buffer_Begin.Data, Global->Out_Buffer_Begin.Size);
-                    delete[] Global->Out_Buffer_Begin.Data; Global->Out_Buffer_Begin.Data=Buffer_New;
-                }
+    Global->Out_Plan.New(Buffer, Buffer_Size);
+}
 
-                memcpy(Global->Out_Buffer_Begin.Data+Global->Out_Buffer_Begin.Size, Temp, Temp_Offset);
-                Global->Out_Buffer_Begin.Size+=Temp_Offset;
-            }
-            else
-            {
-                if (Global->Out_Buffer_End.Data==NULL)
-                {
-                    if (Global->data==NULL)
-                        throw exception_write(); //TODO: change it
-                    Global->Out_Buffer_End.Size_Maximum=(size_t)(Global->In.Size_Get()-(Global->data->File_Offset+Global->data->Size));
-                    Global->Out_Buffer_End.Data=new int8u[Global->Out_Buffer_End.Size_Maximum];
-                }
+//---------------------------------------------------------------------------
+void Riff_Base::Write_Internal_Subs ()
+{
+    //Parsing subs
+    for (size_t Pos=0; Pos<Subs.size(); Pos++)
+        Subs[Pos]->Write_Plan_Chunk();
+}
 
-                if (Global->Out_Buffer_End.Size+Temp_Offset>Global->Out_Buffer_End.Size_Maximum)
-                {
-                    //Increasing the buffer size
-                    Global->Out_Buffer_End.Size_Maximum+=Temp_Offset;
-                    Global->Out_Buffer_End.Size_Maximum*=2;
-                    int8u* Buffer_New=new int8u[Global->Out_Buffer_End.Size_Maximum];
-                    memcpy(Buffer_New, Global->Out_Buffer_End.Data, Global->Out_Buffer_End.Size);
-                    delete[] Global->Out_Buffer_End.Data; Global->Out_Buffer_End.Data=Buffer_New;
-                }
+//---------------------------------------------------------------------------
+void Riff_Base::Write_Commit (int64u &Offset)
+{
+    //Same order as Write_Plan_Chunk()
+    bool Subs_AreWritten=Chunk.Content.IsModified && !Subs.empty();
+    if (Chunk.Header.Level)
+    {
+        if (!Subs_AreWritten)
+            Write_Commit_Move(Offset-Chunk.File_In_Position);
+        Chunk.File_In_Position=Offset;
+        Chunk.Header.Size=Chunk.Header.List==0x00000000?8:12;
+        Offset+=Chunk.Header.Size;
+    }
 
-                memcpy(Global->Out_Buffer_End.Data+Global->Out_Buffer_End.Size, Temp, Temp_Offset);
-                Global->Out_Buffer_End.Size+=Temp_Offset;
-            }
-        }
-        else
-        {
-            if (!Global->Out.Opened_Get())
-            {
-                #ifdef MACSTORE
-                Global->Temp_Name=makeUniqueFileName();
-                Global->Temp_Path=makeTemporaryDirectoryForFile(Global->File_Name);
-                if (!Global->Out.Create(Global->Temp_Path+Global->Temp_Name))
-                    throw exception_write(Ztring(Global->Temp_Path+Global->Temp_Name).To_UTF8()+": temporary file can not be created");
-                #else
-                if (!Global->Out.Create(Global->File_Name+__T(".tmp")))
-                    throw exception_write(Global->File_Name.To_UTF8()+": temporary file can not be created");
-                #endif
-            }
-            if (Global->Out.Write(Temp, Temp_Offset)<Temp_Offset)
-                throw exception_write();
-        }
+    //Content
+    if (Subs_AreWritten)
+    {
+        int64u Content_Offset=Offset;
+        for (size_t Pos=0; Pos<Subs.size(); Pos++)
+            Subs[Pos]->Write_Commit(Offset);
+        Chunk.Content.Size=Offset-Content_Offset;
+    }
+    else
+        Offset+=Chunk.Content.Size+Chunk.Content.Size%2;
+    Chunk.Content.IsModified=false;
+    Chunk.Content.Size_IsModified=false;
+
+    //Positions known by the other chunks
+    if (Chunk.Header.Level==1 && Global->WAVE)
+        Global->WAVE->Size_Original=Chunk.Content.Size;
+    if (Chunk.Header.Level==2 && Chunk.Header.Name==Elements::WAVE_data && Global->data)
+        Global->data->File_Offset=Chunk.File_In_Position+Chunk.Header.Size;
+    if (Chunk.Header.Level==0)
+        Global->File_Size=Offset;
 }
 
 //---------------------------------------------------------------------------
-void Riff_Base::Write_Internal_Subs ()
+void Riff_Base::Write_Commit_Move (int64s Delta)
 {
-    //Parsing subs
     for (size_t Pos=0; Pos<Subs.size(); Pos++)
-        Subs[Pos]->Write();
+    {
+        Subs[Pos]->Chunk.File_In_Position+=Delta;
+        Subs[Pos]->Write_Commit_Move(Delta);
+    }
 }
 
 //***************************************************************************
@@ -773,11 +1029,16 @@ int64u Riff_Base::Block_Size_Get ()
     for (size_t Pos=0; Pos<Subs.size(); Pos++)
     {
         if (Pos+1<Subs.size() && Subs[Pos]->Chunk.Header.Name==Elements::WAVE_FLLR && Subs[Pos+1]->Chunk.Header.Name==Elements::WAVE_data)
+        {
+            delete Subs[Pos];
             Subs.erase(Subs.begin()+Pos);
+        }
         if (Pos>0 && Chunk.Header.Name==Elements::WAVE && Subs[Pos]->Chunk.Header.Name==Elements::WAVE_data && Subs[Pos-1]->Chunk.Header.Name!=Elements::WAVE_FLLR)
         {
             //Padding if we can
-            if (12+Size+8+8<=Global->data->File_Offset || Size>Global->data->File_Offset)
+            int64u Reserve=Reserve_Get(12+Size+8); //WAVE Header + Size + data header
+            bool Reserve_IsMissing=Global->ReserveOnly && 12+Size+8+Reserve+8>Global->data->File_Offset;
+            if (12+Size+8+8<=Global->data->File_Offset || Size>Global->data->File_Offset || Reserve_IsMissing)
             {
                 if (Subs[Pos]->Chunk.Header.Name!=Elements::WAVE_FLLR)
                     Subs.insert(Subs.begin()+Pos, new Riff_WAVE_FLLR(Global));
@@ -785,15 +1046,18 @@ int64u Riff_Base::Block_Size_Get ()
                 Subs[Pos]->Chunk.Header.Name=Elements::WAVE_FLLR;
                 if (12+Size+8+8<=Global->data->File_Offset)
                     Subs[Pos]->Chunk.Content.Size=Global->data->File_Offset-(12+Size+8+8); //WAVE Header + Size + FLLR header + data header
-                if (Size>Global->data->File_Offset)
-                    Subs[Pos]->Chunk.Content.Size=RIFF_WAVE_FLLR_DefaultSise; //Additional padding of RIFF_WAVE_FLLR_DefaultSise.
-                Subs[Pos]->Chunk.Content.Buffer=new int8u[(size_t)Subs[Pos]->Chunk.Content.Size];
-                memset(Subs[Pos]->Chunk.Content.Buffer, 0x00, (size_t)Subs[Pos]->Chunk.Content.Size);
-                Subs[Pos]->Chunk.Content.IsModified=true;
+                if (Size>Global->data->File_Offset || Reserve_IsMissing)
+                {
+                    //Additional padding of the reserve, and up to the block size for keeping the audio data at the same place in a block (so it can be shared by the file system)
+                    int64u Data_Offset=12+Size+8+Reserve+8; //WAVE Header + Size + FLLR header + FLLR + data header
+                    Subs[Pos]->Chunk.Content.Size=Reserve+(Global->data->File_Offset+Global->Block_Size-Data_Offset%Global->Block_Size)%Global->Block_Size;
+                }
+                Subs[Pos]->Chunk.Content.IsModified=true; //Written as zeroes, no buffer
                 Subs[Pos]->Chunk.Content.Size_IsModified=true;
             }
             else if (Subs[Pos]->Chunk.Header.Name==Elements::WAVE_FLLR)
             {
+                delete Subs[Pos];
                 Subs.erase(Subs.begin()+Pos);
                 if (Pos>=Subs.size())
                     break;
@@ -811,9 +1075,7 @@ int64u Riff_Base::Block_Size_Get ()
                     Subs[Pos+1]->Chunk.Content.Size=Global->WAVE->Size_Original-(Size+Subs[Pos]->Block_Size_Get()+8); //Size + FLLR header
                 else
                     Subs[Pos+1]->Chunk.Content.Size=0;
-                Subs[Pos+1]->Chunk.Content.Buffer=new int8u[(size_t)Subs[Pos+1]->Chunk.Content.Size];
-                memset(Subs[Pos+1]->Chunk.Content.Buffer, 0x00, (size_t)Subs[Pos+1]->Chunk.Content.Size);
-                Subs[Pos+1]->Chunk.Content.IsModified=true;
+                Subs[Pos+1]->Chunk.Content.IsModified=true; //Written as zeroes, no buffer
                 Subs[Pos+1]->Chunk.Content.Size_IsModified=true;
             }
 
@@ -833,6 +1095,63 @@ int64u Riff_Base::Block_Size_Get (int32u Element)
     return Subs[Pos]->Block_Size_Get();
 }
 
+//---------------------------------------------------------------------------
+int64u Riff_Base::Reserve_Get (int64u Header_Size)
+{
+    switch (Global->Reserve_Kind)
+    {
+        case RIFF_Reserve_Percent :
+            return Header_Size*Global->Reserve_Value/100;
+        case RIFF_Reserve_XML :
+        {
+            //Growth of iXML and XMP up to the wanted size, if they are before the audio data (new ones are at the end)
+            int64u Reserve=0;
+            size_t data_Pos=Subs_Pos_Get(Elements::WAVE_data);
+            const int32u Names[]={Elements::WAVE_iXML, Elements::WAVE__PMX};
+            for (size_t Name_Pos=0; Name_Pos<sizeof(Names)/sizeof(int32u); Name_Pos++)
+            {
+                size_t Pos=Subs_Pos_Get(Names[Name_Pos]);
+                if (Pos==(size_t)-1 || Pos>data_Pos)
+                    continue;
+                if (Subs[Pos]->Chunk.Content.Size<Global->Reserve_Value*1024)
+                    Reserve+=Global->Reserve_Value*1024-Subs[Pos]->Chunk.Content.Size;
+            }
+            return Reserve;
+        }
+        default :
+            return Global->Reserve_Value;
+    }
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Base::Reserve_Force ()
+{
+    size_t WAVE_Pos=Subs_Pos_Get(Elements::WAVE);
+    if (Global->data==NULL || WAVE_Pos==(size_t)-1)
+        return false;
+    Riff_Base* WAVE=Subs[WAVE_Pos];
+
+    //Size of the header, without the padding before the audio data
+    int64u Size=0;
+    for (size_t Pos=0; Pos<WAVE->Subs.size(); Pos++)
+    {
+        if (WAVE->Subs[Pos]->Chunk.Header.Name==Elements::WAVE_data)
+            break;
+        if (WAVE->Subs[Pos]->Chunk.Header.Name==Elements::WAVE_FLLR && Pos+1<WAVE->Subs.size() && WAVE->Subs[Pos+1]->Chunk.Header.Name==Elements::WAVE_data)
+            break;
+        Size+=WAVE->Subs[Pos]->Block_Size_Get();
+    }
+    if (12+Size+8+WAVE->Reserve_Get(12+Size+8)+8<=Global->data->File_Offset)
+        return false;
+
+    //The audio data moves when writing
+    WAVE->Chunk.Content.IsModified=true;
+    WAVE->Chunk.Content.Size_IsModified=true;
+    Chunk.Content.IsModified=true;
+    Chunk.Content.Size_IsModified=true;
+    return true;
+}
+
 //---------------------------------------------------------------------------
 size_t Riff_Base::Subs_Pos_Get (int32u Element)
 {
@@ -17,16 +17,30 @@
 #include "ZenLib/Ztring.h"
 #include "ZenLib/File.h"
 #include "ZenLib/CriticalSection.h"
+#include "Riff/Riff_Write_Plan.h"
 #include <vector>
 #include <map>
 #include <sstream>
+#include <atomic>
 using namespace ZenLib;
 using namespace std;
+class Riff_Hash_Cache;
 //---------------------------------------------------------------------------
 
 //---------------------------------------------------------------------------
 const int64u RIFF_Size_Limit=0xFFFFFFFF; //Limit about when we implement ds64
-const int64u RIFF_WAVE_FLLR_DefaultSise=16*1024; //Default size of FLLR at the beginning of a file
+const int64u RIFF_WAVE_FLLR_DefaultSise=16*1024; //Default reserve, size of FLLR before the audio data when it moves
+const size_t RIFF_Prefetch_Size=64*1024; //Size of the window read at once for header parsing, if the file is not mapped
+const int64u RIFF_Copy_Size=16*1024*1024; //Size copied by the system between two progress updates
+const size_t RIFF_Copy_Buffer_Size=1024*1024; //Size of the buffer for copies, if the system can not copy
+const int64u RIFF_Block_Alignment=4096; //Block size of file systems if unknown, for sharing the audio data between the file and its copy or for inserting space before it
+const int64u RIFF_Block_Alignment_Max=64*1024; //More is not a block size, the default one is used
+enum riff_reserve //Policy for the size of FLLR when the audio data moves, so next modifications are in place
+{
+    RIFF_Reserve_Size,      //Bytes
+    RIFF_Reserve_Percent,   //Of the header (everything before the audio data)
+    RIFF_Reserve_XML,       //KiB up to which iXML and XMP can grow
+};
 const vector<wchar_t> ISO_8859_2=
 {
     0x00A0,0x0104,0x02D8,0x0141,0x00A4,0x013D,
@@ -111,6 +125,13 @@ enum Riff_Encoding
     Encoding_Max,
 };
 
+enum Riff_Hash
+{
+    Hash_XXH3       =1<<0,
+    Hash_SHA256     =1<<1,
+    Hash_BLAKE3     =1<<2,
+};
+
 //***************************************************************************
 // Exceptions
 //***************************************************************************
@@ -186,6 +207,36 @@ public:
     // Structures
     //***************************************************************************
 
+    //---------------------------------------------------------------------------
+    //Progress and cancellation, lock-free because updated for each block read and polled from other threads
+    struct progress
+    {
+        std::atomic<int64u> Done; //In bytes
+        std::atomic<int64u> Total; //In bytes
+        std::atomic<bool>   Canceling;
+        progress*           Parent; //Aggregated progress of several files, or NULL
+
+        progress() : Done(0), Total(0), Canceling(false), Parent(NULL) {}
+
+        void Done_Set(int64u Value)
+        {
+            int64u Previous=Done.exchange(Value);
+            if (Parent)
+                Parent->Done+=Value-Previous; //Modulo arithmetic, also valid when going back
+        }
+
+        float Get() const
+        {
+            int64u Total_Current=Total;
+            if (!Total_Current)
+                return 0;
+            int64u Done_Current=Done;
+            if (Done_Current>=Total_Current)
+                return 1;
+            return (float)Done_Current/Total_Current;
+        }
+    };
+
     //---------------------------------------------------------------------------
     //Global structure for handling common data
     struct global
@@ -205,11 +256,30 @@ public:
         {
             int64u          File_Offset;
             int64u          Size;
+            int64u          Hash_Duration; //In microseconds, 0 if not hashed
+            bool            Hash_Cached; //Digests from the digest cache
+            bool            Hash_Cache_Verified; //Digests hashed again and compared to the digest cache
+            string          Hash_Cache_Mismatch; //Names of the digests differing from the digest cache
+            int64u          Fixity_Resumed; //Bytes not hashed again thanks to the fixity index
+            size_t          Fixity_Segments; //Count of segments in the fixity index
+            string          Fixity_Damaged; //Byte ranges differing from the fixity index
+            string          Fixity_Error; //Fixity index not written or not verified
+            map<string, string> Loudness; //Measured values, key is the bext field name (e.g. LoudnessValue)
+            string          Loudness_Error; //Loudness not measured
+            vector<string>  Levels; //Measured values, one line per channel then the silence
+            string          Levels_Error; //Levels not measured
+            vector<pair<int64u, int64u> > Silences; //Start and length in frames, in order
+            string          Silences_Error; //Silences not detected
 
             chunk_data()
             {
                 File_Offset=(int64u)-1;
                 Size=(int64u)-1;
+                Hash_Duration=0;
+                Hash_Cached=false;
+                Hash_Cache_Verified=false;
+                Fixity_Resumed=0;
+                Fixity_Segments=0;
             }
         };
         struct chunk_ds64
@@ -350,25 +420,43 @@ public:
             map<string, string> Strings;
             map<string, ZtringList> Histories;
         };
-        struct buffer
+        struct mapping
+        {
+            int8u*  Data; //NULL if In is not mapped
+            int64u  Size;
+
+            mapping()
+            {
+                Data=NULL;
+                Size=0;
+            }
+        };
+
+        struct prefetch
         {
             int8u*  Data;
+            int64u  Offset; //File offset of Data
             size_t  Size;
-            size_t  Size_Maximum;
+            int64u  Count_Memory; //Reads served from Data
+            int64u  Count_Fill; //Reads of the file for filling Data
 
-            buffer()
+            prefetch()
             {
                 Data=NULL;
+                Offset=0;
                 Size=0;
-                Size_Maximum=0;
+                Count_Memory=0;
+                Count_Fill=0;
             }
         };
 
         File                In;
+        mapping             In_Map; //Private view of In, chunk buffers may point into it
+        prefetch            In_Prefetch; //Read-ahead window of In, if In is not mapped
         File                Out;
-        buffer              Out_Buffer_Begin;
-        buffer              Out_Buffer_End;
-        bool                Out_Buffer_WriteAtEnd;
+        Riff_Write_Plan     Out_Plan; //Of the last write
+        struct digest;
+        string              Out_Digest_Verified; //Name of the digest the copied audio data matches
 
         #ifdef MACSTORE
         Ztring              Temp_Path;
@@ -393,6 +481,7 @@ public:
         chunk_strings      *cuexml;
         chunk_strings      *MD5Stored;
         chunk_strings      *MD5Generated;
+        chunk_strings      *HashesGenerated;
         chunk_cue_         *cue_;
         chunk_adtl         *adtl;
         bool                CSET_Present;
@@ -400,20 +489,32 @@ public:
         bool                NoPadding_IsCorrected;
         bool                RF64DataSize_IsCorrected;
         bool                NewChunksAtTheEnd;
+        bool                InsertRange; //Space may be inserted before the audio data instead of copying the file, not crash safe
+        int64u              Block_Size; //Of the file system of the file
+        int8u               Reserve_Kind; //riff_reserve
+        int64u              Reserve_Value;
+        bool                ReserveOnly; //The audio data moves if the padding before it is smaller than the reserve
         bool                GenerateMD5;
+        int8u               GenerateHashes; //Riff_Hash flags
+        Riff_Hash_Cache*    Hash_Cache; //Owned by the core, NULL if none
+        bool                FixityIndex; //A digest per segment of the audio data is written in a sidecar file
+        bool                FixityVerify;
+        int64u              Fixity_Segment_Size;
+        bool                ComputeLoudness; //EBU R 128 loudness of the audio data, for the bext v2 fields
+        bool                ComputeLevels; //Peak, RMS, DC offset, clipping and silence of the audio data
+        int8u               Peak_Kernel; //Riff_Peak::kernel, Kernel_Auto for the widest one supported
+        bool                DetectSilences; //Leading, trailing silences and gaps of the audio data, as cue points
+        float64             Silence_Threshold; //dBFS, also for the levels
+        float64             Silence_Duration; //Seconds
         bool                VerifyMD5;
         bool                VerifyMD5_Force;
         bool                EmbedMD5;
         bool                EmbedMD5_AuthorizeOverWritting;
-        bool                Out_Buffer_File_TryModification;
-        bool                Out_Buffer_File_IsModified;
         bool                IsRF64;
         bool                Trace_UseDec;
         bool                Read_Only;
 
-        CriticalSection     CS;
-        float               Progress;
-        bool                Canceling;
+        progress*           Progress; //Owned by the handler
 
         global()
         {
@@ -433,28 +534,48 @@ public:
             cuexml=NULL;
             MD5Stored=NULL;
             MD5Generated=NULL;
+            HashesGenerated=NULL;
             CSET_Present=false;
             NoPadding_Accept=false;
             NoPadding_IsCorrected=false;
             RF64DataSize_IsCorrected=false;
             NewChunksAtTheEnd=false;
+            InsertRange=false;
+            Block_Size=RIFF_Block_Alignment;
+            Reserve_Kind=RIFF_Reserve_Size;
+            Reserve_Value=RIFF_WAVE_FLLR_DefaultSise;
+            ReserveOnly=false;
             GenerateMD5=false;
+            GenerateHashes=0;
+            Hash_Cache=NULL;
+            FixityIndex=false;
+            FixityVerify=false;
+            Fixity_Segment_Size=0;
+            ComputeLoudness=false;
+            ComputeLevels=false;
+            Peak_Kernel=0;
+            DetectSilences=false;
+            Silence_Threshold=0;
+            Silence_Duration=0;
             VerifyMD5=false;
             VerifyMD5_Force=false;
             EmbedMD5=false;
             EmbedMD5_AuthorizeOverWritting=false;
-            Out_Buffer_WriteAtEnd=false;
-            Out_Buffer_File_TryModification=true;
-            Out_Buffer_File_IsModified=false;
             IsRF64=false;
             Trace_UseDec=false;
             Read_Only=false;
-            Progress=0;
-            Canceling=false;
+            Progress=NULL;
         }
 
+        bool   In_Map_Open();
+        void   In_Map_Close();
+        void   In_Prefetch_Clear();
+        size_t In_Read(int8u* Buffer, size_t Buffer_Size);
+
         ~global()
         {
+            In_Map_Close();
+            In_Prefetch_Clear();
             delete ds64; //ds64=NULL;
             delete fmt_; //fmt_=NULL;
             delete bext; //bext=NULL;
@@ -466,6 +587,7 @@ public:
             delete cue_; //cue_=NULL;
             delete adtl; //adtl=NULL;
             delete cuexml; //cuexml=NULL;
+            delete HashesGenerated; //HashesGenerated=NULL;
         }
     };
 
@@ -491,6 +613,7 @@ public:
         struct content
         {
             int8u*  Buffer;
+            bool    Buffer_IsMapped; //Buffer is in Global->In_Map, not owned
             size_t  Buffer_Offset; //Internal use
             int64u  Size; //Header excluded
             bool    IsModified;
@@ -500,6 +623,7 @@ public:
             content()
             {
                 Buffer=NULL;
+                Buffer_IsMapped=false;
                 Buffer_Offset=0;
                 Size=0;
                 IsModified=false;
@@ -509,7 +633,8 @@ public:
 
             ~content()
             {
-                delete[] Buffer; //Buffer=NULL;
+                if (!Buffer_IsMapped)
+                    delete[] Buffer; //Buffer=NULL;
             }
         };
 
@@ -538,12 +663,17 @@ public:
     void Modify                 (int32u Chunk_Name_1, int32u Chunk_Name_2, int32u Chunk_Name_3);
     void Modify                 ()                                              {Modify_Internal();};
     void Write                  ();
+    void Write_Plan             (); //Global->Out_Plan, nothing is written
+    void Write_Commit           (int64u &Offset); //After a write, the chunks are the ones written, Offset is the size of the file
+    void Map_Close              (); //Chunk content is copied from the mapped file, then the file is unmapped
 
     //---------------------------------------------------------------------------
     //Data
     int64u Block_Size_Get       ();
     int64u Block_Size_Get       (int32u Element);
     size_t Subs_Pos_Get         (int32u Element);
+    int64u Reserve_Get          (int64u Header_Size); //Of the WAVE chunk
+    bool   Reserve_Force        (); //Modified if the reserve is missing
     bool   Read_Header          (chunk &NewChunk);
     bool   IsModified           ()                                              {return Chunk.Content.IsModified;};
     void   IsModified_Clear     ()                                              {Chunk.Content.IsModified=false;};
@@ -561,8 +691,9 @@ protected :
     virtual void    Read_Internal       ();
     virtual void    Modify_Internal     ()                                      {}
     virtual size_t  Insert_Internal     (int32u)                                {return Subs.size();}
-    virtual void    Write_Internal      ()                                      ;
-    void            Write_Internal      (const int8u* Buffer, size_t Buffer_Size);
+    virtual void    Write_Internal      ()                                      ; //Copy of the content from the input file
+    void            Write_Internal      (const int8u* Buffer, size_t Buffer_Size); //Buffer must stay valid until the plan is executed
+    void            Map_Detach          ();
 
     //***************************************************************************
     // Buffer handling (buffer read/write)
@@ -627,6 +758,12 @@ protected :
     void Read_Internal_ReadAllInBuffer  ();
     void Modify_Internal_Subs           (int32u Chunk_Name_0, int32u Chunk_Name_1, int32u Chunk_Name_2);
     void Write_Internal_Subs            ();
+    void Write_Plan_Chunk               ();
+    bool Write_InPlace                  (); //False if space can not be inserted, nothing is written
+    void Write_Copy                     ();
+    void Write_Copy_Extent              (const Riff_Write_Plan::extent &Extent, global::digest* Digest);
+    void Write_Copy_Range               (int64u Source, int64u Offset, int64u Size, global::digest* Digest);
+    void Write_Commit_Move              (int64s Delta);
 
     //***************************************************************************
     // Data
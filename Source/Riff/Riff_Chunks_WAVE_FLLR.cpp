@@ -37,6 +37,9 @@ void Riff_WAVE_FLLR::Modify_Internal ()
 //---------------------------------------------------------------------------
 void Riff_WAVE_FLLR::Write_Internal ()
 {
-    Riff_Base::Write_Internal(Chunk.Content.Buffer, (size_t)Chunk.Content.Size);
+    if (Chunk.Content.IsModified)
+        Global->Out_Plan.Zero(Chunk.Content.Size); //Padding, zeroes
+    else
+        Riff_Base::Write_Internal();
 }
 
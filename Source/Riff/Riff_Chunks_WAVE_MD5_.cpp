@@ -10,6 +10,7 @@
 //---------------------------------------------------------------------------
 #include "Riff/Riff_Chunks.h"
 #include <cstring>
+#include <iomanip>
 //---------------------------------------------------------------------------
 
 //***************************************************************************
@@ -30,10 +31,10 @@ void Riff_WAVE_MD5_::Read_Internal ()
     int128u MD5Stored;
     Get_L16   (     MD5Stored);
 
+    ostringstream MD5StoredS; //Not int128u::toString(), its buffer is shared between threads
+    MD5StoredS<<hex<<uppercase<<setfill('0')<<setw(16)<<MD5Stored.hi<<setw(16)<<MD5Stored.lo; //Padding with 0, this must be a 32-byte string
     Global->MD5Stored=new Riff_Base::global::chunk_strings;
-    Global->MD5Stored->Strings["md5stored"]=Ztring().From_Number(MD5Stored, 16).To_UTF8();
-    while (Global->MD5Stored->Strings["md5stored"].size()<32)
-        Global->MD5Stored->Strings["md5stored"].insert(Global->MD5Stored->Strings["md5stored"].begin(), '0'); //Padding with 0, this must be a 32-byte string    
+    Global->MD5Stored->Strings["md5stored"]=MD5StoredS.str();
 }
 
 //***************************************************************************
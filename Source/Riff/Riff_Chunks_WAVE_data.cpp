@@ -9,17 +9,737 @@
 
 //---------------------------------------------------------------------------
 #include "Riff/Riff_Chunks.h"
+#include "Riff/Riff_Hash_Cache.h"
+#include "Riff/Riff_Fixity_Index.h"
+#include "Riff/Riff_Loudness.h"
+#include "Riff/Riff_Levels.h"
+#include "Riff/Riff_Silence.h"
 extern "C"
 {
 #include "MD5/md5.h"
+#include "MD5/md5_multi.h"
+#include "Hash/xxh3.h"
+#include "Hash/sha256.h"
+#include "Hash/blake3.h"
 }
 #include "ZenLib/Utils.h"
+#include "ZenLib/Thread.h"
+#include <iomanip>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <thread>
 //---------------------------------------------------------------------------
 
+//***************************************************************************
+// Reader
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+//Ring of buffers filled by a thread while the previous ones are analyzed
+const size_t data_Ring_Count=4;
+const size_t data_Ring_Size=4*1024*1024;
+
+class data_reader : public Thread
+{
+public:
+    int8u*              Buffers[data_Ring_Count];
+    size_t              Sizes[data_Ring_Count];
+    std::atomic<size_t> Filled; //Count of buffers filled since the start
+    std::atomic<size_t> Consumed; //Count of buffers released by all the analyzers since the start
+    std::atomic<bool>   Ended; //No more buffer will be filled
+    std::atomic<bool>   Stop;
+
+    data_reader(File &In_, int64u Offset_, int64u Size_) : Filled(0), Consumed(0), Ended(false), Stop(false), In(In_), Offset(Offset_), Size(Size_)
+    {
+        for (size_t Pos=0; Pos<data_Ring_Count; Pos++)
+            Buffers[Pos]=NULL;
+        try
+        {
+            for (size_t Pos=0; Pos<data_Ring_Count; Pos++)
+                Buffers[Pos]=new int8u[data_Ring_Size];
+        }
+        catch(...)
+        {
+            for (size_t Pos=0; Pos<data_Ring_Count; Pos++)
+                delete[] Buffers[Pos];
+            throw;
+        }
+    }
+
+    ~data_reader()
+    {
+        for (size_t Pos=0; Pos<data_Ring_Count; Pos++)
+            delete[] Buffers[Pos];
+    }
+
+    void Entry()
+    {
+        int64u Done=0;
+        while (Done<Size && !Stop)
+        {
+            //Waiting for a free buffer
+            if (Filled-Consumed>=data_Ring_Count)
+            {
+                Sleep(1);
+                continue;
+            }
+
+            size_t Pos=Filled%data_Ring_Count;
+            size_t ToRead=Size-Done>data_Ring_Size?data_Ring_Size:(size_t)(Size-Done);
+            Sizes[Pos]=In.Read_At(Buffers[Pos], ToRead, Offset+Done); //Positional, the caller does not use In meanwhile
+            Done+=Sizes[Pos];
+            Filled++;
+            if (Sizes[Pos]<ToRead)
+                break; //Read error, the analyzers see a short content
+        }
+        Ended=true;
+    }
+
+    void Join()
+    {
+        Stop=true;
+        while (IsRunning())
+            Sleep(1);
+    }
+
+private:
+    File&               In;
+    int64u              Offset;
+    int64u              Size;
+};
+
+//***************************************************************************
+// Hasher
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+//Buffers of all the files being hashed, hashed together by the multi-buffer MD5
+class data_hasher
+{
+public:
+    data_hasher() : Streams(0) {}
+
+    void Stream_Begin()
+    {
+        CriticalSectionLocker CSL(CS);
+        Streams++;
+    }
+
+    void Stream_End()
+    {
+        CriticalSectionLocker CSL(CS);
+        Streams--;
+    }
+
+    void Update(MD5Context* Context, const int8u* Buffer, size_t Buffer_Size);
+
+private:
+    struct job
+    {
+        MD5Context*     Context;
+        const int8u*    Buffer;
+        size_t          Buffer_Size;
+        bool            Done;
+    };
+    CriticalSection     CS;
+    vector<job*>        Jobs; //Not yet taken by a thread
+    size_t              Streams; //Count of files currently hashed
+};
+static data_hasher Hasher;
+
+//---------------------------------------------------------------------------
+void data_hasher::Update(MD5Context* Context, const int8u* Buffer, size_t Buffer_Size)
+{
+    job Job;
+    Job.Context=Context;
+    Job.Buffer=Buffer;
+    Job.Buffer_Size=Buffer_Size;
+    Job.Done=false;
+    {
+        CriticalSectionLocker CSL(CS);
+        Jobs.push_back(&Job);
+    }
+
+    //Any waiting thread hashes the pending buffers, its own or the ones of other files
+    for (bool Waited=false;; Waited=true)
+    {
+        vector<job*> Batch;
+        {
+            CriticalSectionLocker CSL(CS);
+            if (Job.Done)
+                return;
+
+            //Waiting a bit for the buffers of the other files, so they are hashed together
+            if (!Jobs.empty() && (Waited || Jobs.size()>=Streams || Jobs.size()>=MD5Multi_Lanes()))
+            {
+                size_t Count=Jobs.size()<MD5_MULTI_LANES_MAX?Jobs.size():MD5_MULTI_LANES_MAX;
+                Batch.assign(Jobs.begin(), Jobs.begin()+Count);
+                Jobs.erase(Jobs.begin(), Jobs.begin()+Count);
+            }
+        }
+        if (Batch.empty())
+        {
+            Thread::Sleep(1);
+            continue;
+        }
+
+        MD5Context* Contexts[MD5_MULTI_LANES_MAX];
+        const unsigned char* Buffers[MD5_MULTI_LANES_MAX];
+        unsigned Buffer_Sizes[MD5_MULTI_LANES_MAX];
+        for (size_t Pos=0; Pos<Batch.size(); Pos++)
+        {
+            Contexts[Pos]=Batch[Pos]->Context;
+            Buffers[Pos]=Batch[Pos]->Buffer;
+            Buffer_Sizes[Pos]=(unsigned)Batch[Pos]->Buffer_Size;
+        }
+        MD5Multi_Update(Contexts, Buffers, Buffer_Sizes, (unsigned)Batch.size());
+
+        CriticalSectionLocker CSL(CS);
+        for (size_t Pos=0; Pos<Batch.size(); Pos++)
+            Batch[Pos]->Done=true;
+    }
+}
+
+//***************************************************************************
+// Tree hasher
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+//BLAKE3 subtrees of the buffers, hashed by worker threads and by the threads waiting for them
+const size_t data_Subtree_Count=16; //Per buffer, data_Ring_Size/data_Subtree_Count must be a power of 2 count of BLAKE3 chunks
+
+struct data_subtree
+{
+    const int8u*        Buffer;
+    size_t              Buffer_Size;
+    int64u              Chunk_Counter;
+    uint32_t            CV[8];
+    bool                Done;
+};
+
+class data_tree_hasher
+{
+public:
+    data_tree_hasher() : Streams(0) {}
+
+    void Stream_Begin();
+    void Stream_End();
+    void Queue(data_subtree* Subtrees, size_t Count);
+    void Wait(data_subtree* Subtrees, size_t Count);
+    bool Hash_One();
+
+private:
+    class worker : public Thread
+    {
+    public:
+        std::atomic<bool> Stop;
+
+        worker(data_tree_hasher &Owner_) : Stop(false), Owner(Owner_) {}
+
+        void Entry()
+        {
+            while (!Stop)
+                if (!Owner.Hash_One())
+                    Sleep(1);
+        }
+
+        void Join()
+        {
+            Stop=true;
+            while (IsRunning())
+                Sleep(1);
+        }
+
+    private:
+        data_tree_hasher& Owner;
+    };
+
+    CriticalSection     CS;
+    vector<data_subtree*> Jobs; //Not yet taken by a thread
+    vector<worker*>     Workers;
+    size_t              Streams; //Count of files currently hashed
+};
+static data_tree_hasher TreeHasher;
+
+//---------------------------------------------------------------------------
+void data_tree_hasher::Stream_Begin()
+{
+    CriticalSectionLocker CSL(CS);
+    if (!Streams++)
+    {
+        //The thread waiting for its buffer is also hashing
+        size_t Count=std::thread::hardware_concurrency();
+        if (Count>data_Subtree_Count)
+            Count=data_Subtree_Count;
+        for (size_t Pos=1; Pos<Count; Pos++)
+        {
+            Workers.push_back(new worker(*this));
+            Workers.back()->Run();
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+void data_tree_hasher::Stream_End()
+{
+    vector<worker*> ToDelete;
+    {
+        CriticalSectionLocker CSL(CS);
+        if (!--Streams)
+            ToDelete.swap(Workers);
+    }
+    for (size_t Pos=0; Pos<ToDelete.size(); Pos++)
+    {
+        ToDelete[Pos]->Join();
+        delete ToDelete[Pos];
+    }
+}
+
+//---------------------------------------------------------------------------
+void data_tree_hasher::Queue(data_subtree* Subtrees, size_t Count)
+{
+    CriticalSectionLocker CSL(CS);
+    for (size_t Pos=0; Pos<Count; Pos++)
+    {
+        Subtrees[Pos].Done=false;
+        Jobs.push_back(Subtrees+Pos);
+    }
+}
+
+//---------------------------------------------------------------------------
+bool data_tree_hasher::Hash_One()
+{
+    data_subtree* Job;
+    {
+        CriticalSectionLocker CSL(CS);
+        if (Jobs.empty())
+            return false;
+        Job=Jobs.front();
+        Jobs.erase(Jobs.begin());
+    }
+
+    BLAKE3Subtree(Job->CV, Job->Buffer, Job->Buffer_Size, Job->Chunk_Counter);
+
+    CriticalSectionLocker CSL(CS);
+    Job->Done=true;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void data_tree_hasher::Wait(data_subtree* Subtrees, size_t Count)
+{
+    for (;;)
+    {
+        {
+            CriticalSectionLocker CSL(CS);
+            size_t Pos=0;
+            while (Pos<Count && Subtrees[Pos].Done)
+                Pos++;
+            if (Pos==Count)
+                return;
+        }
+
+        //Hashing the pending subtrees, its own or the ones of other files
+        if (!Hash_One())
+            Thread::Sleep(1);
+    }
+}
+
+//***************************************************************************
+// Analyzers
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+//Lowercase, as displayed by the usual command line tools
+static string Hash_ToString(const int8u* Digest, size_t Digest_Size)
+{
+    ostringstream DigestS;
+    DigestS<<hex<<setfill('0');
+    for (size_t Pos=0; Pos<Digest_Size; Pos++)
+        DigestS<<setw(2)<<(int)Digest[Pos];
+    return DigestS.str();
+}
+
+//---------------------------------------------------------------------------
+//MD5, hashed with the buffers of the other files by the multi-buffer hasher
+class data_md5 : public Riff_Analyzer
+{
+public:
+    MD5Context          Context; //May be restored before the first buffer
+    string              Digest;
+
+    data_md5()
+    {
+        MD5Init(&Context);
+        Hasher.Stream_Begin();
+    }
+
+    ~data_md5()
+    {
+        Hasher.Stream_End();
+    }
+
+    void Update(const int8u* Buffer, size_t Buffer_Size)
+    {
+        Hasher.Update(&Context, Buffer, Buffer_Size);
+    }
+
+    void Finish()
+    {
+        int8u DigestB[16];
+        MD5Final(DigestB, &Context);
+        int128u DigestI=BigEndian2int128u(DigestB);
+        ostringstream DigestS; //Not int128u::toString(), its buffer is shared between threads
+        DigestS<<hex<<uppercase<<setfill('0')<<setw(16)<<DigestI.hi<<setw(16)<<DigestI.lo; //Padding with 0, this must be a 32-byte string
+        Digest=DigestS.str();
+    }
+
+    bool Thread_Allowed() const
+    {
+        return false; //The buffers of the files read at the same time are hashed together by the waiting threads
+    }
+};
+
+//---------------------------------------------------------------------------
+//Fixity index, a digest per segment and the MD5 context at the end of each segment
+class data_fixity : public Riff_Analyzer
+{
+public:
+    data_fixity(Riff_Fixity_Index &Index_, const MD5Context &MD5_, int64u Done_, int64u Size_, string &Error_)
+        : Index(Index_), MD5(MD5_), Done(Done_), Size(Size_), Error(Error_), IsOpen(true)
+    {
+        XXH3Init(&XXH3);
+    }
+
+    void Update(const int8u* Buffer, size_t Buffer_Size)
+    {
+        if (!IsOpen)
+            return;
+
+        //The segment size is a multiple of the buffer size
+        XXH3Update(&XXH3, Buffer, Buffer_Size);
+        Done+=Buffer_Size;
+        if (Done%Index.Segment_Size==0 || Done==Size)
+        {
+            Riff_Fixity_Index::segment Segment;
+            int8u Digest[8];
+            XXH3Final(Digest, &XXH3);
+            XXH3Init(&XXH3);
+            Segment.XXH3=Hash_ToString(Digest, 8);
+            Segment.MD5_State=Riff_Fixity_Index::MD5_State_Get(MD5);
+            if (!Index.Segment_Add(Segment))
+            {
+                IsOpen=false;
+                Error="fixity index can not be written";
+            }
+        }
+    }
+
+    void Finish()
+    {
+    }
+
+    bool Thread_Allowed() const
+    {
+        return false; //The MD5 context must be the one after the same buffer
+    }
+
+    bool Close(const string &MD5_Digest)
+    {
+        if (!IsOpen || !Index.Close(MD5_Digest))
+        {
+            Error="fixity index can not be written";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    Riff_Fixity_Index&  Index;
+    const MD5Context&   MD5;
+    XXH3Context         XXH3;
+    int64u              Done;
+    int64u              Size;
+    string&             Error;
+    bool                IsOpen;
+};
+
+//---------------------------------------------------------------------------
+class data_xxh3 : public Riff_Analyzer
+{
+public:
+    string              Digest;
+
+    data_xxh3()
+    {
+        XXH3Init(&Context);
+    }
+
+    void Update(const int8u* Buffer, size_t Buffer_Size)
+    {
+        XXH3Update(&Context, Buffer, Buffer_Size);
+    }
+
+    void Finish()
+    {
+        int8u DigestB[8];
+        XXH3Final(DigestB, &Context);
+        Digest=Hash_ToString(DigestB, 8);
+    }
+
+private:
+    XXH3Context         Context;
+};
+
+//---------------------------------------------------------------------------
+class data_sha256 : public Riff_Analyzer
+{
+public:
+    string              Digest;
+
+    data_sha256()
+    {
+        SHA256Init(&Context);
+    }
+
+    void Update(const int8u* Buffer, size_t Buffer_Size)
+    {
+        SHA256Update(&Context, Buffer, Buffer_Size);
+    }
+
+    void Finish()
+    {
+        int8u DigestB[32];
+        SHA256Final(DigestB, &Context);
+        Digest=Hash_ToString(DigestB, 32);
+    }
+
+private:
+    SHA256Context       Context;
+};
+
+//---------------------------------------------------------------------------
+//BLAKE3, full buffers are split in subtrees hashed by the tree hasher threads
+class data_blake3 : public Riff_Analyzer
+{
+public:
+    string              Digest;
+
+    data_blake3(int64u Size_) : Size(Size_), Done(0)
+    {
+        BLAKE3Init(&Context);
+        TreeHasher.Stream_Begin();
+    }
+
+    ~data_blake3()
+    {
+        TreeHasher.Stream_End();
+    }
+
+    void Update(const int8u* Buffer, size_t Buffer_Size)
+    {
+        //Not the last buffer, the root of the tree is there
+        if (Buffer_Size==data_Ring_Size && Done+Buffer_Size<Size)
+        {
+            for (size_t Pos=0; Pos<data_Subtree_Count; Pos++)
+            {
+                Subtrees[Pos].Buffer_Size=Buffer_Size/data_Subtree_Count;
+                Subtrees[Pos].Buffer=Buffer+Pos*Subtrees[Pos].Buffer_Size;
+                Subtrees[Pos].Chunk_Counter=(Done+Pos*Subtrees[Pos].Buffer_Size)/BLAKE3_CHUNK_LEN;
+            }
+            TreeHasher.Queue(Subtrees, data_Subtree_Count);
+            TreeHasher.Wait(Subtrees, data_Subtree_Count);
+            for (size_t Pos=0; Pos<data_Subtree_Count; Pos++)
+                BLAKE3AddSubtree(&Context, Subtrees[Pos].CV, Subtrees[Pos].Buffer_Size/BLAKE3_CHUNK_LEN);
+        }
+        else
+            BLAKE3Update(&Context, Buffer, Buffer_Size);
+        Done+=Buffer_Size;
+    }
+
+    void Finish()
+    {
+        int8u DigestB[32];
+        BLAKE3Final(DigestB, &Context);
+        Digest=Hash_ToString(DigestB, 32);
+    }
+
+private:
+    BLAKE3Context       Context;
+    data_subtree        Subtrees[data_Subtree_Count];
+    int64u              Size;
+    int64u              Done;
+};
+
+//---------------------------------------------------------------------------
+//Analyzers of a data chunk, deleted with the list
+struct data_analyzers
+{
+    vector<Riff_Analyzer*> List;
+
+    ~data_analyzers()
+    {
+        for (size_t Pos=0; Pos<List.size(); Pos++)
+            delete List[Pos];
+    }
+};
+
+//***************************************************************************
+// Feeder
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+//Analyzer fed from its own thread, with the buffers of the ring not yet consumed by it
+class data_analyzer_thread : public Thread
+{
+public:
+    std::atomic<size_t> Consumed; //Count of buffers analyzed since the start
+    std::atomic<bool>   Stop;
+
+    data_analyzer_thread(Riff_Analyzer* Analyzer_, data_reader &Reader_) : Consumed(0), Stop(false), Analyzer(Analyzer_), Reader(Reader_) {}
+
+    void Entry()
+    {
+        while (!Stop)
+        {
+            //Waiting for a filled buffer
+            if (Consumed==Reader.Filled)
+            {
+                if (Reader.Ended && Consumed==Reader.Filled)
+                    break;
+                Sleep(1);
+                continue;
+            }
+
+            size_t Pos=Consumed%data_Ring_Count;
+            Analyzer->Update(Reader.Buffers[Pos], Reader.Sizes[Pos]);
+            Consumed++;
+        }
+    }
+
+    void Join()
+    {
+        Stop=true;
+        while (IsRunning())
+            Sleep(1);
+    }
+
+private:
+    Riff_Analyzer*      Analyzer;
+    data_reader&        Reader;
+};
+
+//---------------------------------------------------------------------------
+//One read of the audio data feeding all the analyzers, a buffer is released when all of them consumed it
+class data_feeder
+{
+public:
+    int64u              Done; //Bytes read and analyzed by the analyzers fed from this thread
+
+    data_feeder(File &In, int64u Offset_, int64u Size, const vector<Riff_Analyzer*> &Analyzers) : Done(0), Offset(Offset_)
+    {
+        Reader=new data_reader(In, Offset, Size);
+
+        //Each analyzer in its own thread if there are several ones and several CPUs, except if it must stay in the reading thread
+        bool Threads_Allowed=Analyzers.size()>1 && std::thread::hardware_concurrency()>1;
+        for (size_t Pos=0; Pos<Analyzers.size(); Pos++)
+            if (Threads_Allowed && Analyzers[Pos]->Thread_Allowed())
+                Threads.push_back(new data_analyzer_thread(Analyzers[Pos], *Reader));
+            else
+                Inline.push_back(Analyzers[Pos]);
+    }
+
+    ~data_feeder()
+    {
+        for (size_t Pos=0; Pos<Threads.size(); Pos++)
+        {
+            Threads[Pos]->Join();
+            delete Threads[Pos];
+        }
+        Reader->Join();
+        delete Reader;
+    }
+
+    bool Feed(Riff_Base::progress* Progress); //False if canceled
+
+private:
+    data_reader*        Reader;
+    vector<data_analyzer_thread*> Threads;
+    vector<Riff_Analyzer*> Inline;
+    int64u              Offset;
+};
+
+//---------------------------------------------------------------------------
+bool data_feeder::Feed(Riff_Base::progress* Progress)
+{
+    Reader->Run();
+    for (size_t Pos=0; Pos<Threads.size(); Pos++)
+        Threads[Pos]->Run();
+
+    size_t Consumed=0; //By the analyzers fed from this thread
+    for (;;)
+    {
+        //Buffers consumed by all the analyzers are released
+        size_t Consumed_All=Consumed;
+        for (size_t Pos=0; Pos<Threads.size(); Pos++)
+            if (Threads[Pos]->Consumed<Consumed_All)
+                Consumed_All=Threads[Pos]->Consumed;
+        Reader->Consumed=Consumed_All;
+
+        if (Progress->Canceling)
+            return false;
+
+        //Waiting for a filled buffer, or for the other threads at the end
+        if (Consumed==Reader->Filled)
+        {
+            if (Reader->Ended && Consumed==Reader->Filled)
+            {
+                bool IsRunning=false;
+                for (size_t Pos=0; Pos<Threads.size(); Pos++)
+                    if (Threads[Pos]->IsRunning())
+                        IsRunning=true;
+                if (!IsRunning)
+                    return true;
+            }
+            Thread::Sleep(1);
+            continue;
+        }
+
+        size_t Pos=Consumed%data_Ring_Count;
+        for (size_t Analyzer_Pos=0; Analyzer_Pos<Inline.size(); Analyzer_Pos++)
+            Inline[Analyzer_Pos]->Update(Reader->Buffers[Pos], Reader->Sizes[Pos]);
+        Done+=Reader->Sizes[Pos];
+        Consumed++;
+        Progress->Done_Set(Offset+Done);
+    }
+}
+
 //***************************************************************************
 // WAVE data
 //***************************************************************************
 
+//---------------------------------------------------------------------------
+//bext v2 format, XX.XX or -XX.XX, empty if not measurable
+static string Loudness_ToString(bool IsValid, float64 Value)
+{
+    if (!IsValid)
+        return string();
+    Value=floor(Value*100+0.5)/100;
+    if (Value<=-100 || Value>=100)
+        return string();
+    return Ztring::ToZtring(Value, 2).To_UTF8();
+}
+
+//---------------------------------------------------------------------------
+//Digital silence is displayed as -inf
+static string Levels_ToString(float64 Value)
+{
+    if (Value<-1000)
+        return "-inf";
+    return Ztring::ToZtring(Value, 2).To_UTF8();
+}
+
 //---------------------------------------------------------------------------
 void Riff_WAVE_data::Read_Internal ()
 {
@@ -40,52 +760,298 @@ void Riff_WAVE_data::Read_Internal ()
     Global->data->File_Offset=Global->In.Position_Get();
     Global->data->Size=Chunk.Content.Size;
 
-    //MD5
-    try
+    //Digests from the digest cache, if the file is not modified since they were generated
+    Riff_Hash_Cache::digests Cached;
+    bool Cached_Rehash=false;
+    if ((Global->GenerateMD5 || Global->GenerateHashes) && !Global->FixityIndex && !Global->ComputeLoudness && !Global->ComputeLevels && !Global->DetectSilences && Global->Hash_Cache && Global->Hash_Cache->Get(Global->File_Name.To_UTF8(), Global->data->File_Offset, Chunk.Content.Size, Cached, Cached_Rehash) && !Cached_Rehash)
+    {
+        if ((!Global->GenerateMD5 || Cached.find("md5generated")!=Cached.end())
+         && (!(Global->GenerateHashes&Hash_XXH3) || Cached.find("xxh3generated")!=Cached.end())
+         && (!(Global->GenerateHashes&Hash_SHA256) || Cached.find("sha256generated")!=Cached.end())
+         && (!(Global->GenerateHashes&Hash_BLAKE3) || Cached.find("blake3generated")!=Cached.end()))
+        {
+            if (Global->GenerateMD5)
+            {
+                Global->MD5Generated=new Riff_Base::global::chunk_strings;
+                Global->MD5Generated->Strings["md5generated"]=Cached["md5generated"];
+            }
+            if (Global->GenerateHashes)
+            {
+                Global->HashesGenerated=new Riff_Base::global::chunk_strings;
+                if (Global->GenerateHashes&Hash_XXH3)
+                    Global->HashesGenerated->Strings["xxh3generated"]=Cached["xxh3generated"];
+                if (Global->GenerateHashes&Hash_SHA256)
+                    Global->HashesGenerated->Strings["sha256generated"]=Cached["sha256generated"];
+                if (Global->GenerateHashes&Hash_BLAKE3)
+                    Global->HashesGenerated->Strings["blake3generated"]=Cached["blake3generated"];
+            }
+            Global->data->Hash_Cached=true;
+        }
+    }
+
+    //PCM format, the sub-format for WAVE_FORMAT_EXTENSIBLE
+    int16u FormatTag=0;
+    if (Global->fmt_)
+    {
+        FormatTag=Global->fmt_->formatType;
+        if (FormatTag==0xFFFE)
+            FormatTag=(int16u)((((Global->fmt_->extFormatType.hi>>48)&0xFF)<<8) | (Global->fmt_->extFormatType.hi>>56));
+    }
+
+    //Analyzers, all fed by one read of the audio data
+    data_analyzers Analyzers;
+    data_md5* MD5=NULL;
+    data_xxh3* XXH3=NULL;
+    data_sha256* SHA256=NULL;
+    data_blake3* BLAKE3=NULL;
+    Riff_Loudness* Loudness=NULL;
+    Riff_Levels* Levels=NULL;
+    Riff_Silence* Silence=NULL;
+    if (!Global->data->Hash_Cached)
+    {
+        if (Global->GenerateMD5)
+            Analyzers.List.push_back(MD5=new data_md5);
+        if (Global->GenerateHashes&Hash_XXH3)
+            Analyzers.List.push_back(XXH3=new data_xxh3);
+        if (Global->GenerateHashes&Hash_SHA256)
+            Analyzers.List.push_back(SHA256=new data_sha256);
+        if (Global->GenerateHashes&Hash_BLAKE3)
+            Analyzers.List.push_back(BLAKE3=new data_blake3(Chunk.Content.Size));
+    }
+    if (Global->ComputeLoudness)
+    {
+        if (Global->fmt_)
+            Loudness=new Riff_Loudness(FormatTag, Global->fmt_->channelCount, Global->fmt_->sampleRate, Global->fmt_->bitsPerSample, Global->fmt_->blockAlignment, (Riff_Peak::kernel)Global->Peak_Kernel);
+        if (Loudness && Loudness->IsSupported())
+            Analyzers.List.push_back(Loudness);
+        else
+        {
+            delete Loudness;
+            Loudness=NULL;
+            Global->data->Loudness_Error=Global->fmt_?"audio format not supported":"no fmt chunk before the data chunk";
+        }
+    }
+    if (Global->ComputeLevels)
     {
-        Chunk.Content.Buffer=new int8u[65536];
+        if (Global->fmt_)
+            Levels=new Riff_Levels(FormatTag, Global->fmt_->channelCount, Global->fmt_->sampleRate, Global->fmt_->bitsPerSample, Global->fmt_->blockAlignment, Global->Silence_Threshold);
+        if (Levels && Levels->IsSupported())
+            Analyzers.List.push_back(Levels);
+        else
+        {
+            delete Levels;
+            Levels=NULL;
+            Global->data->Levels_Error=Global->fmt_?"audio format not supported":"no fmt chunk before the data chunk";
+        }
     }
-    catch(...)
+    if (Global->DetectSilences)
     {
-        throw exception_read_chunk("Problem during memory allocation");
+        if (Global->fmt_)
+            Silence=new Riff_Silence(FormatTag, Global->fmt_->channelCount, Global->fmt_->sampleRate, Global->fmt_->bitsPerSample, Global->fmt_->blockAlignment, Global->Silence_Threshold, Global->Silence_Duration, (Riff_Peak::kernel)Global->Peak_Kernel);
+        if (Silence && Silence->IsSupported())
+            Analyzers.List.push_back(Silence);
+        else
+        {
+            delete Silence;
+            Silence=NULL;
+            Global->data->Silences_Error=Global->fmt_?"audio format not supported":"no fmt chunk before the data chunk";
+        }
     }
 
     //Reading
-    if (Global->GenerateMD5)
-    {
-        MD5Context MD5;
-        MD5Init(&MD5);
-        while(Chunk.Content.Buffer_Offset<Chunk.Content.Size)
-        {
-            size_t ToRead=(size_t)Chunk.Content.Size-Chunk.Content.Buffer_Offset;
-            if (ToRead>65536)
-                ToRead=65536;
-            size_t BytesRead=Global->In.Read(Chunk.Content.Buffer, ToRead);
-            if (BytesRead==0)
-                break; //Read is finished
-            Global->CS.Enter();
-            Global->Progress=(float)Global->In.Position_Get()/Global->In.Size_Get();
-            if (Global->Canceling)
+    if (!Analyzers.List.empty())
+    {
+        int64u Done=0;
+
+        //Fixity index, resumed from the last segment written if the previous hashing was interrupted and the file was not modified since
+        Riff_Fixity_Index Fixity;
+        data_fixity* Fixity_Analyzer=NULL;
+        if (Global->FixityIndex && MD5)
+        {
+            Ztring Fixity_FileName=Riff_Fixity_Index::FileName_Get(Global->File_Name);
+            Riff_Hash_Cache::key Key;
+            Key.Get(Global->File_Name.To_UTF8()); //Empty if not available, the index is then not resumed
+            if (Analyzers.List.size()==1 //Other analyzers can not be resumed
+             && !Key.Id.empty()
+             && Fixity.Load(Fixity_FileName)
+             && Fixity.MD5.empty()
+             && !Fixity.Segments.empty()
+             && Fixity.Segments.size()*Fixity.Segment_Size<Chunk.Content.Size
+             && Fixity.File_Size==Global->File_Size
+             && Fixity.File_Id==Key.Id
+             && Fixity.File_Modified==Key.Modified
+             && Fixity.Data_Offset==Global->data->File_Offset
+             && Fixity.Data_Size==Chunk.Content.Size
+             && Fixity.Segment_Size==Global->Fixity_Segment_Size
+             && Riff_Fixity_Index::MD5_State_Set(MD5->Context, Fixity.Segments.back().MD5_State))
+                Done=Fixity.Segments.size()*Fixity.Segment_Size;
+            else
             {
-                Global->CS.Leave();
-                throw exception_canceled();
+                MD5Init(&MD5->Context);
+                Fixity.Segments.clear();
+                Fixity.File_Size=Global->File_Size;
+                Fixity.File_Id=Key.Id;
+                Fixity.File_Modified=Key.Modified;
+                Fixity.Data_Offset=Global->data->File_Offset;
+                Fixity.Data_Size=Chunk.Content.Size;
+                Fixity.Segment_Size=Global->Fixity_Segment_Size;
             }
-            Global->CS.Leave();
-            //SleeperThread::msleep(200);
-            Chunk.Content.Buffer_Offset+=BytesRead;
-            MD5Update(&MD5, Chunk.Content.Buffer, (unsigned int)BytesRead);
+            if (Fixity.Create(Fixity_FileName))
+            {
+                Global->data->Fixity_Resumed=Done;
+                Fixity_Analyzer=new data_fixity(Fixity, MD5->Context, Done, Chunk.Content.Size, Global->data->Fixity_Error);
+                Analyzers.List.insert(Analyzers.List.begin()+1, Fixity_Analyzer); //Just after MD5, in the same thread
+            }
+            else
+            {
+                MD5Init(&MD5->Context);
+                Done=0;
+                Global->data->Fixity_Error="fixity index can not be written";
+            }
+        }
+
+        //Reading in a thread, analyzing here and in other threads
+        std::chrono::steady_clock::time_point Start=std::chrono::steady_clock::now();
+        {
+            data_feeder* Feeder;
+            try
+            {
+                Feeder=new data_feeder(Global->In, Global->data->File_Offset+Done, Chunk.Content.Size-Done, Analyzers.List);
+            }
+            catch(...)
+            {
+                throw exception_read_chunk("Problem during memory allocation");
+            }
+            bool IsComplete=Feeder->Feed(Global->Progress);
+            Done+=Feeder->Done;
+            delete Feeder;
+            if (!IsComplete)
+                throw exception_canceled();
         }
-        if (Chunk.Content.Buffer_Offset<Chunk.Content.Size)
+        if (Done<Chunk.Content.Size)
             throw exception_read();
-        delete[] Chunk.Content.Buffer; Chunk.Content.Buffer=NULL;
-        Chunk.Content.Buffer_Offset=0;
-        int8u Digest[16];
-        MD5Final(Digest, &MD5);
-        int128u DigestI=BigEndian2int128u(Digest);
-        Global->MD5Generated=new Riff_Base::global::chunk_strings;
-        Global->MD5Generated->Strings["md5generated"]=Ztring().From_Number(DigestI, 16).To_UTF8();
-        while (Global->MD5Generated->Strings["md5generated"].size()<32)
-            Global->MD5Generated->Strings["md5generated"].insert(Global->MD5Generated->Strings["md5generated"].begin(), '0'); //Padding with 0, this must be a 32-byte string    
+        for (size_t Pos=0; Pos<Analyzers.List.size(); Pos++)
+            Analyzers.List[Pos]->Finish();
+        Global->data->Hash_Duration=std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-Start).count();
+
+        //Digests
+        if (MD5)
+        {
+            Global->MD5Generated=new Riff_Base::global::chunk_strings;
+            Global->MD5Generated->Strings["md5generated"]=MD5->Digest;
+            if (Fixity_Analyzer && Fixity_Analyzer->Close(MD5->Digest))
+                Global->data->Fixity_Segments=Fixity.Segments.size();
+        }
+        if (XXH3 || SHA256 || BLAKE3)
+        {
+            Global->HashesGenerated=new Riff_Base::global::chunk_strings;
+            if (XXH3)
+                Global->HashesGenerated->Strings["xxh3generated"]=XXH3->Digest;
+            if (SHA256)
+                Global->HashesGenerated->Strings["sha256generated"]=SHA256->Digest;
+            if (BLAKE3)
+                Global->HashesGenerated->Strings["blake3generated"]=BLAKE3->Digest;
+        }
+
+        //Loudness
+        if (Loudness)
+        {
+            Global->data->Loudness["LoudnessValue"]=Loudness_ToString(Loudness->IntegratedLoudness_IsValid, Loudness->IntegratedLoudness);
+            Global->data->Loudness["LoudnessRange"]=Loudness_ToString(Loudness->LoudnessRange_IsValid, Loudness->LoudnessRange);
+            Global->data->Loudness["MaxTruePeakLevel"]=Loudness_ToString(Loudness->MaxTruePeakLevel_IsValid, Loudness->MaxTruePeakLevel);
+            Global->data->Loudness["MaxMomentaryLoudness"]=Loudness_ToString(Loudness->MaxMomentaryLoudness_IsValid, Loudness->MaxMomentaryLoudness);
+            Global->data->Loudness["MaxShortTermLoudness"]=Loudness_ToString(Loudness->MaxShortTermLoudness_IsValid, Loudness->MaxShortTermLoudness);
+        }
+
+        //Levels
+        if (Levels)
+        {
+            for (size_t Channel=0; Channel<Levels->Channels_Results.size(); Channel++)
+            {
+                const Riff_Levels::channel &Result=Levels->Channels_Results[Channel];
+                ostringstream Line;
+                Line<<"channel "<<Channel+1
+                    <<", peak "<<Levels_ToString(Result.Peak)<<" dBFS"
+                    <<", RMS "<<Levels_ToString(Result.RMS)<<" dBFS"
+                    <<", DC offset "<<Ztring::ToZtring(Result.DC_Offset, 4).To_UTF8()<<"%"
+                    <<", "<<Result.Clipped<<" clipped samples";
+                Global->data->Levels.push_back(Line.str());
+            }
+            ostringstream Line;
+            Line<<"silence "<<Ztring::ToZtring(Levels->Frames?(float64)Levels->Silence_Frames*100/Levels->Frames:0, 1).To_UTF8()<<"% (below "<<Global->Silence_Threshold<<" dBFS)";
+            Global->data->Levels.push_back(Line.str());
+        }
+
+        //Silences
+        if (Silence)
+            for (size_t Pos=0; Pos<Silence->Ranges.size(); Pos++)
+                Global->data->Silences.push_back(make_pair(Silence->Ranges[Pos].Start, Silence->Ranges[Pos].Length));
+    }
+
+    //Fixity index verification, the segments are verified in parallel
+    if (Global->FixityVerify)
+    {
+        Riff_Fixity_Index Fixity;
+        vector<bool> Damaged;
+        if (!Fixity.Load(Riff_Fixity_Index::FileName_Get(Global->File_Name)) || Fixity.MD5.empty())
+            Global->data->Fixity_Error="no complete fixity index";
+        else if (Fixity.Data_Size!=Chunk.Content.Size)
+            Global->data->Fixity_Error="fixity index of an audio data of a different size";
+        else if (!Fixity.Verify(Global->File_Name, Global->data->File_Offset, Damaged, Global->Progress))
+        {
+            if (Global->Progress->Canceling)
+                throw exception_canceled();
+            Global->data->Fixity_Error="fixity index not verified";
+        }
+        else
+        {
+            //Damaged byte ranges, in the file
+            Global->data->Fixity_Segments=Damaged.size();
+            for (size_t Pos=0; Pos<Damaged.size(); Pos++)
+                if (Damaged[Pos])
+                {
+                    size_t Pos_End=Pos+1;
+                    while (Pos_End<Damaged.size() && Damaged[Pos_End])
+                        Pos_End++;
+                    int64u Begin=Pos*Fixity.Segment_Size;
+                    int64u End=Pos_End*Fixity.Segment_Size;
+                    if (End>Chunk.Content.Size)
+                        End=Chunk.Content.Size;
+                    Global->data->Fixity_Damaged+=", "+Ztring::ToZtring(Global->data->File_Offset+Begin).To_UTF8()+"-"+Ztring::ToZtring(Global->data->File_Offset+End-1).To_UTF8();
+                    Pos=Pos_End;
+                }
+            if (!Global->data->Fixity_Damaged.empty())
+                Global->data->Fixity_Damaged.erase(0, 2);
+        }
+    }
+
+    //Digest cache, also with the digests carried from a previous read of the same audio data
+    if (Global->Hash_Cache && !Global->data->Hash_Cached && (Global->MD5Generated || Global->HashesGenerated))
+    {
+        Riff_Hash_Cache::digests Digests;
+        if (Global->MD5Generated)
+            Digests.insert(Global->MD5Generated->Strings.begin(), Global->MD5Generated->Strings.end());
+        if (Global->HashesGenerated)
+            Digests.insert(Global->HashesGenerated->Strings.begin(), Global->HashesGenerated->Strings.end());
+
+        //Same file, same modification time, the audio data must not differ
+        if (Cached_Rehash)
+        {
+            for (Riff_Hash_Cache::digests::iterator Digest=Digests.begin(); Digest!=Digests.end(); ++Digest)
+            {
+                Riff_Hash_Cache::digests::iterator Digest_Cached=Cached.find(Digest->first);
+                if (Digest_Cached!=Cached.end() && Ztring().From_UTF8(Digest_Cached->second).MakeLowerCase()!=Ztring().From_UTF8(Digest->second).MakeLowerCase())
+                    Global->data->Hash_Cache_Mismatch+=", "+Ztring().From_UTF8(Digest->first.substr(0, Digest->first.find("generated"))).MakeUpperCase().To_UTF8();
+            }
+            if (Global->data->Hash_Cache_Mismatch.empty())
+                Global->data->Hash_Cache_Verified=true;
+            else
+                Global->data->Hash_Cache_Mismatch.erase(0, 2);
+        }
+
+        //The cached digests are kept on mismatch, the next audits report it again
+        if (Global->data->Hash_Cache_Mismatch.empty())
+            Global->Hash_Cache->Set(Global->File_Name.To_UTF8(), Global->data->File_Offset, Chunk.Content.Size, Digests, Global->GenerateMD5 || Global->GenerateHashes);
     }
 }
 
@@ -106,9 +1072,6 @@ void Riff_WAVE_data::Modify_Internal ()
 //---------------------------------------------------------------------------
 void Riff_WAVE_data::Write_Internal ()
 {
-    if (Global->Out_Buffer_File_TryModification)
-        Global->Out_Buffer_WriteAtEnd=true;
-    else
-        Riff_Base::Write_Internal();
+    Global->Out_Plan.Copy(Global->data->File_Offset, Global->data->Size, true);
 }
 
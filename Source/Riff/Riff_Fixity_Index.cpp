@@ -0,0 +1,312 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Fixity_Index.h"
+extern "C"
+{
+#include "Hash/xxh3.h"
+}
+#include "ZenLib/Thread.h"
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <thread>
+#include <cstdlib>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+//One "Name=Value" per line, then one "Segment=XXH3,MD5 state" per segment, then "MD5=" when complete
+static const char* Riff_Fixity_Index_Header="BWF MetaEdit fixity index 1";
+const size_t Riff_Fixity_Index_Buffer_Size=4*1024*1024;
+const size_t Riff_Fixity_Index_Threads_Max=16;
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+static string Fixity_ToString(const int8u* Digest, size_t Digest_Size)
+{
+    ostringstream DigestS;
+    DigestS<<hex<<setfill('0');
+    for (size_t Pos=0; Pos<Digest_Size; Pos++)
+        DigestS<<setw(2)<<(int)Digest[Pos];
+    return DigestS.str();
+}
+
+//***************************************************************************
+// Verifier
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+//Each thread verifies the next segment not yet taken, with its own file handle
+class fixity_verifier : public Thread
+{
+public:
+    fixity_verifier(const Riff_Fixity_Index &Index_, const Ztring &FileName_, int64u Data_Offset_, std::atomic<size_t> &Next_, vector<int8u> &Damaged_, std::atomic<int64u> &Done_, std::atomic<bool> &Stop_)
+        : Index(Index_), FileName(FileName_), Data_Offset(Data_Offset_), Next(Next_), Damaged(Damaged_), Done(Done_), Stop(Stop_) {}
+
+    void Entry()
+    {
+        File In;
+        bool IsOpen=In.Open(FileName);
+        int8u* Buffer=IsOpen?new (std::nothrow) int8u[Riff_Fixity_Index_Buffer_Size]:NULL;
+
+        for (;;)
+        {
+            size_t Pos=Next++;
+            if (Pos>=Index.Segments.size() || Stop)
+                break;
+
+            int64u Offset=Pos*Index.Segment_Size;
+            int64u Size=Index.Data_Size-Offset<Index.Segment_Size?Index.Data_Size-Offset:Index.Segment_Size;
+            XXH3Context XXH3;
+            XXH3Init(&XXH3);
+            int64u Segment_Done=0;
+            while (Buffer && Segment_Done<Size && !Stop)
+            {
+                size_t ToRead=Size-Segment_Done<Riff_Fixity_Index_Buffer_Size?(size_t)(Size-Segment_Done):Riff_Fixity_Index_Buffer_Size;
+                size_t Read=In.Read_At(Buffer, ToRead, Data_Offset+Offset+Segment_Done);
+                XXH3Update(&XXH3, Buffer, Read);
+                Segment_Done+=Read;
+                Done+=Read;
+                if (Read<ToRead)
+                    break; //Read error, the segment is damaged
+            }
+            int8u Digest[8];
+            XXH3Final(Digest, &XXH3);
+            Damaged[Pos]=Segment_Done<Size || Fixity_ToString(Digest, 8)!=Index.Segments[Pos].XXH3;
+        }
+
+        delete[] Buffer;
+    }
+
+private:
+    const Riff_Fixity_Index& Index;
+    Ztring                  FileName;
+    int64u                  Data_Offset;
+    std::atomic<size_t>&    Next;
+    vector<int8u>&          Damaged; //Not vector<bool>, written by several threads
+    std::atomic<int64u>&    Done;
+    std::atomic<bool>&      Stop;
+};
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Riff_Fixity_Index::Riff_Fixity_Index()
+{
+    File_Size=0;
+    File_Modified=0;
+    Data_Offset=0;
+    Data_Size=0;
+    Segment_Size=RIFF_Fixity_Segment_DefaultSize;
+}
+
+//---------------------------------------------------------------------------
+Riff_Fixity_Index::~Riff_Fixity_Index()
+{
+}
+
+//***************************************************************************
+// Sidecar
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Ztring Riff_Fixity_Index::FileName_Get(const Ztring &FileName)
+{
+    return FileName+__T(".fixity");
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Fixity_Index::Load(const Ztring &FileName)
+{
+    Segments.clear();
+    MD5.clear();
+
+    File F;
+    if (!F.Open(FileName))
+        return false;
+    int64u Size=F.Size_Get();
+    string Content;
+    Content.resize((size_t)Size);
+    if (Size && F.Read((int8u*)&Content[0], (size_t)Size)!=Size)
+        return false;
+    F.Close();
+    Content.erase(Content.rfind('\n')+1); //Last line partially written if interrupted
+
+    istringstream Lines(Content);
+    string Line;
+    if (!getline(Lines, Line) || Line!=Riff_Fixity_Index_Header)
+        return false;
+    while (getline(Lines, Line))
+    {
+        size_t Equal=Line.find('=');
+        if (Equal==string::npos)
+            continue;
+        string Name=Line.substr(0, Equal);
+        string Value=Line.substr(Equal+1);
+        if (Name=="FileSize")
+            File_Size=Ztring().From_UTF8(Value).To_int64u();
+        else if (Name=="FileId")
+            File_Id=Value;
+        else if (Name=="FileModified")
+            File_Modified=Ztring().From_UTF8(Value).To_int64s();
+        else if (Name=="DataOffset")
+            Data_Offset=Ztring().From_UTF8(Value).To_int64u();
+        else if (Name=="DataSize")
+            Data_Size=Ztring().From_UTF8(Value).To_int64u();
+        else if (Name=="SegmentSize")
+            Segment_Size=Ztring().From_UTF8(Value).To_int64u();
+        else if (Name=="Segment")
+        {
+            size_t Comma=Value.find(',');
+            if (Comma==string::npos)
+                return false;
+            segment Segment;
+            Segment.XXH3=Value.substr(0, Comma);
+            Segment.MD5_State=Value.substr(Comma+1);
+            Segments.push_back(Segment);
+        }
+        else if (Name=="MD5")
+            MD5=Value;
+    }
+
+    //Coherency
+    if (!Segment_Size || Segments.size()>(Data_Size+Segment_Size-1)/Segment_Size)
+        return false;
+    if (!MD5.empty() && Segments.size()!=(Data_Size+Segment_Size-1)/Segment_Size)
+        return false;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Fixity_Index::Create(const Ztring &FileName)
+{
+    MD5.clear();
+
+    if (!Out.Create(FileName))
+        return false;
+
+    ostringstream Content;
+    Content<<Riff_Fixity_Index_Header<<'\n';
+    Content<<"FileSize="<<File_Size<<'\n';
+    Content<<"FileId="<<File_Id<<'\n';
+    Content<<"FileModified="<<File_Modified<<'\n';
+    Content<<"DataOffset="<<Data_Offset<<'\n';
+    Content<<"DataSize="<<Data_Size<<'\n';
+    Content<<"SegmentSize="<<Segment_Size<<'\n';
+    for (size_t Pos=0; Pos<Segments.size(); Pos++)
+        Content<<"Segment="<<Segments[Pos].XXH3<<','<<Segments[Pos].MD5_State<<'\n';
+    string ToWrite=Content.str();
+    return Out.Write((const int8u*)ToWrite.c_str(), ToWrite.size())==ToWrite.size();
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Fixity_Index::Segment_Add(const segment &Segment)
+{
+    Segments.push_back(Segment);
+
+    //Written as soon as known, an interrupted hashing can be resumed from there
+    string ToWrite="Segment="+Segment.XXH3+','+Segment.MD5_State+'\n';
+    return Out.Write((const int8u*)ToWrite.c_str(), ToWrite.size())==ToWrite.size();
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Fixity_Index::Close(const string &MD5_)
+{
+    MD5=MD5_;
+
+    string ToWrite="MD5="+MD5+'\n';
+    bool Result=Out.Write((const int8u*)ToWrite.c_str(), ToWrite.size())==ToWrite.size();
+    Out.Close();
+    return Result;
+}
+
+//***************************************************************************
+// MD5 context
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+string Riff_Fixity_Index::MD5_State_Get(const MD5Context &Context)
+{
+    ostringstream State;
+    State<<hex<<setfill('0');
+    for (size_t Pos=0; Pos<4; Pos++)
+        State<<setw(8)<<Context.buf[Pos];
+    for (size_t Pos=0; Pos<2; Pos++)
+        State<<setw(8)<<Context.bits[Pos];
+    return State.str();
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Fixity_Index::MD5_State_Set(MD5Context &Context, const string &State)
+{
+    if (State.size()!=48 || State.find_first_not_of("0123456789abcdef")!=string::npos)
+        return false;
+
+    MD5Init(&Context);
+    for (size_t Pos=0; Pos<4; Pos++)
+        Context.buf[Pos]=(uint32_t)strtoul(State.substr(Pos*8, 8).c_str(), NULL, 16);
+    for (size_t Pos=0; Pos<2; Pos++)
+        Context.bits[Pos]=(uint32_t)strtoul(State.substr(32+Pos*8, 8).c_str(), NULL, 16);
+    return (Context.bits[0]&0x1FF)==0; //Whole 64-byte blocks only, nothing is buffered
+}
+
+//***************************************************************************
+// Verification
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool Riff_Fixity_Index::Verify(const Ztring &FileName, int64u Data_Offset_, vector<bool> &Damaged, Riff_Base::progress* Progress)
+{
+    Damaged.clear();
+    if (MD5.empty())
+        return false; //Not complete
+
+    size_t Count=std::thread::hardware_concurrency();
+    if (Count>Riff_Fixity_Index_Threads_Max)
+        Count=Riff_Fixity_Index_Threads_Max;
+    if (Count>Segments.size())
+        Count=Segments.size();
+    if (!Count)
+        Count=1;
+
+    std::atomic<size_t> Next(0);
+    std::atomic<int64u> Done(0);
+    std::atomic<bool> Stop(false);
+    vector<int8u> Damaged_Temp(Segments.size(), 0);
+    vector<fixity_verifier*> Verifiers;
+    for (size_t Pos=0; Pos<Count; Pos++)
+    {
+        Verifiers.push_back(new fixity_verifier(*this, FileName, Data_Offset_, Next, Damaged_Temp, Done, Stop));
+        Verifiers.back()->Run();
+    }
+
+    //Waiting, with progress and cancelation
+    for (size_t Pos=0; Pos<Verifiers.size(); Pos++)
+        while (Verifiers[Pos]->IsRunning())
+        {
+            if (Progress)
+            {
+                Progress->Done_Set(Data_Offset_+Done);
+                if (Progress->Canceling)
+                    Stop=true;
+            }
+            Thread::Sleep(1);
+        }
+    for (size_t Pos=0; Pos<Verifiers.size(); Pos++)
+        delete Verifiers[Pos];
+    if (Stop)
+        return false;
+
+    Damaged.assign(Damaged_Temp.begin(), Damaged_Temp.end());
+    return true;
+}
@@ -0,0 +1,76 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#ifndef Riff_Fixity_IndexH
+#define Riff_Fixity_IndexH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Base.h"
+extern "C"
+{
+#include "MD5/md5.h"
+}
+#include <string>
+#include <vector>
+using namespace ZenLib;
+using namespace std;
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+const int64u RIFF_Fixity_Segment_DefaultSize=64*1024*1024; //Default size of the segments of the audio data with their own digest
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Sidecar file with a digest per segment of the audio data
+//***************************************************************************
+
+class Riff_Fixity_Index
+{
+public:
+    //Constructor/Destructor
+    Riff_Fixity_Index();
+    ~Riff_Fixity_Index();
+
+    //Content
+    struct segment
+    {
+        string          XXH3; //Of the segment
+        string          MD5_State; //MD5 context of the audio data up to the end of the segment, for resuming
+    };
+    int64u              File_Size;
+    string              File_Id; //Device and inode, as in the digest cache
+    int64s              File_Modified; //In nanoseconds since 1970
+    int64u              Data_Offset;
+    int64u              Data_Size;
+    int64u              Segment_Size;
+    vector<segment>     Segments;
+    string              MD5; //Of the audio data, empty if the index is not complete
+
+    //Sidecar
+    static Ztring       FileName_Get(const Ztring &FileName); //Sidecar of an audio file
+    bool                Load(const Ztring &FileName);
+    bool                Create(const Ztring &FileName); //With the segments already known, if resumed
+    bool                Segment_Add(const segment &Segment);
+    bool                Close(const string &MD5); //The index is complete
+
+    //MD5 context at the end of a segment
+    static string       MD5_State_Get(const MD5Context &Context); //Only at a 64-byte boundary
+    static bool         MD5_State_Set(MD5Context &Context, const string &State);
+
+    //Verification of the audio data, the segments are verified in parallel
+    //Damaged: per segment, true if it differs or can not be read
+    bool                Verify(const Ztring &FileName, int64u Data_Offset, vector<bool> &Damaged, Riff_Base::progress* Progress=NULL);
+
+private:
+    File                Out;
+};
+
+#endif
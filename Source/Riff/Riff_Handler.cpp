@@ -10,6 +10,8 @@
 //---------------------------------------------------------------------------
 #include "Riff/Riff_Handler.h"
 #include "Riff/Riff_Chunks.h"
+#include "Riff/Riff_Fixity_Index.h"
+#include "Riff/Riff_Silence.h"
 #include "Common/Codes.h"
 #include <sstream>
 #include <iostream>
@@ -128,7 +130,23 @@ Riff_Handler::Riff_Handler ()
     Overwrite_Reject=false;
     NoPadding_Accept=false;
     NewChunksAtTheEnd=false;
+    InsertRange=false;
+    Reserve_Kind=RIFF_Reserve_Size;
+    Reserve_Value=RIFF_WAVE_FLLR_DefaultSise;
+    ReserveOnly=false;
+    VerifyPlan=false;
     GenerateMD5=false;
+    GenerateHashes=0;
+    Hash_Cache=NULL;
+    FixityIndex=false;
+    FixityVerify=false;
+    Fixity_Segment_Size=RIFF_Fixity_Segment_DefaultSize;
+    ComputeLoudness=false;
+    ComputeLevels=false;
+    Peak_Kernel=0;
+    DetectSilences=false;
+    Silence_Threshold=RIFF_Silence_DefaultThreshold;
+    Silence_Duration=RIFF_Silence_DefaultDuration;
     VerifyMD5=false;
     VerifyMD5_Force=false;
     EmbedMD5=false;
@@ -335,7 +353,7 @@ bool Riff_Handler::Open(const string &FileName)
 }
 
 //---------------------------------------------------------------------------
-bool Riff_Handler::Open_Internal(const string &FileName)
+bool Riff_Handler::Open_Internal(const string &FileName, Riff_Base::global::chunk_strings* MD5Generated, Riff_Base::global::chunk_strings* HashesGenerated)
 {
     //Init
     PerFile_Error.str(string());
@@ -347,6 +365,11 @@ bool Riff_Handler::Open_Internal(const string &FileName)
     //Global info
     delete Chunks; Chunks=new Riff();
     Chunks->Global->File_Name=Ztring().From_UTF8(FileName);
+    Chunks->Global->Progress=&File_Progress;
+    Chunks->Global->MD5Generated=MD5Generated; //Digests of the same audio data, not generated again
+    Chunks->Global->HashesGenerated=HashesGenerated;
+    File_Progress.Total=0; //Canceling is kept, the file may be canceled while queued
+    File_Progress.Done_Set(0);
 
     //Opening file
     if (!File::Exists(Ztring().From_UTF8(FileName)) || !Chunks->Global->In.Open(Ztring().From_UTF8(FileName)))
@@ -356,6 +379,11 @@ bool Riff_Handler::Open_Internal(const string &FileName)
         return false;
     }
     Chunks->Global->File_Size=Chunks->Global->In.Size_Get();
+    Chunks->Global->Block_Size=Chunks->Global->In.Block_Size_Get();
+    if (Chunks->Global->Block_Size<512 || Chunks->Global->Block_Size>RIFF_Block_Alignment_Max || (Chunks->Global->Block_Size&(Chunks->Global->Block_Size-1)))
+        Chunks->Global->Block_Size=RIFF_Block_Alignment; //Unknown or not a power of 2
+    Chunks->Global->In_Map_Open(); //Falling back to buffered reads if not possible
+    File_Progress.Total=Chunks->Global->File_Size;
     Chunks->Global->File_Date=Chunks->Global->In.Created_Local_Get().To_UTF8();
     if (Chunks->Global->File_Date.empty())
         Chunks->Global->File_Date=Chunks->Global->In.Modified_Local_Get().To_UTF8();
@@ -373,9 +401,8 @@ bool Riff_Handler::Open_Internal(const string &FileName)
     }
     catch (exception_canceled &)
     {
-        CriticalSectionLocker(Chunks->Global->CS);
         File_IsCanceled=true;
-        Chunks->Global->Canceling=false;
+        File_Progress.Canceling=false;
         ReturnValue=false;
     }
     catch (exception_read_chunk &e)
@@ -390,8 +417,61 @@ bool Riff_Handler::Open_Internal(const string &FileName)
         ReturnValue=false;
     }
 
-    //Cleanup
+    //Cleanup, the mapping is not kept (limited count of mappings per process, file may be modified by another process)
+    Chunks->Map_Close();
     Chunks->Global->In.Close();
+    if (Chunks->Global->In_Prefetch.Count_Fill)
+    {
+        Riff_Base::global::prefetch &Prefetch=Chunks->Global->In_Prefetch;
+        Information<<Chunks->Global->File_Name.To_UTF8()<<": header prefetch, "<<Prefetch.Count_Memory<<" reads from memory with "<<Prefetch.Count_Fill<<" file reads ("<<(int64s)(Prefetch.Count_Memory-Prefetch.Count_Fill)<<" syscalls saved)"<<endl;
+    }
+    Chunks->Global->In_Prefetch_Clear();
+    if (Chunks->Global->data && (Chunks->Global->data->Hash_Duration || Chunks->Global->data->Hash_Cached))
+    {
+        string Names;
+        if (Chunks->Global->GenerateMD5)
+            Names+=", MD5";
+        if (Chunks->Global->GenerateHashes&Hash_XXH3)
+            Names+=", XXH3";
+        if (Chunks->Global->GenerateHashes&Hash_SHA256)
+            Names+=", SHA256";
+        if (Chunks->Global->GenerateHashes&Hash_BLAKE3)
+            Names+=", BLAKE3";
+        if (Chunks->Global->ComputeLoudness)
+            Names+=", loudness";
+        if (Chunks->Global->ComputeLevels)
+            Names+=", levels";
+        if (Chunks->Global->DetectSilences)
+            Names+=", silences";
+        if (Chunks->Global->data->Hash_Cached)
+            Information<<Chunks->Global->File_Name.To_UTF8()<<": "<<Names.substr(2)<<", from the digest cache"<<endl;
+        else
+            Information<<Chunks->Global->File_Name.To_UTF8()<<": "<<Names.substr(2)<<", "<<Ztring::ToZtring((float64)(Chunks->Global->data->Size-Chunks->Global->data->Fixity_Resumed)/Chunks->Global->data->Hash_Duration, 1).To_UTF8()<<" MB/s"<<endl;
+        if (Chunks->Global->data->Fixity_Resumed)
+            Information<<Chunks->Global->File_Name.To_UTF8()<<": fixity index, resumed at byte "<<Chunks->Global->data->File_Offset+Chunks->Global->data->Fixity_Resumed<<endl;
+        if (Chunks->Global->data->Hash_Cache_Verified)
+            Information<<Chunks->Global->File_Name.To_UTF8()<<": digest cache, verified"<<endl;
+    }
+    if (Chunks->Global->data && !Chunks->Global->data->Fixity_Error.empty())
+    {
+        Errors<<Chunks->Global->File_Name.To_UTF8()<<": "<<Chunks->Global->data->Fixity_Error<<endl;
+        PerFile_Error<<Chunks->Global->data->Fixity_Error<<endl;
+    }
+    else if (Chunks->Global->data && !Chunks->Global->data->Fixity_Damaged.empty())
+    {
+        Errors<<Chunks->Global->File_Name.To_UTF8()<<": fixity index, damaged audio data (bytes "<<Chunks->Global->data->Fixity_Damaged<<")"<<endl;
+        PerFile_Error<<"fixity index, damaged audio data (bytes "<<Chunks->Global->data->Fixity_Damaged<<")"<<endl;
+    }
+    else if (Chunks->Global->data && Chunks->Global->FixityVerify)
+        Information<<Chunks->Global->File_Name.To_UTF8()<<": fixity index, verified ("<<Chunks->Global->data->Fixity_Segments<<" segments)"<<endl;
+    else if (Chunks->Global->data && Chunks->Global->data->Fixity_Segments)
+        Information<<Chunks->Global->File_Name.To_UTF8()<<": fixity index, "<<Chunks->Global->data->Fixity_Segments<<" segments"<<endl;
+    if (Chunks->Global->data && !Chunks->Global->data->Hash_Cache_Mismatch.empty())
+    {
+        //Same size and modification time as when cached, but not the same audio data
+        Errors<<Chunks->Global->File_Name.To_UTF8()<<": digest cache, audio data modified without file modification time change ("<<Chunks->Global->data->Hash_Cache_Mismatch<<")"<<endl;
+        PerFile_Error<<"digest cache, audio data modified without file modification time change ("<<Chunks->Global->data->Hash_Cache_Mismatch<<")"<<endl;
+    }
 
     //ReadOnly check
     if (!File().Open(Ztring().From_UTF8(FileName), File::Access_Write))
@@ -416,6 +496,13 @@ bool Riff_Handler::Open_Internal(const string &FileName)
             PerFile_Information<<"rf64 data size correction"<<endl;
         }
 
+        //Reserve, the file is modified even without other modification
+        if (Chunks->Global->ReserveOnly && !Chunks->Global->Read_Only && Chunks->Reserve_Force())
+        {
+            Information<<Chunks->Global->File_Name.To_UTF8()<<": padding before the audio data smaller than the reserve"<<endl;
+            PerFile_Information<<"padding before the audio data smaller than the reserve"<<endl;
+        }
+
         // Encoding
         if (!Ignore_File_Encoding && Chunks->Global->CSET)
         {
@@ -650,10 +737,54 @@ bool Riff_Handler::Open_Internal(const string &FileName)
          && (!(Chunks->Global->MD5Stored && !Chunks->Global->MD5Stored->Strings["md5stored"].empty())
           || EmbedMD5_AuthorizeOverWritting))
                 Set_Internal("MD5Stored", Chunks->Global->MD5Generated->Strings["md5generated"], rules());
+
+        //Loudness
+        if (Chunks->Global->ComputeLoudness && Chunks->Global->data)
+        {
+            if (!Chunks->Global->data->Loudness_Error.empty())
+            {
+                Errors<<Chunks->Global->File_Name.To_UTF8()<<": loudness, "<<Chunks->Global->data->Loudness_Error<<endl;
+                PerFile_Error<<"loudness, "<<Chunks->Global->data->Loudness_Error<<endl;
+            }
+            for (map<string, string>::iterator Loudness=Chunks->Global->data->Loudness.begin(); Loudness!=Chunks->Global->data->Loudness.end(); ++Loudness)
+                if (Loudness->second.empty())
+                {
+                    Information<<Chunks->Global->File_Name.To_UTF8()<<": loudness, "<<Loudness->first<<" not measurable"<<endl;
+                    PerFile_Information<<"loudness, "<<Loudness->first<<" not measurable"<<endl;
+                }
+                else
+                    Set_Internal(Loudness->first, Loudness->second, rules());
+        }
+
+        //Levels
+        if (Chunks->Global->ComputeLevels && Chunks->Global->data)
+        {
+            if (!Chunks->Global->data->Levels_Error.empty())
+            {
+                Errors<<Chunks->Global->File_Name.To_UTF8()<<": levels, "<<Chunks->Global->data->Levels_Error<<endl;
+                PerFile_Error<<"levels, "<<Chunks->Global->data->Levels_Error<<endl;
+            }
+            for (size_t Pos=0; Pos<Chunks->Global->data->Levels.size(); Pos++)
+            {
+                Information<<Chunks->Global->File_Name.To_UTF8()<<": levels, "<<Chunks->Global->data->Levels[Pos]<<endl;
+                PerFile_Information<<"levels, "<<Chunks->Global->data->Levels[Pos]<<endl;
+            }
+        }
+
+        //Silences
+        if (Chunks->Global->DetectSilences && Chunks->Global->data)
+        {
+            if (!Chunks->Global->data->Silences_Error.empty())
+            {
+                Errors<<Chunks->Global->File_Name.To_UTF8()<<": silences, "<<Chunks->Global->data->Silences_Error<<endl;
+                PerFile_Error<<"silences, "<<Chunks->Global->data->Silences_Error<<endl;
+            }
+            else
+                Cue_Silences_Set();
+        }
     }
 
-    CriticalSectionLocker(Chunks->Global->CS);
-    Chunks->Global->Progress=1;
+    File_Progress.Done_Set(File_Progress.Total);
     
     return ReturnValue;
 }
@@ -663,9 +794,54 @@ bool Riff_Handler::Save()
 {
     CriticalSectionLocker CSL(CS);
 
-    Chunks->Global->CS.Enter();
-    Chunks->Global->Progress=(float)0.05;
-    Chunks->Global->CS.Leave();
+    return Save_Write_Internal() && Save_Verify_Internal();
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Handler::Save_Write()
+{
+    CriticalSectionLocker CSL(CS);
+
+    return Save_Write_Internal();
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Handler::Save_Verify()
+{
+    CriticalSectionLocker CSL(CS);
+
+    return Save_Verify_Internal();
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Handler::Save_Plan(int64u &Rewrite_Size, bool &InPlace, int64u &Insert_Size)
+{
+    CriticalSectionLocker CSL(CS);
+
+    if (Chunks==NULL || IsReadOnly_Get_Internal() || !IsModified_Get_Internal())
+        return false;
+
+    //Without the encoding conversions, they are done only once when saving
+    Save_Modify_Internal();
+    try
+    {
+        Chunks->Write_Plan();
+    }
+    catch (exception &)
+    {
+        return false;
+    }
+
+    Rewrite_Size=Chunks->Global->Out_Plan.Rewrite_Size_Get();
+    InPlace=Chunks->Global->Out_Plan.InPlace;
+    Insert_Size=Chunks->Global->Out_Plan.Insert_Size;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Handler::Save_Write_Internal()
+{
+    File_Progress.Done_Set(File_Progress.Total/20);
     
     //Init
     PerFile_Error.str(string());
@@ -831,20 +1007,7 @@ bool Riff_Handler::Save()
     }
 
     //Modifying the chunks in memory
-    for (size_t Fields_Pos=0; Fields_Pos<Fields_Max; Fields_Pos++)
-        for (size_t Pos=0; Pos<xxxx_Strings_Size[Fields_Pos]; Pos++)
-        {
-            if (!IsOriginal_Internal(xxxx_Strings[Fields_Pos][Pos], Get_Internal(xxxx_Strings[Fields_Pos][Pos])))
-            {
-                Chunks->Modify(Elements::WAVE, Chunk_Name2_Get(xxxx_Strings[Fields_Pos][Pos]), Chunk_Name3_Get(xxxx_Strings[Fields_Pos][Pos]));
-                if (Chunk_Name2_Get(xxxx_Strings[Fields_Pos][Pos])==Elements::WAVE_cue_)
-                {
-                    Chunks->Modify(Elements::WAVE, Chunk_Name2_Get("labl"), Chunk_Name3_Get("labl"));
-                    Chunks->Modify(Elements::WAVE, Chunk_Name2_Get("note"), Chunk_Name3_Get("note"));
-                    Chunks->Modify(Elements::WAVE, Chunk_Name2_Get("ltxt"), Chunk_Name3_Get("ltxt"));
-                }
-            }
-        }
+    Save_Modify_Internal();
 
     //File size management
     if (riff2rf64_Reject && Chunks && Chunks->Global->ds64==NULL && Chunks->Block_Size_Get()>RIFF_Size_Limit)
@@ -911,9 +1074,8 @@ bool Riff_Handler::Save()
         #else
         File::Delete(Chunks->Global->File_Name+__T(".tmp"));
         #endif
-        CriticalSectionLocker(Chunks->Global->CS);
         File_IsCanceled=true;
-        Chunks->Global->Canceling=false;
+        File_Progress.Canceling=false;
         return false;
     }
     catch (exception &e)
@@ -924,23 +1086,137 @@ bool Riff_Handler::Save()
     }
 
     //Log
+    Information<<Chunks->Global->File_Name.To_UTF8()<<": write plan, "<<Chunks->Global->Out_Plan.Rewrite_Size_Get()<<" bytes rewritten, in place: "<<(Chunks->Global->Out_Plan.InPlace?"yes":"no");
+    if (Chunks->Global->Out_Plan.Insert_Size)
+        Information<<", "<<Chunks->Global->Out_Plan.Insert_Size<<" bytes inserted before the audio data";
+    if (Chunks->Global->Out_Plan.Cloned_Size)
+        Information<<", "<<Chunks->Global->Out_Plan.Cloned_Size<<" bytes shared with the original file";
+    Information<<endl;
+    if (!Chunks->Global->Out_Digest_Verified.empty())
+        Information<<Chunks->Global->File_Name.To_UTF8()<<": audio data verified while copied ("<<Chunks->Global->Out_Digest_Verified<<")"<<endl;
     Information<<(Chunks?Chunks->Global->File_Name.To_UTF8():"")<<": Is modified"<<endl;
 
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Handler::Save_Modify_Internal()
+{
+    for (size_t Fields_Pos=0; Fields_Pos<Fields_Max; Fields_Pos++)
+        for (size_t Pos=0; Pos<xxxx_Strings_Size[Fields_Pos]; Pos++)
+        {
+            if (!IsOriginal_Internal(xxxx_Strings[Fields_Pos][Pos], Get_Internal(xxxx_Strings[Fields_Pos][Pos])))
+            {
+                Chunks->Modify(Elements::WAVE, Chunk_Name2_Get(xxxx_Strings[Fields_Pos][Pos]), Chunk_Name3_Get(xxxx_Strings[Fields_Pos][Pos]));
+                if (Chunk_Name2_Get(xxxx_Strings[Fields_Pos][Pos])==Elements::WAVE_cue_)
+                {
+                    Chunks->Modify(Elements::WAVE, Chunk_Name2_Get("labl"), Chunk_Name3_Get("labl"));
+                    Chunks->Modify(Elements::WAVE, Chunk_Name2_Get("note"), Chunk_Name3_Get("note"));
+                    Chunks->Modify(Elements::WAVE, Chunk_Name2_Get("ltxt"), Chunk_Name3_Get("ltxt"));
+                }
+            }
+        }
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Handler::Save_Verify_Internal()
+{
+    if (Chunks==NULL)
+        return false;
+
+    //Only the rewritten bytes, the chunks in memory are the ones written (not if strings were encoded in memory)
+    if (VerifyPlan && Chunks->Global->Out_Plan.InPlace && Write_Encoding==Encoding_Max && Encoding==Encoding_UTF8 && !Write_CodePage)
+        return Save_Verify_Plan_Internal();
+
     //Loading the new file (we are verifying the integraty of the generated file)
     string FileName=Chunks->Global->File_Name.To_UTF8();
-    bool GenerateMD5_Temp=Chunks->Global->GenerateMD5;
-    Chunks->Global->GenerateMD5=false;
-    if (!Open_Internal(FileName) && Chunks==NULL) //There may be an error but file is open (eg MD5 error)
+    bool GenerateMD5_Temp=GenerateMD5;
+    int8u GenerateHashes_Temp=GenerateHashes;
+    bool FixityVerify_Temp=FixityVerify;
+    bool ComputeLoudness_Temp=ComputeLoudness;
+    bool ComputeLevels_Temp=ComputeLevels;
+    bool DetectSilences_Temp=DetectSilences;
+    GenerateMD5=false;
+    GenerateHashes=0;
+    FixityVerify=false;
+    ComputeLoudness=false;
+    ComputeLevels=false;
+    DetectSilences=false;
+
+    //The audio data was not rewritten or matched the digest while copied, digests are kept
+    Riff_Base::global::chunk_strings* MD5Generated=Chunks->Global->MD5Generated;
+    Riff_Base::global::chunk_strings* HashesGenerated=Chunks->Global->HashesGenerated;
+    Chunks->Global->MD5Generated=NULL;
+    Chunks->Global->HashesGenerated=NULL;
+
+    bool Open_Result=Open_Internal(FileName, MD5Generated, HashesGenerated);
+    GenerateMD5=GenerateMD5_Temp;
+    GenerateHashes=GenerateHashes_Temp;
+    FixityVerify=FixityVerify_Temp;
+    ComputeLoudness=ComputeLoudness_Temp;
+    ComputeLevels=ComputeLevels_Temp;
+    DetectSilences=DetectSilences_Temp;
+    if (!Open_Result && Chunks==NULL) //There may be an error but file is open (eg MD5 error)
+    {
+        Errors<<FileName<<": WARNING, the resulting file can not be validated, file may be CORRUPTED"<<endl;
+        PerFile_Error<<"WARNING, the resulting file can not be validated, file may be CORRUPTED"<<endl;
+        return false;
+    }
+    Options_Update_Internal(false);
+
+    File_Progress.Done_Set(File_Progress.Total);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Handler::Save_Verify_Plan_Internal()
+{
+    string FileName=Chunks->Global->File_Name.To_UTF8();
+    Riff_Write_Plan &Plan=Chunks->Global->Out_Plan;
+
+    //Reading back what was written from memory
+    int64u Verified_Size=0;
+    bool IsVerified=Chunks->Global->In.Open(Chunks->Global->File_Name) && Plan.Verify(Chunks->Global->In, Verified_Size);
+    if (IsVerified)
+    {
+        Chunks->Global->File_Date=Chunks->Global->In.Created_Local_Get().To_UTF8();
+        if (Chunks->Global->File_Date.empty())
+            Chunks->Global->File_Date=Chunks->Global->In.Modified_Local_Get().To_UTF8();
+    }
+    Chunks->Global->In.Close();
+    if (!IsVerified)
     {
         Errors<<FileName<<": WARNING, the resulting file can not be validated, file may be CORRUPTED"<<endl;
         PerFile_Error<<"WARNING, the resulting file can not be validated, file may be CORRUPTED"<<endl;
-        Chunks->Global->GenerateMD5=GenerateMD5_Temp;
         return false;
     }
-    Chunks->Global->GenerateMD5=GenerateMD5_Temp;
 
-    CriticalSectionLocker(Chunks->Global->CS);
-    Chunks->Global->Progress=1;
+    //The chunks are where they were written
+    int64u Offset=0;
+    Chunks->Write_Commit(Offset);
+    if (Offset!=Plan.Size)
+    {
+        Errors<<FileName<<": WARNING, the resulting file can not be validated, file may be CORRUPTED"<<endl;
+        PerFile_Error<<"WARNING, the resulting file can not be validated, file may be CORRUPTED"<<endl;
+        return false;
+    }
+
+    //Current values are the initial ones
+    Riff_Base::global::chunk_strings* Chunk_Strings[]={Chunks->Global->bext, Chunks->Global->INFO, Chunks->Global->XMP, Chunks->Global->aXML, Chunks->Global->iXML, Chunks->Global->cuexml, Chunks->Global->MD5Stored};
+    for (size_t Pos=0; Pos<sizeof(Chunk_Strings)/sizeof(Riff_Base::global::chunk_strings*); Pos++)
+        if (Chunk_Strings[Pos])
+            Chunk_Strings[Pos]->Histories.clear();
+    if (Chunks->Global->cue_)
+    {
+        if (!Chunks->Global->cuexml)
+            Chunks->Global->cuexml=new Riff_Base::global::chunk_strings;
+        Chunks->Global->cuexml->Strings["cuexml"]=Cue_Xml_Get();
+    }
+    Core_FromFile=Ztring().From_UTF8(Core_Get_Internal());
+
+    Information<<FileName<<": write plan, "<<Verified_Size<<" bytes verified"<<endl;
+    File_Progress.Done_Set(File_Progress.Total);
 
     return true;
 }
@@ -2735,7 +3011,10 @@ string Riff_Handler::Technical_Header()
     ToReturn<<"Encoding"<<',';
     ToReturn<<"Errors"<<',';
     ToReturn<<"Warnings"<<',';
-    ToReturn<<"Information";
+    ToReturn<<"Information"<<',';
+    ToReturn<<"XXH3Generated"<<',';
+    ToReturn<<"SHA256Generated"<<',';
+    ToReturn<<"BLAKE3Generated";
 
     return ToReturn.str();
 }
@@ -2786,6 +3065,9 @@ string Riff_Handler::Technical_Get()
     if (!Information_Temp.empty())
         Information_Temp.resize(Information_Temp.size()-1);
     List.push_back(Ztring().From_UTF8(Information_Temp));
+    List.push_back(Ztring().From_UTF8(Get_Internal("XXH3Generated")));
+    List.push_back(Ztring().From_UTF8(Get_Internal("SHA256Generated")));
+    List.push_back(Ztring().From_UTF8(Get_Internal("BLAKE3Generated")));
     return List.Read().To_UTF8();
 }
 
@@ -2820,26 +3102,17 @@ string Riff_Handler::FileDate_Get()
 //---------------------------------------------------------------------------
 float Riff_Handler::Progress_Get()
 {
-    CriticalSectionLocker CSL(CS);
-
-    if (Chunks==NULL || Chunks->Global==NULL)
-        return 0;    
-    CriticalSectionLocker(Chunks->Global->CS);
-    if (Chunks->Global->Progress==1)
+    //Lock-free, the file may be in the middle of parsing or writing
+    float Progress=File_Progress.Get();
+    if (Progress==1)
         return (float)0.99; //Must finish opening, see Open()
-    return Chunks->Global->Progress;
+    return Progress;
 }
 
 //---------------------------------------------------------------------------
 void Riff_Handler::Progress_Clear()
 {
-    CriticalSectionLocker CSL(CS);
-
-    if (Chunks==NULL || Chunks->Global==NULL)
-        return;
-
-    CriticalSectionLocker(Chunks->Global->CS);
-    Chunks->Global->Progress=0;
+    File_Progress.Done_Set(0);
 }
 
 //---------------------------------------------------------------------------
@@ -2849,19 +3122,26 @@ bool Riff_Handler::Canceled_Get()
 
     if (Chunks==NULL || Chunks->Global==NULL)
         return false;    
-    CriticalSectionLocker(Chunks->Global->CS);
     return File_IsCanceled;
 }
 
 //---------------------------------------------------------------------------
 void Riff_Handler::Cancel()
 {
-    CriticalSectionLocker CSL(CS);
+    //Lock-free, the file may be in the middle of parsing or writing
+    File_Progress.Canceling=true;
+}
 
-    if (Chunks==NULL || Chunks->Global==NULL)
-        return;    
-    CriticalSectionLocker(Chunks->Global->CS);
-    Chunks->Global->Canceling=true;
+//---------------------------------------------------------------------------
+void Riff_Handler::Cancel_Clear()
+{
+    File_Progress.Canceling=false;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Handler::Progress_Parent_Set(Riff_Base::progress* Parent)
+{
+    File_Progress.Parent=Parent;
 }
 
 //---------------------------------------------------------------------------
@@ -3162,7 +3442,22 @@ void Riff_Handler::Options_Update_Internal(bool Update)
 
     Chunks->Global->NoPadding_Accept=NoPadding_Accept;
     Chunks->Global->NewChunksAtTheEnd=NewChunksAtTheEnd;
+    Chunks->Global->InsertRange=InsertRange;
+    Chunks->Global->Reserve_Kind=Reserve_Kind;
+    Chunks->Global->Reserve_Value=Reserve_Value;
+    Chunks->Global->ReserveOnly=ReserveOnly;
     Chunks->Global->GenerateMD5=GenerateMD5;
+    Chunks->Global->GenerateHashes=GenerateHashes;
+    Chunks->Global->Hash_Cache=Hash_Cache;
+    Chunks->Global->FixityIndex=FixityIndex;
+    Chunks->Global->FixityVerify=FixityVerify;
+    Chunks->Global->Fixity_Segment_Size=Fixity_Segment_Size;
+    Chunks->Global->ComputeLoudness=ComputeLoudness;
+    Chunks->Global->ComputeLevels=ComputeLevels;
+    Chunks->Global->Peak_Kernel=Peak_Kernel;
+    Chunks->Global->DetectSilences=DetectSilences;
+    Chunks->Global->Silence_Threshold=Silence_Threshold;
+    Chunks->Global->Silence_Duration=Silence_Duration;
     Chunks->Global->VerifyMD5=VerifyMD5;
     Chunks->Global->VerifyMD5_Force=VerifyMD5_Force;
     Chunks->Global->EmbedMD5=EmbedMD5;
@@ -3432,6 +3727,15 @@ bool Riff_Handler::Cue_Xml_Set (const string& Xml, rules Rules)
     if(!Cue_Xml_To_Fields(Xml, Points, Labels, Notes, Texts))
         return false;
 
+    Cue_Fields_Set(Points, Labels, Notes, Texts);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Handler::Cue_Fields_Set (const std::vector<Riff_Base::global::chunk_cue_::point>& Points, const std::vector<Riff_Base::global::chunk_labl>& Labels,
+                                   const std::vector<Riff_Base::global::chunk_note>& Notes, const std::vector<Riff_Base::global::chunk_ltxt>& Texts)
+{
     if (!Chunks->Global->cue_)
         Chunks->Global->cue_ = new Riff_Base::global::chunk_cue_();
 
@@ -3445,8 +3749,101 @@ bool Riff_Handler::Cue_Xml_Set (const string& Xml, rules Rules)
     Chunks->Global->adtl->texts=Texts;
 
     Set("cuexml", Cue_Xml_Get(), Chunks->Global->cuexml, NULL, NULL);
+}
 
-    return true;
+//---------------------------------------------------------------------------
+//Labels of the detected silences, cue points with one of them are replaced by a new detection
+static const char* Cue_Silence_Labels[]={"Silence (leading)", "Silence (trailing)", "Silence (gap)", "Silence (whole)"};
+static const size_t Cue_Silence_Labels_Size=sizeof(Cue_Silence_Labels)/sizeof(const char*);
+
+//---------------------------------------------------------------------------
+void Riff_Handler::Cue_Silences_Set ()
+{
+    string FileName=Chunks->Global->File_Name.To_UTF8();
+    const vector<pair<int64u, int64u> > &Silences=Chunks->Global->data->Silences;
+    if (!Chunks->Global->fmt_ || !Chunks->Global->fmt_->sampleRate || !Chunks->Global->fmt_->blockAlignment)
+        return;
+    float64 SampleRate=Chunks->Global->fmt_->sampleRate;
+    int64u Frames=Chunks->Global->data->Size/Chunks->Global->fmt_->blockAlignment;
+
+    std::vector<Riff_Base::global::chunk_cue_::point> Points;
+    std::vector<Riff_Base::global::chunk_labl> Labels;
+    std::vector<Riff_Base::global::chunk_note> Notes;
+    std::vector<Riff_Base::global::chunk_ltxt> Texts;
+    Cue_Xml_To_Fields(Cue_Xml_Get(), Points, Labels, Notes, Texts);
+
+    //Previous detection
+    std::vector<int32u> Previous;
+    for (size_t Pos=0; Pos<Labels.size(); Pos++)
+        if (find(Cue_Silence_Labels, Cue_Silence_Labels+Cue_Silence_Labels_Size, Labels[Pos].label)!=Cue_Silence_Labels+Cue_Silence_Labels_Size)
+            Previous.push_back(Labels[Pos].cuePointId);
+    for (size_t Pos=Points.size(); Pos; Pos--)
+        if (find(Previous.begin(), Previous.end(), Points[Pos-1].id)!=Previous.end())
+            Points.erase(Points.begin()+Pos-1);
+    for (size_t Pos=Labels.size(); Pos; Pos--)
+        if (find(Previous.begin(), Previous.end(), Labels[Pos-1].cuePointId)!=Previous.end())
+            Labels.erase(Labels.begin()+Pos-1);
+    for (size_t Pos=Notes.size(); Pos; Pos--)
+        if (find(Previous.begin(), Previous.end(), Notes[Pos-1].cuePointId)!=Previous.end())
+            Notes.erase(Notes.begin()+Pos-1);
+    for (size_t Pos=Texts.size(); Pos; Pos--)
+        if (find(Previous.begin(), Previous.end(), Texts[Pos-1].cuePointId)!=Previous.end())
+            Texts.erase(Texts.begin()+Pos-1);
+
+    //New cue points, after the existing ones
+    int32u Id=0;
+    for (size_t Pos=0; Pos<Points.size(); Pos++)
+        Id=max(Id, Points[Pos].id);
+    for (size_t Pos=0; Pos<Labels.size(); Pos++)
+        Id=max(Id, Labels[Pos].cuePointId);
+    for (size_t Pos=0; Pos<Notes.size(); Pos++)
+        Id=max(Id, Notes[Pos].cuePointId);
+    for (size_t Pos=0; Pos<Texts.size(); Pos++)
+        Id=max(Id, Texts[Pos].cuePointId);
+    for (size_t Pos=0; Pos<Silences.size(); Pos++)
+    {
+        int64u Start=Silences[Pos].first;
+        int64u Length=Silences[Pos].second;
+        bool IsLeading=Start==0;
+        bool IsTrailing=Start+Length>=Frames;
+        const char* Label=Cue_Silence_Labels[IsLeading?(IsTrailing?3:0):(IsTrailing?1:2)];
+        Information<<FileName<<": silences, "<<Label<<" at "<<Ztring::ToZtring(Start/SampleRate, 3).To_UTF8()<<" s, "<<Ztring::ToZtring(Length/SampleRate, 3).To_UTF8()<<" s long"<<endl;
+        PerFile_Information<<"silences, "<<Label<<" at "<<Ztring::ToZtring(Start/SampleRate, 3).To_UTF8()<<" s, "<<Ztring::ToZtring(Length/SampleRate, 3).To_UTF8()<<" s long"<<endl;
+        if (Start>(int32u)-1)
+        {
+            Information<<FileName<<": silences, "<<Label<<" after the last position of a cue point, not marked"<<endl;
+            PerFile_Information<<"silences, "<<Label<<" after the last position of a cue point, not marked"<<endl;
+            continue;
+        }
+        Id++;
+
+        Riff_Base::global::chunk_cue_::point Point;
+        Point.id=Id;
+        Point.position=(int32u)Start;
+        Point.dataChunkId=0x64617461; //"data"
+        Point.sampleOffset=(int32u)Start;
+        Points.push_back(Point);
+
+        Riff_Base::global::chunk_labl Labl;
+        Labl.cuePointId=Id;
+        Labl.label=Label;
+        Labels.push_back(Labl);
+
+        Riff_Base::global::chunk_ltxt Ltxt; //Duration of the silence
+        Ltxt.cuePointId=Id;
+        Ltxt.sampleLength=Length>(int32u)-1?(int32u)-1:(int32u)Length;
+        Ltxt.purposeId=0x72676E20; //"rgn "
+        Texts.push_back(Ltxt);
+    }
+    if (Silences.empty())
+    {
+        Information<<FileName<<": silences, none"<<endl;
+        PerFile_Information<<"silences, none"<<endl;
+        if (Previous.empty())
+            return;
+    }
+
+    Cue_Fields_Set(Points, Labels, Notes, Texts);
 }
 
 bool Riff_Handler::Cue_Xml_To_Fields (const string& Xml, std::vector<Riff_Base::global::chunk_cue_::point>& Points, std::vector<Riff_Base::global::chunk_labl>& Labels,
@@ -3596,6 +3993,12 @@ Riff_Base::global::chunk_strings** Riff_Handler::chunk_strings_Get(const string
     else if (Field_Lowered=="md5generated")
         return &Chunks->Global->MD5Generated;
 
+    //Other digests
+    else if (Field_Lowered=="xxh3generated"
+          || Field_Lowered=="sha256generated"
+          || Field_Lowered=="blake3generated")
+        return &Chunks->Global->HashesGenerated;
+
     //INFO
     else if (Field.size()==4)
         return &Chunks->Global->INFO;
@@ -22,6 +22,7 @@
 using namespace ZenLib;
 using namespace std;
 class Riff;
+class Riff_Hash_Cache;
 //---------------------------------------------------------------------------
 
 //***************************************************************************
@@ -78,7 +79,10 @@ public:
     //---------------------------------------------------------------------------
     //I/O
     bool            Open            (const string &FileName);
-    bool            Save            ();
+    bool            Save            (); //Save_Write() then Save_Verify()
+    bool            Save_Write      (); //Write modifications, return false if nothing is written
+    bool            Save_Verify     (); //Parse again the written file, or read back only the rewritten bytes if VerifyPlan and written in place
+    bool            Save_Plan       (int64u &Rewrite_Size, bool &InPlace, int64u &Insert_Size); //What Save_Write() would do, return false if nothing would be written
     bool            BackToLastSave  ();
 
     //---------------------------------------------------------------------------
@@ -107,8 +111,10 @@ public:
     string          FileDate_Get();
     float           Progress_Get();
     void            Progress_Clear();
+    void            Progress_Parent_Set(Riff_Base::progress* Parent); //Bytes done are also added to Parent
     bool            Canceled_Get();
     void            Cancel();
+    void            Cancel_Clear(); //At the start of a new batch, for a cancel requested after the end of the previous one
     bool            IsValid_Get();
     bool            IsModified_Get();
     bool            IsReadOnly_Get();
@@ -120,7 +126,23 @@ public:
     bool            Overwrite_Reject;
     bool            NoPadding_Accept;
     bool            NewChunksAtTheEnd;
+    bool            InsertRange;
+    int8u           Reserve_Kind; //riff_reserve
+    int64u          Reserve_Value;
+    bool            ReserveOnly;
+    bool            VerifyPlan; //After an in-place write, only the rewritten bytes are read back
     bool            GenerateMD5;
+    int8u           GenerateHashes; //Riff_Hash flags
+    Riff_Hash_Cache* Hash_Cache; //Owned by the caller, NULL if none
+    bool            FixityIndex;
+    bool            FixityVerify;
+    int64u          Fixity_Segment_Size;
+    bool            ComputeLoudness;
+    bool            ComputeLevels;
+    int8u           Peak_Kernel; //Riff_Peak::kernel
+    bool            DetectSilences;
+    float64         Silence_Threshold; //dBFS
+    float64         Silence_Duration; //Seconds
     bool            VerifyMD5;
     bool            VerifyMD5_Force;
     bool            EmbedMD5;
@@ -149,7 +171,11 @@ public:
 private:
     //---------------------------------------------------------------------------
     //Helpers - Internal
-    bool      Open_Internal              (const string &FileName);
+    bool      Open_Internal              (const string &FileName, Riff_Base::global::chunk_strings* MD5Generated=NULL, Riff_Base::global::chunk_strings* HashesGenerated=NULL);
+    bool      Save_Write_Internal        ();
+    bool      Save_Verify_Internal       ();
+    bool      Save_Verify_Plan_Internal  ();
+    void      Save_Modify_Internal       ();
     string    Get_Internal               (const string &Field);
     bool      Set_Internal               (const string &Field, const string &Value, rules Rules);
     bool      Remove_Internal            (const string &Field);
@@ -162,6 +188,11 @@ private:
     void      Options_Update_Internal    (bool Update=true);
     string    Cue_Xml_Get                ();
     bool      Cue_Xml_Set                (const string& Xml, rules Rules);
+    void      Cue_Fields_Set             (const std::vector<Riff_Base::global::chunk_cue_::point>& Points,
+                                          const std::vector<Riff_Base::global::chunk_labl>& Labels,
+                                          const std::vector<Riff_Base::global::chunk_note>& Notes,
+                                          const std::vector<Riff_Base::global::chunk_ltxt>& Texts);
+    void      Cue_Silences_Set           ();
     bool      Cue_Xml_To_Fields          (const string& Xml, std::vector<Riff_Base::global::chunk_cue_::point>& Points,
                                                              std::vector<Riff_Base::global::chunk_labl>& Labels,
                                                              std::vector<Riff_Base::global::chunk_note>& Notes,
@@ -190,6 +221,7 @@ private:
     Riff*           Chunks;
     bool            File_IsValid;
     bool            File_IsCanceled;
+    Riff_Base::progress File_Progress;
     CriticalSection CS;
 };
 
@@ -0,0 +1,260 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Hash_Cache.h"
+#include "ZenLib/File.h"
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <sys/types.h>
+#include <sys/stat.h>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+//One line per file, tab separated:
+//Id, Size, Modified, Data_Offset, Data_Size, Hashed, name=digest (comma separated), FileName
+static const char* Riff_Hash_Cache_Header="BWF MetaEdit digest cache 1";
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Key
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool Riff_Hash_Cache::key::Get(const string &FileName)
+{
+    #ifdef _WIN32
+        struct _stat64 Stat;
+        #ifdef UNICODE
+            if (_wstat64(Ztring().From_UTF8(FileName).c_str(), &Stat))
+        #else //UNICODE
+            if (_stat64(Ztring().From_UTF8(FileName).c_str(), &Stat))
+        #endif //UNICODE
+            return false;
+        Id=FileName; //No inode
+        Modified=(int64s)Stat.st_mtime*1000000000;
+    #else //_WIN32
+        struct stat Stat;
+        if (stat(Ztring().From_UTF8(FileName).To_Local().c_str(), &Stat))
+            return false;
+        Id=Ztring().From_Number((int64u)Stat.st_dev).To_UTF8()+'-'+Ztring().From_Number((int64u)Stat.st_ino).To_UTF8();
+        #if defined(__APPLE__)
+            Modified=(int64s)Stat.st_mtimespec.tv_sec*1000000000+Stat.st_mtimespec.tv_nsec;
+        #else //__APPLE__
+            Modified=(int64s)Stat.st_mtim.tv_sec*1000000000+Stat.st_mtim.tv_nsec;
+        #endif //__APPLE__
+    #endif //_WIN32
+    Size=(int64u)Stat.st_size;
+
+    return true;
+}
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Riff_Hash_Cache::Riff_Hash_Cache(const Ztring &FileName_, float32 Rehash_Ratio_)
+{
+    FileName=FileName_;
+    Rehash_Ratio=Rehash_Ratio_;
+    IsModified=false;
+}
+
+//---------------------------------------------------------------------------
+Riff_Hash_Cache::~Riff_Hash_Cache()
+{
+}
+
+//***************************************************************************
+// Load/Save
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool Riff_Hash_Cache::Load()
+{
+    CriticalSectionLocker CSL(CS);
+
+    Entries.clear();
+    Ids.clear();
+    IsModified=false;
+    if (!File::Exists(FileName))
+        return true; //Nothing cached yet
+
+    File F;
+    if (!F.Open(FileName))
+        return false;
+    int64u Size=F.Size_Get();
+    string Content;
+    Content.resize((size_t)Size);
+    if (Size && F.Read((int8u*)&Content[0], (size_t)Size)!=Size)
+        return false;
+    F.Close();
+
+    istringstream Lines(Content);
+    string Line;
+    if (!getline(Lines, Line) || Line!=Riff_Hash_Cache_Header)
+        return false; //Unknown format, not overwritten
+    while (getline(Lines, Line))
+    {
+        vector<string> Fields;
+        size_t Begin=0;
+        while (Fields.size()<7)
+        {
+            size_t End=Line.find('\t', Begin);
+            if (End==string::npos)
+                break;
+            Fields.push_back(Line.substr(Begin, End-Begin));
+            Begin=End+1;
+        }
+        if (Fields.size()!=7)
+            continue; //Malformed line, ignored
+
+        entry &Entry=Entries[Fields[0]];
+        Entry.Size=Ztring().From_UTF8(Fields[1]).To_int64u();
+        Entry.Modified=Ztring().From_UTF8(Fields[2]).To_int64s();
+        Entry.Data_Offset=Ztring().From_UTF8(Fields[3]).To_int64u();
+        Entry.Data_Size=Ztring().From_UTF8(Fields[4]).To_int64u();
+        Entry.Hashed=Ztring().From_UTF8(Fields[5]).To_int64s();
+        Entry.FileName=Line.substr(Begin);
+        Ids[Entry.FileName]=Fields[0];
+        istringstream Digests(Fields[6]);
+        string Digest;
+        while (getline(Digests, Digest, ','))
+        {
+            size_t Equal=Digest.find('=');
+            if (Equal!=string::npos)
+                Entry.Digests[Digest.substr(0, Equal)]=Digest.substr(Equal+1);
+        }
+    }
+
+    //Files to hash again, the ones hashed the longest time ago first
+    if (Rehash_Ratio>0 && !Entries.empty())
+    {
+        vector<pair<int64s, entry*> > ByHashed;
+        for (entries::iterator Entry=Entries.begin(); Entry!=Entries.end(); ++Entry)
+            ByHashed.push_back(make_pair(Entry->second.Hashed, &Entry->second));
+        stable_sort(ByHashed.begin(), ByHashed.end(), [](const pair<int64s, entry*> &A, const pair<int64s, entry*> &B) {return A.first<B.first;});
+        size_t Rehash_Count=(size_t)ceil(ByHashed.size()*(Rehash_Ratio>1?1:Rehash_Ratio));
+        for (size_t Pos=0; Pos<Rehash_Count; Pos++)
+            ByHashed[Pos].second->Rehash=true;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Hash_Cache::Save()
+{
+    CriticalSectionLocker CSL(CS);
+
+    if (!IsModified)
+        return true;
+
+    ostringstream Content;
+    Content<<Riff_Hash_Cache_Header<<'\n';
+    for (entries::iterator Entry=Entries.begin(); Entry!=Entries.end(); ++Entry)
+    {
+        Content<<Entry->first<<'\t'<<Entry->second.Size<<'\t'<<Entry->second.Modified<<'\t'<<Entry->second.Data_Offset<<'\t'<<Entry->second.Data_Size<<'\t'<<Entry->second.Hashed<<'\t';
+        for (digests::iterator Digest=Entry->second.Digests.begin(); Digest!=Entry->second.Digests.end(); ++Digest)
+            Content<<(Digest==Entry->second.Digests.begin()?"":",")<<Digest->first<<'='<<Digest->second;
+        Content<<'\t'<<Entry->second.FileName<<'\n';
+    }
+
+    //Written aside then renamed, a crash does not leave a truncated cache
+    Ztring FileName_Temp=FileName+__T(".tmp");
+    File F;
+    if (!F.Create(FileName_Temp))
+        return false;
+    string ToWrite=Content.str();
+    if (F.Write((const int8u*)ToWrite.c_str(), ToWrite.size())!=ToWrite.size())
+    {
+        F.Close();
+        File::Delete(FileName_Temp);
+        return false;
+    }
+    F.Close();
+    if (!File::Move(FileName_Temp, FileName, true))
+    {
+        File::Delete(FileName_Temp);
+        return false;
+    }
+
+    IsModified=false;
+    return true;
+}
+
+//***************************************************************************
+// Digests
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool Riff_Hash_Cache::Get(const string &FileName, int64u Data_Offset, int64u Data_Size, digests &Digests, bool &Rehash)
+{
+    key Key;
+    if (!Key.Get(FileName))
+        return false;
+
+    CriticalSectionLocker CSL(CS);
+
+    entries::iterator Entry=Entries.find(Key.Id);
+    if (Entry==Entries.end()
+     || Entry->second.Size!=Key.Size
+     || Entry->second.Modified!=Key.Modified
+     || Entry->second.Data_Offset!=Data_Offset
+     || Entry->second.Data_Size!=Data_Size)
+        return false;
+
+    Digests=Entry->second.Digests;
+    Rehash=Entry->second.Rehash;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Hash_Cache::Set(const string &FileName, int64u Data_Offset, int64u Data_Size, const digests &Digests, bool IsHashed)
+{
+    key Key;
+    if (!Key.Get(FileName))
+        return;
+
+    CriticalSectionLocker CSL(CS);
+
+    //The file may have a new inode (e.g. after a copy into a temporary file)
+    int64s Hashed=0;
+    map<string, string>::iterator Id=Ids.find(FileName);
+    if (Id!=Ids.end() && Id->second!=Key.Id)
+    {
+        entries::iterator Entry_Old=Entries.find(Id->second);
+        if (Entry_Old!=Entries.end())
+        {
+            Hashed=Entry_Old->second.Hashed;
+            Entries.erase(Entry_Old);
+        }
+    }
+    Ids[FileName]=Key.Id;
+
+    entry &Entry=Entries[Key.Id];
+    if (Entry.Hashed)
+        Hashed=Entry.Hashed;
+    if (Entry.Size!=Key.Size || Entry.Modified!=Key.Modified || Entry.Data_Offset!=Data_Offset || Entry.Data_Size!=Data_Size)
+        Entry.Digests.clear(); //Outdated
+    Entry.Size=Key.Size;
+    Entry.Modified=Key.Modified;
+    Entry.Data_Offset=Data_Offset;
+    Entry.Data_Size=Data_Size;
+    Entry.Hashed=(IsHashed || !Hashed)?(int64s)time(NULL):Hashed;
+    Entry.FileName=FileName;
+    for (digests::const_iterator Digest=Digests.begin(); Digest!=Digests.end(); ++Digest)
+        Entry.Digests[Digest->first]=Digest->second;
+    Entry.Rehash=false;
+    IsModified=true;
+}
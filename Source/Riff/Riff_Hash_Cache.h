@@ -0,0 +1,92 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#ifndef Riff_Hash_CacheH
+#define Riff_Hash_CacheH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "ZenLib/Ztring.h"
+#include "ZenLib/CriticalSection.h"
+#include <string>
+#include <map>
+using namespace ZenLib;
+using namespace std;
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// On-disk cache of the digests of the data chunks
+//***************************************************************************
+
+class Riff_Hash_Cache
+{
+public:
+    //Constructor/Destructor
+    Riff_Hash_Cache(const Ztring &FileName, float32 Rehash_Ratio=0); //Rehash_Ratio: part of the cached files hashed again, the ones hashed the longest time ago
+    ~Riff_Hash_Cache();
+
+    //Load/Save
+    bool            Load();
+    bool            Save(); //Only if modified
+
+    //Digests
+    typedef map<string, string> digests; //Key is the field name (e.g. md5generated)
+    bool            Get(const string &FileName, int64u Data_Offset, int64u Data_Size, digests &Digests, bool &Rehash); //False if unknown or outdated
+    void            Set(const string &FileName, int64u Data_Offset, int64u Data_Size, const digests &Digests, bool IsHashed=true); //IsHashed: false if the digests are carried from a previous read of the same audio data
+
+    //Identity of the file content, without reading it
+    struct key
+    {
+        string      Id; //Device and inode, the file name if not available
+        int64u      Size;
+        int64s      Modified; //In nanoseconds since 1970
+
+        bool        Get(const string &FileName);
+
+        key()
+        {
+            Size=0;
+            Modified=0;
+        }
+    };
+
+private:
+
+    struct entry
+    {
+        int64u      Size;
+        int64s      Modified;
+        int64u      Data_Offset;
+        int64u      Data_Size;
+        int64s      Hashed; //In seconds since 1970, last time the audio data was read
+        string      FileName; //Informative
+        digests     Digests;
+        bool        Rehash;
+
+        entry()
+        {
+            Size=0;
+            Modified=0;
+            Data_Offset=0;
+            Data_Size=0;
+            Hashed=0;
+            Rehash=false;
+        }
+    };
+    typedef map<string, entry> entries; //Key is key::Id
+    entries         Entries;
+    map<string, string> Ids; //Key is the file name
+    Ztring          FileName;
+    float32         Rehash_Ratio;
+    bool            IsModified;
+    CriticalSection CS;
+};
+
+#endif
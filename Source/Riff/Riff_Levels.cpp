@@ -0,0 +1,102 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Levels.h"
+#include <cmath>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Riff_Levels::Riff_Levels(int16u FormatTag_, int16u Channels_, int32u SampleRate_, int16u BitsPerSample_, int16u BlockAlign_, float64 Silence_Threshold)
+    : Riff_Analyzer_PCM(FormatTag_, Channels_, SampleRate_, BitsPerSample_, BlockAlign_)
+{
+    Frames=0;
+    Silence_Frames=0;
+    Clip_Positive=1;
+    Silence_Threshold_Linear=pow(10.0, Silence_Threshold/20);
+
+    if (!IsSupported())
+        return;
+
+    //Integer PCM can not reach +1.0, the highest code is one step below
+    if (FormatTag==1)
+        Clip_Positive=1-ldexp(1.0, -(int)(BitsPerSample?BitsPerSample:(BlockAlign/Channels)*8)+1);
+
+    Peaks.resize(Channels);
+    Sums.resize(Channels);
+    Sums_Square.resize(Channels);
+    Clipped.resize(Channels);
+    Block_Loud.resize(Block_Frames);
+}
+
+//---------------------------------------------------------------------------
+Riff_Levels::~Riff_Levels()
+{
+}
+
+//***************************************************************************
+// Measurement
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void Riff_Levels::Process(const float64* Block, size_t Frames_Count)
+{
+    int8u* Loud=&Block_Loud[0];
+    for (size_t Frame=0; Frame<Frames_Count; Frame++)
+        Loud[Frame]=0;
+
+    for (size_t Channel=0; Channel<Channels; Channel++)
+    {
+        const float64* In=&Block[Channel*Frames_Count];
+        float64 Peak=Peaks[Channel];
+        float64 Sum=0, Sum_Square=0;
+        int64u Clip=0;
+        for (size_t Frame=0; Frame<Frames_Count; Frame++)
+        {
+            float64 Value=In[Frame];
+            float64 Value_Abs=fabs(Value);
+            Peak=Value_Abs>Peak?Value_Abs:Peak;
+            Sum+=Value;
+            Sum_Square+=Value*Value;
+            Clip+=(Value>=Clip_Positive || Value<=-1)?1:0;
+            Loud[Frame]|=Value_Abs>=Silence_Threshold_Linear?1:0;
+        }
+        Peaks[Channel]=Peak;
+        Sums[Channel]+=Sum;
+        Sums_Square[Channel]+=Sum_Square;
+        Clipped[Channel]+=Clip;
+    }
+
+    size_t Silent=0;
+    for (size_t Frame=0; Frame<Frames_Count; Frame++)
+        Silent+=Loud[Frame]?0:1;
+    Silence_Frames+=Silent;
+    Frames+=Frames_Count;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Levels::Finish()
+{
+    if (!IsSupported())
+        return;
+
+    Channels_Results.resize(Channels);
+    for (size_t Channel=0; Channel<Channels; Channel++)
+    {
+        channel &Result=Channels_Results[Channel];
+        Result.Peak=Peaks[Channel]?20*log10(Peaks[Channel]):-HUGE_VAL;
+        Result.RMS=(Frames && Sums_Square[Channel])?10*log10(Sums_Square[Channel]/Frames):-HUGE_VAL;
+        Result.DC_Offset=Frames?Sums[Channel]/Frames*100:0;
+        Result.Clipped=Clipped[Channel];
+    }
+}
@@ -0,0 +1,74 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#ifndef Riff_LevelsH
+#define Riff_LevelsH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Analyzer.h"
+#include <vector>
+using namespace ZenLib;
+using namespace std;
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+const float64 RIFF_Levels_Silence_DefaultThreshold=-60; //dBFS, a frame is silent if all its samples are below
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Sample peak, RMS, DC offset, clipping and silence of PCM audio data
+//***************************************************************************
+
+class Riff_Levels : public Riff_Analyzer_PCM
+{
+public:
+    //Constructor/Destructor
+    Riff_Levels(int16u FormatTag, int16u Channels, int32u SampleRate, int16u BitsPerSample, int16u BlockAlign, float64 Silence_Threshold=RIFF_Levels_Silence_DefaultThreshold);
+    ~Riff_Levels();
+
+    //Measurement
+    void            Finish();
+
+    //Results, per channel
+    struct channel
+    {
+        float64     Peak; //dBFS, -inf if digital silence
+        float64     RMS; //dBFS, -inf if digital silence
+        float64     DC_Offset; //Mean, in percent of the full scale
+        int64u      Clipped; //Count of samples at the full scale
+
+        channel()
+        {
+            Peak=0;
+            RMS=0;
+            DC_Offset=0;
+            Clipped=0;
+        }
+    };
+    vector<channel> Channels_Results;
+    int64u          Frames;
+    int64u          Silence_Frames; //Count of silent frames
+
+private:
+    //Per channel
+    vector<float64> Peaks; //Linear
+    vector<float64> Sums;
+    vector<float64> Sums_Square;
+    vector<int64u>  Clipped;
+    float64         Clip_Positive; //Highest positive value of the format
+    float64         Silence_Threshold_Linear;
+    vector<int8u>   Block_Loud; //Per frame, not silent in at least one channel
+
+    //Measurement
+    void            Process(const float64* Block, size_t Frames);
+};
+
+#endif
@@ -0,0 +1,287 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Loudness.h"
+#include <algorithm>
+#include <cmath>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+const float64 Loudness_Pi=3.14159265358979323846;
+const float64 Loudness_Offset=-0.691; //BS.1770, K-weighted mean square to LUFS
+const float64 Loudness_AbsoluteGate=-70; //LUFS
+const float64 Loudness_RelativeGate=-10; //LU, integrated loudness
+const float64 Loudness_RelativeGate_Range=-20; //LU, loudness range
+const size_t  Loudness_Momentary_SubBlocks=4; //400 ms
+const size_t  Loudness_ShortTerm_SubBlocks=30; //3 s
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+static float64 Loudness_FromEnergy(float64 Energy)
+{
+    return Loudness_Offset+10*log10(Energy);
+}
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Riff_Loudness::Riff_Loudness(int16u FormatTag_, int16u Channels_, int32u SampleRate_, int16u BitsPerSample_, int16u BlockAlign_, Riff_Peak::kernel Peak_Kernel)
+    : Riff_Analyzer_PCM(FormatTag_, Channels_, SampleRate_, BitsPerSample_, BlockAlign_),
+      Peak(FormatTag_, Channels_, SampleRate_, BitsPerSample_, BlockAlign_, Peak_Kernel)
+{
+    IntegratedLoudness_IsValid=false;
+    IntegratedLoudness=0;
+    LoudnessRange_IsValid=false;
+    LoudnessRange=0;
+    MaxTruePeakLevel_IsValid=false;
+    MaxTruePeakLevel=0;
+    MaxMomentaryLoudness_IsValid=false;
+    MaxMomentaryLoudness=0;
+    MaxShortTermLoudness_IsValid=false;
+    MaxShortTermLoudness=0;
+    SubBlock_Frames=0;
+    SubBlock_Sum=0;
+
+    if (!IsSupported())
+        return;
+
+    //K-weighting, pre-filter (high shelf) and RLB filter (high pass), for any sample rate
+    float64 K=tan(Loudness_Pi*1681.974450955533/SampleRate);
+    float64 Q=0.7071752369554196;
+    float64 Vh=pow(10.0, 3.999843853973347/20);
+    float64 Vb=pow(Vh, 0.4996667741545416);
+    float64 A0=1+K/Q+K*K;
+    Shelf_B[0]=(Vh+Vb*K/Q+K*K)/A0;
+    Shelf_B[1]=2*(K*K-Vh)/A0;
+    Shelf_B[2]=(Vh-Vb*K/Q+K*K)/A0;
+    Shelf_A[0]=1;
+    Shelf_A[1]=2*(K*K-1)/A0;
+    Shelf_A[2]=(1-K/Q+K*K)/A0;
+    K=tan(Loudness_Pi*38.13547087602444/SampleRate);
+    Q=0.5003270373238773;
+    A0=1+K/Q+K*K;
+    HighPass_B[0]=1;
+    HighPass_B[1]=-2;
+    HighPass_B[2]=1;
+    HighPass_A[0]=1;
+    HighPass_A[1]=2*(K*K-1)/A0;
+    HighPass_A[2]=(1-K/Q+K*K)/A0;
+    Shelf_Z1.resize(Channels);
+    Shelf_Z2.resize(Channels);
+    HighPass_Z1.resize(Channels);
+    HighPass_Z2.resize(Channels);
+
+    //Channel weights, WAVE order (L R C LFE Ls Rs) for 5.1
+    Weights.assign(Channels, 1.0);
+    if (Channels==6)
+    {
+        Weights[3]=0; //LFE
+        Weights[4]=1.41;
+        Weights[5]=1.41;
+    }
+
+    //Sub-blocks
+    SubBlock_Size=SampleRate/10;
+
+    //Work buffers
+    Block_Out.resize(Block_Frames);
+    Block_Energy.resize(Block_Frames);
+}
+
+//---------------------------------------------------------------------------
+Riff_Loudness::~Riff_Loudness()
+{
+}
+
+//***************************************************************************
+// Measurement
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void Riff_Loudness::Process_Frames(const int8u* Buffer, size_t Frames)
+{
+    Peak.Update(Buffer, Frames*BlockAlign);
+    Riff_Analyzer_PCM::Process_Frames(Buffer, Frames);
+}
+
+//---------------------------------------------------------------------------
+void Riff_Loudness::Process(const float64* Block, size_t Frames)
+{
+    float64* Out=&Block_Out[0];
+    float64* Energy=&Block_Energy[0];
+    for (size_t Frame=0; Frame<Frames; Frame++)
+        Energy[Frame]=0;
+
+    for (size_t Channel=0; Channel<Channels; Channel++)
+    {
+        const float64* In=&Block[Channel*Frames];
+
+        //K-weighting (transposed direct form II), recursive so per sample
+        float64 Shelf_S1=Shelf_Z1[Channel], Shelf_S2=Shelf_Z2[Channel];
+        float64 HighPass_S1=HighPass_Z1[Channel], HighPass_S2=HighPass_Z2[Channel];
+        for (size_t Frame=0; Frame<Frames; Frame++)
+        {
+            float64 X=In[Frame];
+            float64 Y=Shelf_B[0]*X+Shelf_S1;
+            Shelf_S1=Shelf_B[1]*X-Shelf_A[1]*Y+Shelf_S2;
+            Shelf_S2=Shelf_B[2]*X-Shelf_A[2]*Y;
+            X=Y;
+            Y=HighPass_B[0]*X+HighPass_S1;
+            HighPass_S1=HighPass_B[1]*X-HighPass_A[1]*Y+HighPass_S2;
+            HighPass_S2=HighPass_B[2]*X-HighPass_A[2]*Y;
+            Out[Frame]=Y;
+        }
+        Shelf_Z1[Channel]=Shelf_S1;
+        Shelf_Z2[Channel]=Shelf_S2;
+        HighPass_Z1[Channel]=HighPass_S1;
+        HighPass_Z2[Channel]=HighPass_S2;
+
+        //Mean square, weighted
+        float64 Weight=Weights[Channel];
+        if (Weight)
+            for (size_t Frame=0; Frame<Frames; Frame++)
+                Energy[Frame]+=Weight*Out[Frame]*Out[Frame];
+    }
+
+    //Sub-blocks
+    size_t Frame=0;
+    while (Frame<Frames)
+    {
+        size_t ToDo=SubBlock_Size-SubBlock_Frames;
+        if (ToDo>Frames-Frame)
+            ToDo=Frames-Frame;
+        float64 Sum=0;
+        for (size_t Pos=0; Pos<ToDo; Pos++)
+            Sum+=Energy[Frame+Pos];
+        SubBlock_Sum+=Sum;
+        SubBlock_Frames+=ToDo;
+        Frame+=ToDo;
+        if (SubBlock_Frames==SubBlock_Size)
+        {
+            SubBlocks.push_back(SubBlock_Sum);
+            SubBlock_Sum=0;
+            SubBlock_Frames=0;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+void Riff_Loudness::Finish()
+{
+    if (!IsSupported())
+        return;
+
+    //True peak
+    if (Peak.True_Peak>0)
+    {
+        MaxTruePeakLevel=20*log10(Peak.True_Peak);
+        MaxTruePeakLevel_IsValid=true;
+    }
+
+    //Momentary (400 ms) blocks, overlapping by 75%, are also the gating blocks of the integrated loudness
+    vector<float64> Momentary;
+    float64 Window=0;
+    for (size_t Pos=0; Pos<SubBlocks.size(); Pos++)
+    {
+        Window+=SubBlocks[Pos];
+        if (Pos>=Loudness_Momentary_SubBlocks)
+            Window-=SubBlocks[Pos-Loudness_Momentary_SubBlocks];
+        if (Pos+1>=Loudness_Momentary_SubBlocks)
+            Momentary.push_back(Window>0?Window/(Loudness_Momentary_SubBlocks*SubBlock_Size):0); //Mean square
+    }
+
+    //Short-term (3 s) windows, every 100 ms
+    vector<float64> ShortTerm;
+    Window=0;
+    for (size_t Pos=0; Pos<SubBlocks.size(); Pos++)
+    {
+        Window+=SubBlocks[Pos];
+        if (Pos>=Loudness_ShortTerm_SubBlocks)
+            Window-=SubBlocks[Pos-Loudness_ShortTerm_SubBlocks];
+        if (Pos+1>=Loudness_ShortTerm_SubBlocks)
+            ShortTerm.push_back(Window>0?Window/(Loudness_ShortTerm_SubBlocks*SubBlock_Size):0);
+    }
+
+    //Maximums
+    float64 Max=0;
+    for (size_t Pos=0; Pos<Momentary.size(); Pos++)
+        if (Momentary[Pos]>Max)
+            Max=Momentary[Pos];
+    if (Max>0)
+    {
+        MaxMomentaryLoudness=Loudness_FromEnergy(Max);
+        MaxMomentaryLoudness_IsValid=true;
+    }
+    Max=0;
+    for (size_t Pos=0; Pos<ShortTerm.size(); Pos++)
+        if (ShortTerm[Pos]>Max)
+            Max=ShortTerm[Pos];
+    if (Max>0)
+    {
+        MaxShortTermLoudness=Loudness_FromEnergy(Max);
+        MaxShortTermLoudness_IsValid=true;
+    }
+
+    //Integrated loudness, absolute then relative gating
+    float64 AbsoluteGate=pow(10.0, (Loudness_AbsoluteGate-Loudness_Offset)/10);
+    float64 Sum=0;
+    size_t Count=0;
+    for (size_t Pos=0; Pos<Momentary.size(); Pos++)
+        if (Momentary[Pos]>AbsoluteGate)
+        {
+            Sum+=Momentary[Pos];
+            Count++;
+        }
+    if (Count)
+    {
+        float64 RelativeGate=Sum/Count*pow(10.0, Loudness_RelativeGate/10);
+        Sum=0;
+        Count=0;
+        for (size_t Pos=0; Pos<Momentary.size(); Pos++)
+            if (Momentary[Pos]>AbsoluteGate && Momentary[Pos]>RelativeGate)
+            {
+                Sum+=Momentary[Pos];
+                Count++;
+            }
+        if (Count)
+        {
+            IntegratedLoudness=Loudness_FromEnergy(Sum/Count);
+            IntegratedLoudness_IsValid=true;
+        }
+    }
+
+    //Loudness range, from the short-term loudness distribution (EBU Tech 3342)
+    Sum=0;
+    Count=0;
+    for (size_t Pos=0; Pos<ShortTerm.size(); Pos++)
+        if (ShortTerm[Pos]>AbsoluteGate)
+        {
+            Sum+=ShortTerm[Pos];
+            Count++;
+        }
+    if (Count)
+    {
+        float64 RelativeGate=Sum/Count*pow(10.0, Loudness_RelativeGate_Range/10);
+        vector<float64> Gated;
+        for (size_t Pos=0; Pos<ShortTerm.size(); Pos++)
+            if (ShortTerm[Pos]>AbsoluteGate && ShortTerm[Pos]>RelativeGate)
+                Gated.push_back(ShortTerm[Pos]);
+        if (!Gated.empty())
+        {
+            sort(Gated.begin(), Gated.end());
+            float64 Low=Gated[(size_t)floor((Gated.size()-1)*0.10+0.5)];
+            float64 High=Gated[(size_t)floor((Gated.size()-1)*0.95+0.5)];
+            LoudnessRange=Loudness_FromEnergy(High)-Loudness_FromEnergy(Low);
+            LoudnessRange_IsValid=true;
+        }
+    }
+}
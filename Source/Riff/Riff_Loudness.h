@@ -0,0 +1,74 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#ifndef Riff_LoudnessH
+#define Riff_LoudnessH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Analyzer.h"
+#include "Riff/Riff_Peak.h"
+#include <vector>
+using namespace ZenLib;
+using namespace std;
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// EBU R 128 loudness of PCM audio data (ITU-R BS.1770-4, EBU Tech 3341/3342)
+//***************************************************************************
+
+class Riff_Loudness : public Riff_Analyzer_PCM
+{
+public:
+    //Constructor/Destructor
+    Riff_Loudness(int16u FormatTag, int16u Channels, int32u SampleRate, int16u BitsPerSample, int16u BlockAlign, Riff_Peak::kernel Peak_Kernel=Riff_Peak::Kernel_Auto);
+    ~Riff_Loudness();
+
+    //Measurement
+    void            Finish();
+
+    //Results, false if not measurable (e.g. silence or too short)
+    bool            IntegratedLoudness_IsValid;
+    float64         IntegratedLoudness; //LUFS
+    bool            LoudnessRange_IsValid;
+    float64         LoudnessRange; //LU
+    bool            MaxTruePeakLevel_IsValid;
+    float64         MaxTruePeakLevel; //dBTP
+    bool            MaxMomentaryLoudness_IsValid;
+    float64         MaxMomentaryLoudness; //LUFS
+    bool            MaxShortTermLoudness_IsValid;
+    float64         MaxShortTermLoudness; //LUFS
+
+private:
+    //K-weighting, 2 biquads per channel
+    float64         Shelf_B[3], Shelf_A[3];
+    float64         HighPass_B[3], HighPass_A[3];
+    vector<float64> Shelf_Z1, Shelf_Z2, HighPass_Z1, HighPass_Z2;
+    vector<float64> Weights; //Per channel, LFE excluded
+
+    //100 ms sub-blocks, the 400 ms and 3 s windows are built from them
+    size_t          SubBlock_Size; //In frames
+    size_t          SubBlock_Frames;
+    float64         SubBlock_Sum; //Weighted, of the sub-block in progress
+    vector<float64> SubBlocks; //Weighted sum of squares of each complete sub-block
+
+    //True peak, from the samples as they are in the file
+    Riff_Peak       Peak;
+
+    //Work buffers, each stage is a loop on contiguous samples of a block
+    vector<float64> Block_Out;
+    vector<float64> Block_Energy; //Weighted sum of squares of the channels, per frame
+
+    //Measurement
+    void            Process_Frames(const int8u* Buffer, size_t Frames);
+    void            Process(const float64* Block, size_t Frames);
+};
+
+#endif
@@ -0,0 +1,597 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+// The sample peak is the maximum of the absolute values of all samples, so
+// it does not depend on the channel layout: the kernels scan the interleaved
+// samples as they are in the file. The true peak is the maximum of the
+// oversampled signal, a polyphase FIR filter per channel: the kernels
+// compute 4 (SSE2) or 8 (AVX2) consecutive frames of one phase at once.
+// The kernel is chosen at run time from the CPU features, the scalar ones
+// are the reference and are used for the last samples of a buffer.
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Peak.h"
+#include "ZenLib/Utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define RIFF_PEAK_X86
+    #define RIFF_PEAK_TARGET(x) __attribute__((target(x)))
+    #include <immintrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+    #define RIFF_PEAK_X86
+    #define RIFF_PEAK_TARGET(x)
+    #include <immintrin.h>
+    #include <intrin.h>
+#endif
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+const float64 Peak_Pi=3.14159265358979323846;
+const size_t  Peak_Interp_Taps=49; //Of the prototype filter, all phases
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+//Bit copy, faster than LittleEndian2float32/64 and same as the SIMD loads for infinites
+static inline float32 Peak_Float32(const int8u* Buffer)
+{
+    int32u Integer=LittleEndian2int32u((const char*)Buffer);
+    float32 Value;
+    memcpy(&Value, &Integer, 4);
+    return Value;
+}
+
+static inline float64 Peak_Float64(const int8u* Buffer)
+{
+    int64u Integer=LittleEndian2int64u((const char*)Buffer);
+    float64 Value;
+    memcpy(&Value, &Integer, 8);
+    return Value;
+}
+
+//***************************************************************************
+// Sample peak kernels, interleaved samples, result is linear
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static float64 SamplePeak_Int8_Scalar(const int8u* Buffer, size_t Samples)
+{
+    int Max=0;
+    for (size_t Pos=0; Pos<Samples; Pos++)
+    {
+        int X=Buffer[Pos]-128; //Unsigned
+        if (X<0)
+            X=-X;
+        if (X>Max)
+            Max=X;
+    }
+    return Max/128.0;
+}
+
+//---------------------------------------------------------------------------
+static float64 SamplePeak_Int16_Scalar(const int8u* Buffer, size_t Samples)
+{
+    int32s Max=0, Min=0;
+    for (size_t Pos=0; Pos<Samples; Pos++)
+    {
+        int32s X=(int16s)(Buffer[Pos*2] | (Buffer[Pos*2+1]<<8));
+        Max=X>Max?X:Max;
+        Min=X<Min?X:Min;
+    }
+    return (Max>-Min?Max:-Min)/32768.0;
+}
+
+//---------------------------------------------------------------------------
+static float64 SamplePeak_Int24_Scalar(const int8u* Buffer, size_t Samples)
+{
+    int32s Max=0, Min=0;
+    for (size_t Pos=0; Pos<Samples; Pos++)
+    {
+        int32s X=(int32s)((Buffer[Pos*3]<<8) | (Buffer[Pos*3+1]<<16) | ((int32u)Buffer[Pos*3+2]<<24))>>8;
+        Max=X>Max?X:Max;
+        Min=X<Min?X:Min;
+    }
+    return (Max>-Min?Max:-Min)/8388608.0;
+}
+
+//---------------------------------------------------------------------------
+static float64 SamplePeak_Int32_Scalar(const int8u* Buffer, size_t Samples)
+{
+    int64s Max=0, Min=0;
+    for (size_t Pos=0; Pos<Samples; Pos++)
+    {
+        int64s X=(int32s)(Buffer[Pos*4] | (Buffer[Pos*4+1]<<8) | (Buffer[Pos*4+2]<<16) | ((int32u)Buffer[Pos*4+3]<<24));
+        Max=X>Max?X:Max;
+        Min=X<Min?X:Min;
+    }
+    return (Max>-Min?Max:-Min)/2147483648.0;
+}
+
+//---------------------------------------------------------------------------
+static float64 SamplePeak_Float32_Scalar(const int8u* Buffer, size_t Samples)
+{
+    float32 Max=0;
+    for (size_t Pos=0; Pos<Samples; Pos++)
+    {
+        float32 X=fabs(Peak_Float32(Buffer+Pos*4));
+        Max=X>Max?X:Max; //NaN are ignored
+    }
+    return Max;
+}
+
+//---------------------------------------------------------------------------
+static float64 SamplePeak_Float64_Scalar(const int8u* Buffer, size_t Samples)
+{
+    float64 Max=0;
+    for (size_t Pos=0; Pos<Samples; Pos++)
+    {
+        float64 X=fabs(Peak_Float64(Buffer+Pos*8));
+        Max=X>Max?X:Max; //NaN are ignored
+    }
+    return Max;
+}
+
+#ifdef RIFF_PEAK_X86
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("sse2") static float64 SamplePeak_Int16_SSE2(const int8u* Buffer, size_t Samples)
+{
+    __m128i Max=_mm_setzero_si128(), Min=_mm_setzero_si128();
+    size_t Pos=0;
+    for (; Pos+8<=Samples; Pos+=8)
+    {
+        __m128i X=_mm_loadu_si128((const __m128i*)(Buffer+Pos*2));
+        Max=_mm_max_epi16(Max, X);
+        Min=_mm_min_epi16(Min, X);
+    }
+    int16s Maxs[8], Mins[8];
+    _mm_storeu_si128((__m128i*)Maxs, Max);
+    _mm_storeu_si128((__m128i*)Mins, Min);
+    int32s Result=0;
+    for (size_t Lane=0; Lane<8; Lane++)
+        Result=max(Result, max((int32s)Maxs[Lane], -(int32s)Mins[Lane]));
+    return max(Result/32768.0, SamplePeak_Int16_Scalar(Buffer+Pos*2, Samples-Pos));
+}
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("sse2") static float64 SamplePeak_Int32_SSE2(const int8u* Buffer, size_t Samples)
+{
+    //No 32-bit min/max before SSE4.1, done with comparisons
+    __m128i Max=_mm_setzero_si128(), Min=_mm_setzero_si128();
+    size_t Pos=0;
+    for (; Pos+4<=Samples; Pos+=4)
+    {
+        __m128i X=_mm_loadu_si128((const __m128i*)(Buffer+Pos*4));
+        __m128i IsGreater=_mm_cmpgt_epi32(X, Max);
+        Max=_mm_or_si128(_mm_and_si128(IsGreater, X), _mm_andnot_si128(IsGreater, Max));
+        __m128i IsLess=_mm_cmplt_epi32(X, Min);
+        Min=_mm_or_si128(_mm_and_si128(IsLess, X), _mm_andnot_si128(IsLess, Min));
+    }
+    int32s Maxs[4], Mins[4];
+    _mm_storeu_si128((__m128i*)Maxs, Max);
+    _mm_storeu_si128((__m128i*)Mins, Min);
+    int64s Result=0;
+    for (size_t Lane=0; Lane<4; Lane++)
+        Result=max(Result, max((int64s)Maxs[Lane], -(int64s)Mins[Lane]));
+    return max(Result/2147483648.0, SamplePeak_Int32_Scalar(Buffer+Pos*4, Samples-Pos));
+}
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("sse2") static float64 SamplePeak_Float32_SSE2(const int8u* Buffer, size_t Samples)
+{
+    __m128 Sign=_mm_set1_ps(-0.0f);
+    __m128 Max=_mm_setzero_ps();
+    size_t Pos=0;
+    for (; Pos+4<=Samples; Pos+=4)
+        Max=_mm_max_ps(_mm_andnot_ps(Sign, _mm_loadu_ps((const float*)(Buffer+Pos*4))), Max); //Max is the second operand, NaN are ignored
+    float32 Maxs[4];
+    _mm_storeu_ps(Maxs, Max);
+    float64 Result=max(max(Maxs[0], Maxs[1]), max(Maxs[2], Maxs[3]));
+    return max(Result, SamplePeak_Float32_Scalar(Buffer+Pos*4, Samples-Pos));
+}
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("sse2") static float64 SamplePeak_Float64_SSE2(const int8u* Buffer, size_t Samples)
+{
+    __m128d Sign=_mm_set1_pd(-0.0);
+    __m128d Max=_mm_setzero_pd();
+    size_t Pos=0;
+    for (; Pos+2<=Samples; Pos+=2)
+        Max=_mm_max_pd(_mm_andnot_pd(Sign, _mm_loadu_pd((const double*)(Buffer+Pos*8))), Max);
+    float64 Maxs[2];
+    _mm_storeu_pd(Maxs, Max);
+    return max(max(Maxs[0], Maxs[1]), SamplePeak_Float64_Scalar(Buffer+Pos*8, Samples-Pos));
+}
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("avx2") static float64 SamplePeak_Int16_AVX2(const int8u* Buffer, size_t Samples)
+{
+    __m256i Max=_mm256_setzero_si256(), Min=_mm256_setzero_si256();
+    size_t Pos=0;
+    for (; Pos+16<=Samples; Pos+=16)
+    {
+        __m256i X=_mm256_loadu_si256((const __m256i*)(Buffer+Pos*2));
+        Max=_mm256_max_epi16(Max, X);
+        Min=_mm256_min_epi16(Min, X);
+    }
+    int16s Maxs[16], Mins[16];
+    _mm256_storeu_si256((__m256i*)Maxs, Max);
+    _mm256_storeu_si256((__m256i*)Mins, Min);
+    int32s Result=0;
+    for (size_t Lane=0; Lane<16; Lane++)
+        Result=max(Result, max((int32s)Maxs[Lane], -(int32s)Mins[Lane]));
+    return max(Result/32768.0, SamplePeak_Int16_Scalar(Buffer+Pos*2, Samples-Pos));
+}
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("avx2") static float64 SamplePeak_Int24_AVX2(const int8u* Buffer, size_t Samples)
+{
+    //4 samples (12 bytes) per 128-bit lane, moved to the high 3 bytes of 32-bit values then sign extended
+    const __m256i Shuffle=_mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                           -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    __m256i Max=_mm256_setzero_si256(), Min=_mm256_setzero_si256();
+    size_t Pos=0;
+    for (; Pos+10<=Samples; Pos+=8) //The second load reads 16 bytes from sample 4, up to the first byte of sample 9
+    {
+        const int8u* In=Buffer+Pos*3;
+        __m256i X=_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)In)), _mm_loadu_si128((const __m128i*)(In+12)), 1);
+        X=_mm256_srai_epi32(_mm256_shuffle_epi8(X, Shuffle), 8);
+        Max=_mm256_max_epi32(Max, X);
+        Min=_mm256_min_epi32(Min, X);
+    }
+    int32s Maxs[8], Mins[8];
+    _mm256_storeu_si256((__m256i*)Maxs, Max);
+    _mm256_storeu_si256((__m256i*)Mins, Min);
+    int32s Result=0;
+    for (size_t Lane=0; Lane<8; Lane++)
+        Result=max(Result, max(Maxs[Lane], -Mins[Lane]));
+    return max(Result/8388608.0, SamplePeak_Int24_Scalar(Buffer+Pos*3, Samples-Pos));
+}
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("avx2") static float64 SamplePeak_Int32_AVX2(const int8u* Buffer, size_t Samples)
+{
+    __m256i Max=_mm256_setzero_si256(), Min=_mm256_setzero_si256();
+    size_t Pos=0;
+    for (; Pos+8<=Samples; Pos+=8)
+    {
+        __m256i X=_mm256_loadu_si256((const __m256i*)(Buffer+Pos*4));
+        Max=_mm256_max_epi32(Max, X);
+        Min=_mm256_min_epi32(Min, X);
+    }
+    int32s Maxs[8], Mins[8];
+    _mm256_storeu_si256((__m256i*)Maxs, Max);
+    _mm256_storeu_si256((__m256i*)Mins, Min);
+    int64s Result=0;
+    for (size_t Lane=0; Lane<8; Lane++)
+        Result=max(Result, max((int64s)Maxs[Lane], -(int64s)Mins[Lane]));
+    return max(Result/2147483648.0, SamplePeak_Int32_Scalar(Buffer+Pos*4, Samples-Pos));
+}
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("avx2") static float64 SamplePeak_Float32_AVX2(const int8u* Buffer, size_t Samples)
+{
+    __m256 Sign=_mm256_set1_ps(-0.0f);
+    __m256 Max=_mm256_setzero_ps();
+    size_t Pos=0;
+    for (; Pos+8<=Samples; Pos+=8)
+        Max=_mm256_max_ps(_mm256_andnot_ps(Sign, _mm256_loadu_ps((const float*)(Buffer+Pos*4))), Max);
+    float32 Maxs[8];
+    _mm256_storeu_ps(Maxs, Max);
+    float64 Result=*max_element(Maxs, Maxs+8);
+    return max(Result, SamplePeak_Float32_Scalar(Buffer+Pos*4, Samples-Pos));
+}
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("avx2") static float64 SamplePeak_Float64_AVX2(const int8u* Buffer, size_t Samples)
+{
+    __m256d Sign=_mm256_set1_pd(-0.0);
+    __m256d Max=_mm256_setzero_pd();
+    size_t Pos=0;
+    for (; Pos+4<=Samples; Pos+=4)
+        Max=_mm256_max_pd(_mm256_andnot_pd(Sign, _mm256_loadu_pd((const double*)(Buffer+Pos*8))), Max);
+    float64 Maxs[4];
+    _mm256_storeu_pd(Maxs, Max);
+    float64 Result=*max_element(Maxs, Maxs+4);
+    return max(Result, SamplePeak_Float64_Scalar(Buffer+Pos*8, Samples-Pos));
+}
+
+#endif //RIFF_PEAK_X86
+
+//***************************************************************************
+// True peak kernels, planar float32, the Taps-1 previous samples are before In
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static float32 TruePeak_Scalar(const float32* In, size_t Frames, const float32* Coefs, size_t Phases, size_t Taps)
+{
+    float32 Max=0;
+    for (size_t Frame=0; Frame<Frames; Frame++)
+    {
+        const float32* X=In+Frame; //Newest sample
+        for (size_t Phase=0; Phase<Phases; Phase++)
+        {
+            const float32* C=Coefs+Phase*Taps;
+            float32 Sum=0;
+            for (size_t Tap=0; Tap<Taps; Tap++)
+                Sum+=C[Tap]**(X-Tap);
+            Sum=fabs(Sum);
+            Max=Sum>Max?Sum:Max;
+        }
+    }
+    return Max;
+}
+
+#ifdef RIFF_PEAK_X86
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("sse2") static float32 TruePeak_SSE2(const float32* In, size_t Frames, const float32* Coefs, size_t Phases, size_t Taps)
+{
+    __m128 Sign=_mm_set1_ps(-0.0f);
+    __m128 Max=_mm_setzero_ps();
+    size_t Frame=0;
+    for (; Frame+4<=Frames; Frame+=4)
+    {
+        const float32* X=In+Frame;
+        for (size_t Phase=0; Phase<Phases; Phase++)
+        {
+            const float32* C=Coefs+Phase*Taps;
+            __m128 Sum=_mm_setzero_ps();
+            for (size_t Tap=0; Tap<Taps; Tap++)
+                Sum=_mm_add_ps(Sum, _mm_mul_ps(_mm_set1_ps(C[Tap]), _mm_loadu_ps(X-Tap)));
+            Max=_mm_max_ps(_mm_andnot_ps(Sign, Sum), Max);
+        }
+    }
+    float32 Maxs[4];
+    _mm_storeu_ps(Maxs, Max);
+    float32 Result=max(max(Maxs[0], Maxs[1]), max(Maxs[2], Maxs[3]));
+    return max(Result, TruePeak_Scalar(In+Frame, Frames-Frame, Coefs, Phases, Taps));
+}
+
+//---------------------------------------------------------------------------
+RIFF_PEAK_TARGET("avx2,fma") static float32 TruePeak_AVX2(const float32* In, size_t Frames, const float32* Coefs, size_t Phases, size_t Taps)
+{
+    __m256 Sign=_mm256_set1_ps(-0.0f);
+    __m256 Max=_mm256_setzero_ps();
+    size_t Frame=0;
+    for (; Frame+8<=Frames; Frame+=8)
+    {
+        const float32* X=In+Frame;
+        for (size_t Phase=0; Phase<Phases; Phase++)
+        {
+            const float32* C=Coefs+Phase*Taps;
+            __m256 Sum=_mm256_setzero_ps();
+            for (size_t Tap=0; Tap<Taps; Tap++)
+                Sum=_mm256_fmadd_ps(_mm256_set1_ps(C[Tap]), _mm256_loadu_ps(X-Tap), Sum);
+            Max=_mm256_max_ps(_mm256_andnot_ps(Sign, Sum), Max);
+        }
+    }
+    float32 Maxs[8];
+    _mm256_storeu_ps(Maxs, Max);
+    float32 Result=*max_element(Maxs, Maxs+8);
+    return max(Result, TruePeak_Scalar(In+Frame, Frames-Frame, Coefs, Phases, Taps));
+}
+
+#endif //RIFF_PEAK_X86
+
+//***************************************************************************
+// Kernels
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static Riff_Peak::kernel Riff_Peak_Detect()
+{
+#if defined(RIFF_PEAK_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return Riff_Peak::Kernel_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return Riff_Peak::Kernel_SSE2;
+    return Riff_Peak::Kernel_Scalar;
+#elif defined(RIFF_PEAK_X86)
+    int Info[4];
+    __cpuid(Info, 1);
+    if (!(Info[3]&(1<<26)))
+        return Riff_Peak::Kernel_Scalar; //No SSE2
+    if (!(Info[2]&(1<<27)) || !(Info[2]&(1<<12)))
+        return Riff_Peak::Kernel_SSE2; //No OSXSAVE (AVX registers are not saved) or no FMA
+    unsigned long long XCR0=_xgetbv(0);
+    __cpuidex(Info, 7, 0);
+    if ((Info[1]&(1<<5)) && (XCR0&0x06)==0x06)
+        return Riff_Peak::Kernel_AVX2;
+    return Riff_Peak::Kernel_SSE2;
+#else
+    return Riff_Peak::Kernel_Scalar;
+#endif
+}
+
+//---------------------------------------------------------------------------
+Riff_Peak::kernel Riff_Peak::Kernel_Best()
+{
+    static kernel Best=Riff_Peak_Detect(); //Same value from any thread
+    return Best;
+}
+
+//---------------------------------------------------------------------------
+Riff_Peak::kernel Riff_Peak::Kernel_FromString(const string &Name)
+{
+    if (Name=="scalar")
+        return Kernel_Scalar;
+    if (Name=="sse2")
+        return Kernel_SSE2;
+    if (Name=="avx2")
+        return Kernel_AVX2;
+    return Kernel_Auto;
+}
+
+//---------------------------------------------------------------------------
+const char* Riff_Peak::Kernel_ToString(kernel Kernel)
+{
+    switch (Kernel)
+    {
+        case Kernel_Scalar : return "scalar";
+        case Kernel_SSE2   : return "sse2";
+        case Kernel_AVX2   : return "avx2";
+        default            : return "";
+    }
+}
+
+//---------------------------------------------------------------------------
+Riff_Peak::sample_peak Riff_Peak::Sample_Peak_Kernel(int16u FormatTag, size_t Bytes, kernel Kernel)
+{
+    if (Kernel==Kernel_Auto || Kernel>Kernel_Best())
+        Kernel=Kernel_Best();
+
+    sample_peak SamplePeak;
+    if (FormatTag==3)
+        SamplePeak=Bytes==4?SamplePeak_Float32_Scalar:SamplePeak_Float64_Scalar;
+    else
+        switch (Bytes)
+        {
+            case 1 : SamplePeak=SamplePeak_Int8_Scalar; break;
+            case 2 : SamplePeak=SamplePeak_Int16_Scalar; break;
+            case 3 : SamplePeak=SamplePeak_Int24_Scalar; break;
+            default: SamplePeak=SamplePeak_Int32_Scalar;
+        }
+    #ifdef RIFF_PEAK_X86
+        if (Kernel==Kernel_AVX2)
+        {
+            if (SamplePeak==SamplePeak_Int16_Scalar) SamplePeak=SamplePeak_Int16_AVX2;
+            if (SamplePeak==SamplePeak_Int24_Scalar) SamplePeak=SamplePeak_Int24_AVX2;
+            if (SamplePeak==SamplePeak_Int32_Scalar) SamplePeak=SamplePeak_Int32_AVX2;
+            if (SamplePeak==SamplePeak_Float32_Scalar) SamplePeak=SamplePeak_Float32_AVX2;
+            if (SamplePeak==SamplePeak_Float64_Scalar) SamplePeak=SamplePeak_Float64_AVX2;
+        }
+        if (Kernel==Kernel_SSE2) //24-bit samples need SSSE3 shuffles, scalar
+        {
+            if (SamplePeak==SamplePeak_Int16_Scalar) SamplePeak=SamplePeak_Int16_SSE2;
+            if (SamplePeak==SamplePeak_Int32_Scalar) SamplePeak=SamplePeak_Int32_SSE2;
+            if (SamplePeak==SamplePeak_Float32_Scalar) SamplePeak=SamplePeak_Float32_SSE2;
+            if (SamplePeak==SamplePeak_Float64_Scalar) SamplePeak=SamplePeak_Float64_SSE2;
+        }
+    #endif //RIFF_PEAK_X86
+    return SamplePeak;
+}
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Riff_Peak::Riff_Peak(int16u FormatTag_, int16u Channels_, int32u SampleRate_, int16u BitsPerSample_, int16u BlockAlign_, kernel Kernel_)
+    : Riff_Analyzer_PCM(FormatTag_, Channels_, SampleRate_, BitsPerSample_, BlockAlign_)
+{
+    Sample_Peak=0;
+    True_Peak=0;
+    Kernel=Kernel_==Kernel_Auto || Kernel_>Kernel_Best()?Kernel_Best():Kernel_;
+    SamplePeak=NULL;
+
+    if (!IsSupported())
+        return;
+
+    SamplePeak=Sample_Peak_Kernel(FormatTag, BlockAlign/Channels, Kernel);
+
+    //Interpolation, 4x oversampling up to 96 kHz, windowed sinc
+    Oversampling=SampleRate<96000?4:(SampleRate<192000?2:1);
+    Taps=(Peak_Interp_Taps+Oversampling-1)/Oversampling;
+    Coefs.assign(Oversampling*Taps, 0);
+    for (size_t Tap=0; Tap<Peak_Interp_Taps; Tap++)
+    {
+        float64 M=(float64)Tap-(Peak_Interp_Taps-1)/2.0;
+        float64 Coef=1;
+        if (fabs(M)>1e-9)
+            Coef=sin(M*Peak_Pi/Oversampling)/(M*Peak_Pi/Oversampling);
+        Coef*=0.5*(1-cos(2*Peak_Pi*Tap/(Peak_Interp_Taps-1))); //Hann window
+        Coefs[(Tap%Oversampling)*Taps+Tap/Oversampling]=(float32)Coef; //Missing taps of the last phases stay 0
+    }
+    History.assign(Channels*(Taps-1), 0);
+    Work.resize(Taps-1+Block_Frames);
+}
+
+//---------------------------------------------------------------------------
+Riff_Peak::~Riff_Peak()
+{
+}
+
+//***************************************************************************
+// Measurement
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void Riff_Peak::Process_Frames(const int8u* Buffer, size_t Frames)
+{
+    //Sample peak, channels do not matter
+    size_t Bytes=BlockAlign/Channels;
+    Sample_Peak=max(Sample_Peak, SamplePeak(Buffer, Frames*Channels));
+
+    //True peak, per channel
+    if (Oversampling>1)
+    {
+        typedef float32 (*truepeak)(const float32*, size_t, const float32*, size_t, size_t);
+        truepeak TruePeak=TruePeak_Scalar;
+        #ifdef RIFF_PEAK_X86
+            if (Kernel==Kernel_AVX2)
+                TruePeak=TruePeak_AVX2;
+            if (Kernel==Kernel_SSE2)
+                TruePeak=TruePeak_SSE2;
+        #endif //RIFF_PEAK_X86
+
+        size_t History_Size=Taps-1;
+        float32* Samples=&Work[History_Size];
+        while (Frames)
+        {
+            size_t ToDo=Frames<Block_Frames?Frames:Block_Frames;
+            for (size_t Channel=0; Channel<Channels; Channel++)
+            {
+                //Conversion to float32
+                const int8u* In=Buffer+Channel*Bytes;
+                if (FormatTag==3 && Bytes==4)
+                    for (size_t Frame=0; Frame<ToDo; Frame++)
+                        Samples[Frame]=Peak_Float32(In+Frame*BlockAlign);
+                else if (FormatTag==3)
+                    for (size_t Frame=0; Frame<ToDo; Frame++)
+                        Samples[Frame]=(float32)Peak_Float64(In+Frame*BlockAlign);
+                else
+                    switch (Bytes)
+                    {
+                        case 1 :
+                                for (size_t Frame=0; Frame<ToDo; Frame++)
+                                    Samples[Frame]=((int)In[Frame*BlockAlign]-128)/128.0f; //Unsigned
+                                break;
+                        case 2 :
+                                for (size_t Frame=0; Frame<ToDo; Frame++)
+                                    Samples[Frame]=(int16s)(In[Frame*BlockAlign] | (In[Frame*BlockAlign+1]<<8))/32768.0f;
+                                break;
+                        case 3 :
+                                for (size_t Frame=0; Frame<ToDo; Frame++)
+                                    Samples[Frame]=((int32s)((In[Frame*BlockAlign]<<8) | (In[Frame*BlockAlign+1]<<16) | ((int32u)In[Frame*BlockAlign+2]<<24))>>8)/8388608.0f;
+                                break;
+                        default:
+                                for (size_t Frame=0; Frame<ToDo; Frame++)
+                                    Samples[Frame]=(int32s)(In[Frame*BlockAlign] | (In[Frame*BlockAlign+1]<<8) | (In[Frame*BlockAlign+2]<<16) | ((int32u)In[Frame*BlockAlign+3]<<24))/2147483648.0f;
+                    }
+
+                //Interpolation, with the end of the previous block
+                float32* Channel_History=&History[Channel*History_Size];
+                copy(Channel_History, Channel_History+History_Size, Work.begin());
+                float32 Max=TruePeak(Samples, ToDo, &Coefs[0], Oversampling, Taps);
+                True_Peak=max(True_Peak, (float64)Max);
+                copy(Work.begin()+ToDo, Work.begin()+ToDo+History_Size, Channel_History);
+            }
+            Buffer+=ToDo*BlockAlign;
+            Frames-=ToDo;
+        }
+    }
+
+    //The samples are a phase of the oversampled signal
+    True_Peak=max(True_Peak, Sample_Peak);
+}
@@ -0,0 +1,75 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#ifndef Riff_PeakH
+#define Riff_PeakH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Analyzer.h"
+#include <string>
+#include <vector>
+using namespace ZenLib;
+using namespace std;
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Sample peak and true peak (ITU-R BS.1770-4 Annex 2) of PCM audio data
+//***************************************************************************
+
+class Riff_Peak : public Riff_Analyzer_PCM
+{
+public:
+    //Kernels, chosen at run time from the CPU features
+    enum kernel
+    {
+        Kernel_Auto,
+        Kernel_Scalar, //Reference
+        Kernel_SSE2,
+        Kernel_AVX2, //With FMA
+    };
+    static kernel   Kernel_Best(); //Widest one supported by the CPU and the OS
+    static kernel   Kernel_FromString(const string &Name); //"scalar", "sse2", "avx2", Kernel_Auto if empty or unknown
+    static const char* Kernel_ToString(kernel Kernel);
+
+    //Sample peak of interleaved samples, linear
+    typedef float64 (*sample_peak)(const int8u* Buffer, size_t Samples);
+    static sample_peak Sample_Peak_Kernel(int16u FormatTag, size_t Bytes, kernel Kernel); //Bytes: per sample
+
+    //Constructor/Destructor
+    Riff_Peak(int16u FormatTag, int16u Channels, int32u SampleRate, int16u BitsPerSample, int16u BlockAlign, kernel Kernel=Kernel_Auto); //Kernel: not wider than Kernel_Best()
+    ~Riff_Peak();
+
+    //Measurement
+    void            Finish() {}
+
+    //Results, linear (0 to 1 for full scale), of all channels
+    float64         Sample_Peak;
+    float64         True_Peak; //Not less than Sample_Peak
+    kernel          Kernel;
+
+private:
+    //Interpolation filter, one row of Taps coefficients per phase
+    size_t          Oversampling;
+    size_t          Taps; //Per phase
+    vector<float32> Coefs;
+
+    //Sample peak
+    sample_peak     SamplePeak;
+
+    //Per channel, the last Taps-1 samples then the samples of the block
+    vector<float32> History;
+    vector<float32> Work;
+
+    //Measurement
+    void            Process_Frames(const int8u* Buffer, size_t Frames);
+};
+
+#endif
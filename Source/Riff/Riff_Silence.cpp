@@ -0,0 +1,110 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Silence.h"
+#include <cmath>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+const size_t Silence_Chunk_Frames=64; //Frames tested together with the sample peak kernel
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Riff_Silence::Riff_Silence(int16u FormatTag_, int16u Channels_, int32u SampleRate_, int16u BitsPerSample_, int16u BlockAlign_, float64 Threshold_, float64 Duration, Riff_Peak::kernel Kernel)
+    : Riff_Analyzer_PCM(FormatTag_, Channels_, SampleRate_, BitsPerSample_, BlockAlign_)
+{
+    Frames=0;
+    Threshold=pow(10.0, Threshold_/20);
+    Duration_Frames=(int64u)ceil(Duration*SampleRate);
+    if (!Duration_Frames)
+        Duration_Frames=1;
+    Chunk_Frames=Duration_Frames<Silence_Chunk_Frames?(size_t)Duration_Frames:Silence_Chunk_Frames;
+    SamplePeak=NULL;
+    IsSilent=false;
+    Silence_Start=0;
+
+    if (!IsSupported())
+        return;
+
+    SamplePeak=Riff_Peak::Sample_Peak_Kernel(FormatTag, BlockAlign/Channels, Kernel);
+}
+
+//---------------------------------------------------------------------------
+Riff_Silence::~Riff_Silence()
+{
+}
+
+//***************************************************************************
+// Measurement
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void Riff_Silence::Process_Frames(const int8u* Buffer, size_t Frames_Count)
+{
+    for (size_t Pos=0; Pos<Frames_Count; Pos+=Chunk_Frames)
+    {
+        size_t ToDo=Frames_Count-Pos<Chunk_Frames?Frames_Count-Pos:Chunk_Frames;
+        const int8u* Chunk=Buffer+Pos*BlockAlign;
+
+        //Whole chunk silent, the most common case in a silence
+        if (SamplePeak(Chunk, ToDo*Channels)<Threshold)
+        {
+            if (!IsSilent)
+            {
+                IsSilent=true;
+                Silence_Start=Frames+Pos;
+            }
+            continue;
+        }
+
+        //At least one frame not silent, only the first and the last ones matter
+        if (IsSilent)
+        {
+            size_t First=0;
+            while (First<ToDo && SamplePeak(Chunk+First*BlockAlign, Channels)<Threshold)
+                First++;
+            Silence_End(Frames+Pos+First);
+        }
+        size_t Last=ToDo;
+        while (Last && SamplePeak(Chunk+(Last-1)*BlockAlign, Channels)<Threshold)
+            Last--;
+        if (Last<ToDo)
+        {
+            IsSilent=true;
+            Silence_Start=Frames+Pos+Last;
+        }
+    }
+
+    Frames+=Frames_Count;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Silence::Silence_End(int64u End)
+{
+    IsSilent=false;
+    if (End-Silence_Start<Duration_Frames)
+        return;
+
+    range Range;
+    Range.Start=Silence_Start;
+    Range.Length=End-Silence_Start;
+    Ranges.push_back(Range);
+}
+
+//---------------------------------------------------------------------------
+void Riff_Silence::Finish()
+{
+    if (IsSilent)
+        Silence_End(Frames);
+}
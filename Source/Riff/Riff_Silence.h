@@ -0,0 +1,66 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#ifndef Riff_SilenceH
+#define Riff_SilenceH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Peak.h"
+#include "Riff/Riff_Levels.h"
+#include <vector>
+using namespace ZenLib;
+using namespace std;
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+const float64 RIFF_Silence_DefaultThreshold=RIFF_Levels_Silence_DefaultThreshold; //dBFS
+const float64 RIFF_Silence_DefaultDuration=2; //Seconds, shorter silences are not reported
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Silences (leading, trailing and gaps) of PCM audio data
+//***************************************************************************
+
+class Riff_Silence : public Riff_Analyzer_PCM
+{
+public:
+    //Constructor/Destructor
+    Riff_Silence(int16u FormatTag, int16u Channels, int32u SampleRate, int16u BitsPerSample, int16u BlockAlign, float64 Threshold=RIFF_Silence_DefaultThreshold, float64 Duration=RIFF_Silence_DefaultDuration, Riff_Peak::kernel Kernel=Riff_Peak::Kernel_Auto);
+    ~Riff_Silence();
+
+    //Measurement
+    void            Finish();
+
+    //Results, a frame is silent if all its samples are below the threshold
+    struct range
+    {
+        int64u      Start; //In frames
+        int64u      Length;
+    };
+    vector<range>   Ranges; //At least Duration long, in order
+    int64u          Frames;
+
+private:
+    float64         Threshold; //Linear
+    int64u          Duration_Frames;
+    size_t          Chunk_Frames; //Not more than Duration_Frames, silences inside a chunk are too short
+    Riff_Peak::sample_peak SamplePeak;
+
+    //Silence in progress
+    bool            IsSilent;
+    int64u          Silence_Start;
+    void            Silence_End(int64u End);
+
+    //Measurement
+    void            Process_Frames(const int8u* Buffer, size_t Frames);
+};
+
+#endif
@@ -0,0 +1,318 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#include "Riff/Riff_Write_Plan.h"
+#include <cstring>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+static const int8u Riff_Write_Plan_Zeroes[65536]={0};
+static const size_t Riff_Write_Plan_Vectors_Max=1024; //Per write call
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Riff_Write_Plan::Riff_Write_Plan()
+{
+    Clear();
+}
+
+//***************************************************************************
+// Building
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void Riff_Write_Plan::Clear()
+{
+    Extents.clear();
+    Copies.clear();
+    Data=(size_t)-1;
+    Size=0;
+    InPlace=false;
+    Insert_Offset=0;
+    Insert_Size=0;
+    Cloned_Size=0;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Write_Plan::Copy(int64u Source, int64u Copy_Size, bool IsData)
+{
+    if (!Copy_Size && !IsData)
+        return;
+
+    //Contiguous copies are merged, except the audio data
+    if (!IsData && !Extents.empty() && Data!=Extents.size()-1)
+    {
+        extent &Last=Extents.back();
+        if (Last.Kind==extent::Kind_Copy && Last.Source+Last.Size==Source)
+        {
+            Last.Size+=Copy_Size;
+            Size+=Copy_Size;
+            return;
+        }
+    }
+
+    extent Extent;
+    Extent.Kind=extent::Kind_Copy;
+    Extent.Offset=Size;
+    Extent.Size=Copy_Size;
+    Extent.Source=Source;
+    Extent.Buffer=NULL;
+    if (IsData)
+        Data=Extents.size();
+    Extents.push_back(Extent);
+    Size+=Copy_Size;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Write_Plan::New(const int8u* Buffer, size_t New_Size)
+{
+    if (!New_Size)
+        return;
+
+    extent Extent;
+    Extent.Kind=extent::Kind_New;
+    Extent.Offset=Size;
+    Extent.Size=New_Size;
+    Extent.Source=(int64u)-1;
+    if (New_Size<=sizeof(Extent.Inline))
+    {
+        memcpy(Extent.Inline, Buffer, New_Size);
+        Extent.Buffer=NULL;
+    }
+    else
+        Extent.Buffer=Buffer;
+    Extents.push_back(Extent);
+    Size+=New_Size;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Write_Plan::Zero(int64u Zero_Size)
+{
+    if (!Zero_Size)
+        return;
+
+    if (!Extents.empty() && Extents.back().Kind==extent::Kind_Zero)
+    {
+        Extents.back().Size+=Zero_Size;
+        Size+=Zero_Size;
+        return;
+    }
+
+    extent Extent;
+    Extent.Kind=extent::Kind_Zero;
+    Extent.Offset=Size;
+    Extent.Size=Zero_Size;
+    Extent.Source=(int64u)-1;
+    Extent.Buffer=NULL;
+    Extents.push_back(Extent);
+    Size+=Zero_Size;
+}
+
+//---------------------------------------------------------------------------
+void Riff_Write_Plan::Finish(int64u Input_Size, int64u Insert_Alignment)
+{
+    InPlace=false;
+    Insert_Offset=0;
+    Insert_Size=0;
+    if (Data==(size_t)-1)
+        return;
+    const extent &Extent=Extents[Data];
+
+    //Space before the audio data, by blocks so the file system moves the audio data and what is after it
+    if (Insert_Alignment && Extent.Size && Extent.Offset>Extent.Source && !((Extent.Offset-Extent.Source)%Insert_Alignment))
+    {
+        Insert_Offset=Extent.Source-Extent.Source%Insert_Alignment;
+        Insert_Size=Extent.Offset-Extent.Source;
+
+        //A copy must not be split by the insertion
+        for (size_t Pos=0; Pos<Extents.size(); Pos++)
+            if (Extents[Pos].Kind==extent::Kind_Copy && Extents[Pos].Source<Insert_Offset && Extents[Pos].Source+Extents[Pos].Size>Insert_Offset)
+            {
+                Insert_Offset=Extents[Pos].Source-Extents[Pos].Source%Insert_Alignment;
+                Pos=(size_t)-1; //Again with the new offset
+            }
+
+        Input_Size+=Insert_Size;
+    }
+
+    //In place if the audio data does not move and nothing is left from the input after the output
+    InPlace=Source_Get(Extent)==Extent.Offset
+         && (Data+1==Extents.size() || Size>=Input_Size);
+    if (!InPlace)
+    {
+        Insert_Offset=0;
+        Insert_Size=0;
+    }
+}
+
+//---------------------------------------------------------------------------
+void Riff_Write_Plan::Insert_Cancel()
+{
+    InPlace=false;
+    Insert_Offset=0;
+    Insert_Size=0;
+}
+
+//***************************************************************************
+// Cost
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+int64u Riff_Write_Plan::Source_Get(const extent &Extent) const
+{
+    return Insert_Size && Extent.Source>=Insert_Offset?(Extent.Source+Insert_Size):Extent.Source;
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Write_Plan::IsRewritten(const extent &Extent) const
+{
+    return !InPlace || Extent.Kind!=extent::Kind_Copy || Source_Get(Extent)!=Extent.Offset;
+}
+
+//---------------------------------------------------------------------------
+int64u Riff_Write_Plan::Rewrite_Size_Get() const
+{
+    int64u Rewrite_Size=0;
+    for (size_t Pos=0; Pos<Extents.size(); Pos++)
+        if (IsRewritten(Extents[Pos]))
+            Rewrite_Size+=Extents[Pos].Size;
+    return Rewrite_Size;
+}
+
+//***************************************************************************
+// Execution
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool Riff_Write_Plan::Read_Copies(File &In)
+{
+    if (!InPlace)
+        return true;
+
+    size_t Copies_Size=0;
+    for (size_t Pos=0; Pos<Extents.size(); Pos++)
+        if (Extents[Pos].Kind==extent::Kind_Copy && IsRewritten(Extents[Pos]))
+            Copies_Size+=(size_t)Extents[Pos].Size;
+    if (!Copies_Size)
+        return true;
+    Copies.resize(Copies_Size);
+
+    //Then these extents are written from memory
+    size_t Copies_Offset=0;
+    for (size_t Pos=0; Pos<Extents.size(); Pos++)
+    {
+        extent &Extent=Extents[Pos];
+        if (Extent.Kind!=extent::Kind_Copy || !IsRewritten(Extent))
+            continue;
+        if (In.Read_At(&Copies[Copies_Offset], (size_t)Extent.Size, Source_Get(Extent))!=Extent.Size)
+            return false;
+        Extent.Kind=extent::Kind_New;
+        Extent.Buffer=&Copies[Copies_Offset];
+        Copies_Offset+=(size_t)Extent.Size;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Write_Plan::Write_Memory(File &Out)
+{
+    vector<const int8u*> Buffers;
+    vector<size_t> Buffers_Size;
+    int64u Run_Offset=0;
+    int64u Run_Size=0;
+
+    for (size_t Pos=0; Pos<=Extents.size(); Pos++)
+    {
+        //Writing the current run if the next extent is not contiguous
+        bool IsMemory=Pos<Extents.size() && Extents[Pos].Kind!=extent::Kind_Copy;
+        if (!Buffers.empty() && (!IsMemory || Extents[Pos].Offset!=Run_Offset+Run_Size || Buffers.size()>=Riff_Write_Plan_Vectors_Max))
+        {
+            if (Out.Write_At(&Buffers[0], &Buffers_Size[0], Buffers.size(), Run_Offset)!=Run_Size)
+                return false;
+            Buffers.clear();
+            Buffers_Size.clear();
+        }
+        if (!IsMemory)
+            continue;
+
+        const extent &Extent=Extents[Pos];
+        if (Buffers.empty())
+        {
+            Run_Offset=Extent.Offset;
+            Run_Size=0;
+        }
+        if (Extent.Kind==extent::Kind_New)
+        {
+            Buffers.push_back(Extent.Buffer_Get());
+            Buffers_Size.push_back((size_t)Extent.Size);
+        }
+        else
+            for (int64u Zero_Offset=0; Zero_Offset<Extent.Size; Zero_Offset+=sizeof(Riff_Write_Plan_Zeroes))
+            {
+                Buffers.push_back(Riff_Write_Plan_Zeroes);
+                Buffers_Size.push_back(Extent.Size-Zero_Offset>sizeof(Riff_Write_Plan_Zeroes)?sizeof(Riff_Write_Plan_Zeroes):(size_t)(Extent.Size-Zero_Offset));
+            }
+        Run_Size+=Extent.Size;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool Riff_Write_Plan::Verify(File &In, int64u &Verified_Size)
+{
+    Verified_Size=0;
+    if (In.Size_Get()!=Size)
+        return false;
+
+    vector<int8u> Run;
+    for (size_t Pos=0; Pos<Extents.size();)
+    {
+        if (Extents[Pos].Kind==extent::Kind_Copy)
+        {
+            Pos++;
+            continue;
+        }
+
+        //Run of contiguous extents from memory
+        size_t Run_End=Pos;
+        int64u Run_Size=0;
+        while (Run_End<Extents.size() && Extents[Run_End].Kind!=extent::Kind_Copy && Extents[Run_End].Offset==Extents[Pos].Offset+Run_Size)
+            Run_Size+=Extents[Run_End++].Size;
+        Run.resize((size_t)Run_Size);
+        if (In.Read_At(&Run[0], (size_t)Run_Size, Extents[Pos].Offset)!=Run_Size)
+            return false;
+
+        //Comparing
+        const int8u* Run_Current=&Run[0];
+        for (; Pos<Run_End; Pos++)
+        {
+            const extent &Extent=Extents[Pos];
+            if (Extent.Kind==extent::Kind_New)
+            {
+                if (memcmp(Run_Current, Extent.Buffer_Get(), (size_t)Extent.Size))
+                    return false;
+            }
+            else
+                for (int64u Zero_Offset=0; Zero_Offset<Extent.Size; Zero_Offset+=sizeof(Riff_Write_Plan_Zeroes))
+                    if (memcmp(Run_Current+Zero_Offset, Riff_Write_Plan_Zeroes, Extent.Size-Zero_Offset>sizeof(Riff_Write_Plan_Zeroes)?sizeof(Riff_Write_Plan_Zeroes):(size_t)(Extent.Size-Zero_Offset)))
+                        return false;
+            Run_Current+=Extent.Size;
+        }
+        Verified_Size+=Run_Size;
+    }
+
+    return true;
+}
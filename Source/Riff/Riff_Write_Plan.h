@@ -0,0 +1,81 @@
+// BWF MetaEdit Riff - RIFF stuff for BWF MetaEdit
+//
+// This code was created in 2010 for the Library of Congress and the
+// other federal government agencies participating in the Federal Agencies
+// Digital Guidelines Initiative and it is in the public domain.
+//
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//---------------------------------------------------------------------------
+#ifndef Riff_Write_PlanH
+#define Riff_Write_PlanH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "ZenLib/File.h"
+#include <vector>
+using namespace ZenLib;
+using namespace std;
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Content of a file to write, computed before any I/O
+//***************************************************************************
+
+class Riff_Write_Plan
+{
+public:
+    //Constructor/Destructor
+    Riff_Write_Plan();
+
+    //Extents of the output, in order
+    struct extent
+    {
+        enum kind
+        {
+            Kind_Copy,                  //From the input file
+            Kind_New,                   //From memory
+            Kind_Zero,
+        };
+
+        kind            Kind;
+        int64u          Offset;         //In the output
+        int64u          Size;
+        int64u          Source;         //In the input, Kind_Copy only
+        const int8u*    Buffer;         //Kind_New only, NULL if the bytes are in Inline
+        int8u           Inline[12];     //Chunk headers and padding are copied
+
+        const int8u*    Buffer_Get() const                                      {return Buffer?Buffer:Inline;}
+    };
+    vector<extent>  Extents;
+    size_t          Data;               //Position in Extents of the audio data, (size_t)-1 if none
+    int64u          Size;               //Of the output
+    bool            InPlace;            //The audio data keeps its place, the file is modified instead of copied
+    int64u          Insert_Offset;      //In place, space is inserted in the input before the audio data
+    int64u          Insert_Size;        //0 if none
+    int64u          Cloned_Size;        //Shared by the file system between the input and the output, during the execution
+
+    //Building, each extent is appended after the previous one
+    void            Clear();
+    void            Copy(int64u Source, int64u Size, bool IsData=false);
+    void            New(const int8u* Buffer, size_t Size);                      //Buffer must stay valid until the plan is executed, except if Size is not more than the Inline size
+    void            Zero(int64u Size);
+    void            Finish(int64u Input_Size, int64u Insert_Alignment=0);       //Insert_Alignment: block size of the input for inserting space, 0 if not allowed
+    void            Insert_Cancel();                                            //Space can not be inserted, the file is copied
+
+    //Cost
+    int64u          Source_Get(const extent &Extent) const;                     //In place, offset of a copy in the file after the insertion of space
+    bool            IsRewritten(const extent &Extent) const;                    //False if in place and already in the file
+    int64u          Rewrite_Size_Get() const;
+
+    //Execution helpers, copies are done by the caller
+    bool            Read_Copies(File &In);                                      //In place, rewritten copies are read before anything is overwritten
+    bool            Write_Memory(File &Out);                                    //New and zero extents, contiguous ones with one call
+    bool            Verify(File &In, int64u &Verified_Size);                    //New and zero extents are read back and compared, contiguous ones with one call
+
+private:
+    vector<int8u>   Copies;
+};
+
+#endif
@@ -29,6 +29,15 @@
         #include <sys/stat.h>
         #if !defined(WINDOWS)
             #include <unistd.h>
+            #include <fcntl.h>
+            #include <sys/uio.h>
+            #ifdef __linux__
+                #include <sys/ioctl.h>
+                #include <linux/fs.h>
+                #include <linux/falloc.h>
+            #endif //__linux__
+            #include <cerrno>
+            #define ZENLIB_FILE_POSIX //Positional I/O on a file descriptor, no stream buffer
         #endif //!defined(WINDOWS)
         #include <fstream>
         using namespace std;
@@ -141,6 +150,13 @@ namespace ZenLib
     #define ZENLIB_DEBUG2(_NAME,_TOAPPEND)
 #endif // ZENLIB_DEBUG
 
+//---------------------------------------------------------------------------
+#ifdef ZENLIB_FILE_POSIX
+    //File_Handle is the file descriptor plus 1, so NULL still means not opened
+    static inline int   Fd_Get(void* File_Handle)  {return (int)(size_t)File_Handle-1;}
+    static inline void* Fd_Handle(int Fd)          {return Fd<0?NULL:(void*)(size_t)(Fd+1);}
+#endif //ZENLIB_FILE_POSIX
+
 //***************************************************************************
 // Constructor/Destructor
 //***************************************************************************
@@ -227,6 +243,40 @@ bool File::Open (const tstring &File_Name_, access_t Access)
             #endif //UNICODE
             return File_Handle!=-1;
             */
+            #ifdef ZENLIB_FILE_POSIX
+            int Flags;
+            switch (Access)
+            {
+                case Access_Read         : Flags=O_RDONLY; break;
+                case Access_Write        : Flags=O_RDWR; break;
+                case Access_Read_Write   : Flags=O_RDWR; break;
+                case Access_Write_Append : Flags=O_WRONLY|O_CREAT|O_APPEND; break;
+                default                  : Flags=O_RDONLY;
+            }
+            #ifdef O_CLOEXEC
+                Flags|=O_CLOEXEC;
+            #endif //O_CLOEXEC
+            int Fd;
+            do
+                #ifdef UNICODE
+                    Fd=open(File_Name.To_Local().c_str(), Flags, 0666);
+                #else
+                    Fd=open(File_Name.c_str(), Flags, 0666);
+                #endif //UNICODE
+            while (Fd<0 && errno==EINTR);
+            if (Fd<0)
+                return false;
+            struct stat Stat;
+            if (fstat(Fd, &Stat) || S_ISDIR(Stat.st_mode))
+            {
+                close(Fd);
+                return false;
+            }
+            File_Handle=Fd_Handle(Fd);
+            Size=Stat.st_size;
+            Position=Access==Access_Write_Append?Size:0;
+            return true;
+            #else //ZENLIB_FILE_POSIX
             ios_base::openmode mode;
             switch (Access)
             {
@@ -251,6 +301,7 @@ bool File::Open (const tstring &File_Name_, access_t Access)
                 return false;
             }
             return true;
+            #endif //ZENLIB_FILE_POSIX
         #elif defined WINDOWS
             DWORD dwDesiredAccess, dwShareMode, dwCreationDisposition;
             switch (Access)
@@ -359,6 +410,26 @@ bool File::Create (const Ztring &File_Name_, bool OverWrite)
                 //case false         : mode=          ; break;
                 default                  : mode=0                            ; break;
             }*/
+            #ifdef ZENLIB_FILE_POSIX
+            int Flags=O_RDWR|O_CREAT|(OverWrite?O_TRUNC:O_EXCL);
+            #ifdef O_CLOEXEC
+                Flags|=O_CLOEXEC;
+            #endif //O_CLOEXEC
+            int Fd;
+            do
+                #ifdef UNICODE
+                    Fd=open(File_Name.To_Local().c_str(), Flags, 0666);
+                #else
+                    Fd=open(File_Name.c_str(), Flags, 0666);
+                #endif //UNICODE
+            while (Fd<0 && errno==EINTR);
+            if (Fd<0)
+                return false;
+            File_Handle=Fd_Handle(Fd);
+            Position=0;
+            Size=0;
+            return true;
+            #else //ZENLIB_FILE_POSIX
             ios_base::openmode access;
 
             if (!OverWrite && Exists(File_Name))
@@ -372,6 +443,7 @@ bool File::Create (const Ztring &File_Name_, bool OverWrite)
                 File_Handle=new fstream(File_Name.c_str(), access);
             #endif //UNICODE
             return ((fstream*)File_Handle)->is_open();
+            #endif //ZENLIB_FILE_POSIX
         #elif defined WINDOWS
             DWORD dwDesiredAccess, dwShareMode, dwCreationDisposition;
             if (OverWrite) {
@@ -442,8 +514,13 @@ void File::Close ()
         delete (wxFile*)File_Handle; File_Handle=NULL;
     #else //ZENLIB_USEWX
         #ifdef ZENLIB_STANDARD
-            //close(File_Handle); File_Handle=-1;
-            delete (fstream*)File_Handle; File_Handle=NULL;
+            #ifdef ZENLIB_FILE_POSIX
+                if (File_Handle!=NULL)
+                    close(Fd_Get(File_Handle));
+                File_Handle=NULL;
+            #else //ZENLIB_FILE_POSIX
+                delete (fstream*)File_Handle; File_Handle=NULL;
+            #endif //ZENLIB_FILE_POSIX
         #elif defined WINDOWS
             CloseHandle(File_Handle); File_Handle=INVALID_HANDLE_VALUE;
         #endif
@@ -487,7 +564,11 @@ size_t File::Read (int8u* Buffer, size_t Buffer_Size_Max)
         return ByteRead;
     #else //ZENLIB_USEWX
         #ifdef ZENLIB_STANDARD
-            //return read((int)File_Handle, Buffer, Buffer_Size_Max);
+            #ifdef ZENLIB_FILE_POSIX
+            size_t ByteRead=Read_At(Buffer, Buffer_Size_Max, Position);
+            Position+=ByteRead;
+            return ByteRead;
+            #else //ZENLIB_FILE_POSIX
             if (Position==(int64u)-1)
                 Position_Get();
             if (Size==(int64u)-1)
@@ -498,6 +579,7 @@ size_t File::Read (int8u* Buffer, size_t Buffer_Size_Max)
             size_t ByteRead=((fstream*)File_Handle)->gcount();
             Position+=ByteRead;
             return ByteRead;
+            #endif //ZENLIB_FILE_POSIX
         #elif defined WINDOWS
             DWORD Buffer_Size;
             if (ReadFile(File_Handle, Buffer, (DWORD)Buffer_Size_Max, &Buffer_Size, NULL))
@@ -519,6 +601,36 @@ size_t File::Read (int8u* Buffer, size_t Buffer_Size_Max)
     #endif //ZENLIB_USEWX
 }
 
+//---------------------------------------------------------------------------
+size_t File::Read_At (int8u* Buffer, size_t Buffer_Size_Max, int64u Offset)
+{
+    if (!Opened_Get())
+        return 0;
+
+    #ifdef ZENLIB_FILE_POSIX
+        //pread() does not use the shared file offset, several threads may read at the same time
+        size_t ByteRead=0;
+        while (ByteRead<Buffer_Size_Max)
+        {
+            ssize_t Result=pread(Fd_Get(File_Handle), Buffer+ByteRead, Buffer_Size_Max-ByteRead, (off_t)(Offset+ByteRead));
+            if (Result<0 && errno==EINTR)
+                continue;
+            if (Result<=0)
+                break; //Error or end of file
+            ByteRead+=Result;
+        }
+        return ByteRead;
+    #else //ZENLIB_FILE_POSIX
+        //Not positional, restoring the position
+        int64u Position_Sav=Position_Get();
+        if (!GoTo(Offset))
+            return 0;
+        size_t ByteRead=Read(Buffer, Buffer_Size_Max);
+        GoTo(Position_Sav);
+        return ByteRead;
+    #endif //ZENLIB_FILE_POSIX
+}
+
 //---------------------------------------------------------------------------
 size_t File::Write (const int8u* Buffer, size_t Buffer_Size)
 {
@@ -537,7 +649,26 @@ size_t File::Write (const int8u* Buffer, size_t Buffer_Size)
         return ((wxFile*)File_Handle)->Write(Buffer, Buffer_Size);
     #else //ZENLIB_USEWX
         #ifdef ZENLIB_STANDARD
-            //return write(File_Handle, Buffer, Buffer_Size);
+            #ifdef ZENLIB_FILE_POSIX
+            size_t Written=0;
+            while (Written<Buffer_Size)
+            {
+                ssize_t Result=pwrite(Fd_Get(File_Handle), Buffer+Written, Buffer_Size-Written, (off_t)(Position+Written));
+                if (Result<0 && errno==EINTR)
+                    continue;
+                if (Result<=0)
+                {
+                    Position=(int64u)-1;
+                    Size=(int64u)-1;
+                    return 0;
+                }
+                Written+=Result;
+            }
+            Position+=Written;
+            if (Size!=(int64u)-1 && Position>Size)
+                Size=Position;
+            return Written;
+            #else //ZENLIB_FILE_POSIX
             ((fstream*)File_Handle)->write((char*)Buffer, Buffer_Size);
             if (((fstream*)File_Handle)->bad())
             {
@@ -550,6 +681,7 @@ size_t File::Write (const int8u* Buffer, size_t Buffer_Size)
                     Position+=Buffer_Size;
                 return Buffer_Size;
             }
+            #endif //ZENLIB_FILE_POSIX
         #elif defined WINDOWS
             DWORD Buffer_Size_Written;
             if (WriteFile(File_Handle, Buffer, (DWORD)Buffer_Size, &Buffer_Size_Written, NULL))
@@ -567,6 +699,144 @@ size_t File::Write (const int8u* Buffer, size_t Buffer_Size)
     #endif //ZENLIB_USEWX
 }
 
+//---------------------------------------------------------------------------
+size_t File::Write_At (const int8u* const* Buffers, const size_t* Buffers_Size, size_t Buffers_Count, int64u Offset)
+{
+    if (!Opened_Get())
+        return 0;
+
+    size_t Written=0;
+    #ifdef ZENLIB_FILE_POSIX
+        //pwritev() writes several buffers with one call, without the shared file offset
+        size_t Pos=0;
+        size_t Pos_Written=0; //Already written part of Buffers[Pos]
+        while (Pos<Buffers_Count)
+        {
+            iovec Vectors[64];
+            int Vectors_Count=0;
+            for (size_t Vector_Pos=Pos; Vector_Pos<Buffers_Count && Vectors_Count<64; Vector_Pos++)
+            {
+                size_t Vector_Offset=Vector_Pos==Pos?Pos_Written:0;
+                Vectors[Vectors_Count].iov_base=(void*)(Buffers[Vector_Pos]+Vector_Offset);
+                Vectors[Vectors_Count].iov_len=Buffers_Size[Vector_Pos]-Vector_Offset;
+                Vectors_Count++;
+            }
+            ssize_t Result=pwritev(Fd_Get(File_Handle), Vectors, Vectors_Count, (off_t)(Offset+Written));
+            if (Result<0 && errno==EINTR)
+                continue;
+            if (Result<0)
+                break;
+            Written+=Result;
+
+            //Skipping what is written
+            size_t Result_Left=Result;
+            while (Pos<Buffers_Count && Result_Left>=Buffers_Size[Pos]-Pos_Written)
+            {
+                Result_Left-=Buffers_Size[Pos]-Pos_Written;
+                Pos_Written=0;
+                Pos++;
+            }
+            Pos_Written+=Result_Left;
+            if (Result==0 && Pos<Buffers_Count)
+                break; //Nothing more can be written
+        }
+    #else //ZENLIB_FILE_POSIX
+        //Not positional, restoring the position
+        int64u Position_Sav=Position_Get();
+        if (!GoTo(Offset))
+            return 0;
+        for (size_t Pos=0; Pos<Buffers_Count; Pos++)
+        {
+            size_t Result=Write(Buffers[Pos], Buffers_Size[Pos]);
+            Written+=Result;
+            if (Result<Buffers_Size[Pos])
+                break;
+        }
+        GoTo(Position_Sav);
+    #endif //ZENLIB_FILE_POSIX
+
+    if (Size!=(int64u)-1 && Offset+Written>Size)
+        Size=Offset+Written;
+    return Written;
+}
+
+//---------------------------------------------------------------------------
+int64u File::Copy_Range_From (File &Source, int64u Source_Offset, int64u Size_ToCopy, int64u Offset)
+{
+    if (!Opened_Get() || !Source.Opened_Get())
+        return 0;
+
+    #if defined(ZENLIB_FILE_POSIX) && defined(__linux__) && defined(__GLIBC__) && (__GLIBC__>2 || (__GLIBC__==2 && __GLIBC_MINOR__>=27))
+        //copy_file_range() copies in the kernel, the data does not go through user space
+        int64u Copied=0;
+        while (Copied<Size_ToCopy)
+        {
+            loff_t Source_Pos=(loff_t)(Source_Offset+Copied);
+            loff_t Pos=(loff_t)(Offset+Copied);
+            size_t ToCopy=Size_ToCopy-Copied>0x40000000?0x40000000:(size_t)(Size_ToCopy-Copied);
+            ssize_t Result=copy_file_range(Fd_Get(Source.File_Handle), &Source_Pos, Fd_Get(File_Handle), &Pos, ToCopy, 0);
+            if (Result<0 && errno==EINTR)
+                continue;
+            if (Result<=0)
+                break; //Not supported (e.g. between file systems with old kernels) or end of the source
+            Copied+=Result;
+        }
+
+        if (Size!=(int64u)-1 && Offset+Copied>Size)
+            Size=Offset+Copied;
+        return Copied;
+    #else
+        return 0;
+    #endif
+}
+
+//---------------------------------------------------------------------------
+int64u File::Clone_Range_From (File &Source, int64u Source_Offset, int64u Size_ToClone, int64u Offset)
+{
+    if (!Opened_Get() || !Source.Opened_Get() || !Size_ToClone)
+        return 0;
+
+    #if defined(ZENLIB_FILE_POSIX) && defined(__linux__) && defined(FICLONERANGE)
+        //FICLONERANGE shares the extents of the source (reflink on XFS, Btrfs...), nothing is copied
+        file_clone_range Range;
+        Range.src_fd=Fd_Get(Source.File_Handle);
+        Range.src_offset=Source_Offset;
+        Range.src_length=Size_ToClone;
+        Range.dest_offset=Offset;
+        if (ioctl(Fd_Get(File_Handle), FICLONERANGE, &Range))
+            return 0; //Not supported by the file system, not on the same file system, or not aligned
+
+        if (Size!=(int64u)-1 && Offset+Size_ToClone>Size)
+            Size=Offset+Size_ToClone;
+        return Size_ToClone;
+    #else
+        return 0;
+    #endif
+}
+
+//---------------------------------------------------------------------------
+bool File::Insert_Range (int64u Offset, int64u Size_ToInsert)
+{
+    if (!Opened_Get())
+        return false;
+
+    #if defined(ZENLIB_FILE_POSIX) && defined(__linux__) && defined(FALLOC_FL_INSERT_RANGE)
+        //The extents after Offset are shifted (ext4, XFS...), nothing is copied, inserted space reads as zeroes
+        int Result;
+        do
+            Result=fallocate(Fd_Get(File_Handle), FALLOC_FL_INSERT_RANGE, (off_t)Offset, (off_t)Size_ToInsert);
+        while (Result && errno==EINTR);
+        if (Result)
+            return false; //Not supported by the file system, not aligned, or not before the end of the file
+
+        if (Size!=(int64u)-1)
+            Size+=Size_ToInsert;
+        return true;
+    #else
+        return false;
+    #endif
+}
+
 //---------------------------------------------------------------------------
 bool File::Truncate (int64u Offset)
 {
@@ -579,6 +849,14 @@ bool File::Truncate (int64u Offset)
         #ifdef ZENLIB_STANDARD
             #if defined(WINDOWS)
                 return false; //Not supported
+            #elif defined(ZENLIB_FILE_POSIX)
+                if (Offset==(int64u)-1)
+                    Offset=Position_Get();
+                if (ftruncate(Fd_Get(File_Handle), (off_t)Offset))
+                    return false;
+                Size=Offset;
+                Position=Offset;
+                return true;
             #else //defined(WINDOWS)
                 //Need to close the file, use truncate, reopen it
                 if (Offset==(int64u)-1)
@@ -629,6 +907,21 @@ bool File::GoTo (int64s Position_ToMove, move_t MoveMethod)
     #endif //ZENLIB_USEWX
         return false;
 
+    #ifdef ZENLIB_FILE_POSIX
+        //No seek, the position is only used by the next pread()/pwrite()
+        int64u Base;
+        switch (MoveMethod)
+        {
+            case FromCurrent : Base=Position_Get(); break;
+            case FromEnd     : Base=Size_Get(); break;
+            default          : Base=0;
+        }
+        if (Base==(int64u)-1 || (Position_ToMove<0 && (int64u)-Position_ToMove>Base))
+            return false;
+        Position=Base+Position_ToMove;
+        return true;
+    #endif //ZENLIB_FILE_POSIX
+
     Position=(int64u)-1; //Disabling memory
     #ifdef ZENLIB_USEWX
         return ((wxFile*)File_Handle)->Seek(Position, (wxSeekMode)MoveMethod)!=wxInvalidOffset; //move_t and wxSeekMode are same
@@ -696,8 +989,12 @@ int64u File::Position_Get ()
         return (int64u)-1;
     #else //ZENLIB_USEWX
         #ifdef ZENLIB_STANDARD
-            Position=((fstream*)File_Handle)->tellg();
-            return Position;
+            #ifdef ZENLIB_FILE_POSIX
+                return Position; //Always up to date
+            #else //ZENLIB_FILE_POSIX
+                Position=((fstream*)File_Handle)->tellg();
+                return Position;
+            #endif //ZENLIB_FILE_POSIX
         #elif defined WINDOWS
             LARGE_INTEGER GoTo; GoTo.QuadPart=0;
             GoTo.LowPart=SetFilePointer(File_Handle, GoTo.LowPart, &GoTo.HighPart, FILE_CURRENT);
@@ -739,6 +1036,13 @@ int64u File::Size_Get()
             File_Size=lseek(File_Handle, 0, SEEK_END);
             lseek(File_Handle, CurrentPos, SEEK_SET);
             */
+            #ifdef ZENLIB_FILE_POSIX
+            struct stat Stat;
+            if (!fstat(Fd_Get(File_Handle), &Stat))
+                Size=Stat.st_size;
+            else
+                Size=(int64u)-1;
+            #else //ZENLIB_FILE_POSIX
             fstream::pos_type CurrentPos=((fstream*)File_Handle)->tellg();
             if (CurrentPos!=(fstream::pos_type)-1)
             {
@@ -748,6 +1052,7 @@ int64u File::Size_Get()
             }
             else
                 Size=(int64u)-1;
+            #endif //ZENLIB_FILE_POSIX
         #elif defined WINDOWS
                 LARGE_INTEGER x = {0};
                 BOOL bRet = ::GetFileSizeEx(File_Handle, &x);
@@ -759,6 +1064,22 @@ int64u File::Size_Get()
     #endif //ZENLIB_USEWX
 }
 
+//---------------------------------------------------------------------------
+int64u File::Block_Size_Get()
+{
+    if (!Opened_Get())
+        return 0;
+
+    #if defined(ZENLIB_FILE_POSIX)
+        struct stat Stat;
+        if (fstat(Fd_Get(File_Handle), &Stat))
+            return 0;
+        return (int64u)Stat.st_blksize;
+    #else
+        return 0;
+    #endif
+}
+
 //---------------------------------------------------------------------------
 Ztring File::Created_Get()
 {
@@ -924,8 +1245,11 @@ bool File::Opened_Get()
         return File_Handle!=NULL;
     #else //ZENLIB_USEWX
         #ifdef ZENLIB_STANDARD
-            //return File_Handle!=-1;
-            return File_Handle!=NULL && ((fstream*)File_Handle)->is_open();
+            #ifdef ZENLIB_FILE_POSIX
+                return File_Handle!=NULL;
+            #else //ZENLIB_FILE_POSIX
+                return File_Handle!=NULL && ((fstream*)File_Handle)->is_open();
+            #endif //ZENLIB_FILE_POSIX
         #elif defined WINDOWS
             return File_Handle!=INVALID_HANDLE_VALUE;
         #endif
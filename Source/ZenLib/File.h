@@ -61,9 +61,14 @@ public :
 
     //Read/Write
     size_t Read  (int8u* Buffer, size_t Buffer_Size);
+    size_t Read_At (int8u* Buffer, size_t Buffer_Size, int64u Offset); //Does not use nor change the current position
     size_t Write (const int8u* Buffer, size_t Buffer_Size);
     size_t Write (const Ztring &ToWrite);
+    size_t Write_At (const int8u* const* Buffers, const size_t* Buffers_Size, size_t Buffers_Count, int64u Offset); //Gathered, does not use nor change the current position
+    int64u Copy_Range_From (File &Source, int64u Source_Offset, int64u Size_ToCopy, int64u Offset); //Copied by the system, 0 if not supported (the caller copies through a buffer)
+    int64u Clone_Range_From (File &Source, int64u Source_Offset, int64u Size_ToClone, int64u Offset); //Shared by the file system (offsets and size aligned on its blocks), 0 if not supported
     bool   Truncate (int64u Offset=(int64u)-1);
+    bool   Insert_Range (int64u Offset, int64u Size_ToInsert); //Content from Offset is moved by the file system (offset and size aligned on its blocks), false if not supported
 
     //Moving
     bool GoTo (int64s Position, move_t MoveMethod=FromBegin);
@@ -71,6 +76,7 @@ public :
 
     //Attributes
     int64u Size_Get();
+    int64u Block_Size_Get(); //Of the file system, 0 if unknown
     Ztring Created_Get();
     Ztring Created_Local_Get();
     Ztring Modified_Get();
@@ -102,7 +102,7 @@ bool Thread::IsRunning()
 
 void Thread::Sleep(size_t Millisecond)
 {
-    ((ThreadEntry*)ThreadPointer)->Sleep((unsigned long)Millisecond);
+    wxThread::Sleep((unsigned long)Millisecond);
 }
 
 void Thread::Yield()
@@ -558,8 +558,9 @@ bool Thread::IsExited()
 // Communicating
 //***************************************************************************
 
-void Thread::Sleep(size_t)
+void Thread::Sleep(size_t Millisecond)
 {
+    usleep((useconds_t)Millisecond*1000);
 }
 
 void Thread::Yield()
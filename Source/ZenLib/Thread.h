@@ -57,6 +57,9 @@ public :
     //Configuration
     void        Priority_Set(int8s Priority); //-100 to +100
 
+    //Communicating
+    static void Sleep(std::size_t Millisecond); //Also from a thread not created by this class
+
     //Main Entry
     virtual void Entry();
 
@@ -66,7 +69,6 @@ public :
 protected :
 
     //Communicating
-    void    Sleep(std::size_t Millisecond);
     void    Yield();
 
 private :